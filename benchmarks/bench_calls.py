@@ -0,0 +1,54 @@
+"""
+Per call overhead of constructing Zint and calling render methods with
+keyword arguments, on a small Code128 symbol whose encoding is cached.
+
+    python benchmarks/bench_calls.py [--number 200000]
+"""
+import argparse
+import timeit
+
+from pyzint.zint import BARCODE_CODE128, Zint
+
+
+DATA = "12345678"
+
+
+def cases():
+    symbol = Zint(DATA, BARCODE_CODE128, show_text=False)
+    symbol.render_bmp(direct=True)
+
+    return [
+        ("Zint(data, kind)", lambda: Zint(DATA, BARCODE_CODE128)),
+        ("Zint(..., 4 kwargs)", lambda: Zint(
+            DATA, BARCODE_CODE128,
+            scale=2.0, show_text=False, height=20, border_width=1,
+        )),
+        ("bmp_size(0, True)", lambda: symbol.bmp_size(0, True)),
+        ("bmp_size(2 kwargs)", lambda: symbol.bmp_size(
+            angle=0, direct=True,
+        )),
+        ("render_bmp(direct)", lambda: symbol.render_bmp(direct=True)),
+        ("render_bmp(4 kwargs)", lambda: symbol.render_bmp(
+            angle=0, fgcolor="#000000", bgcolor="#FFFFFF", direct=True,
+        )),
+        ("render_svg(3 kwargs)", lambda: symbol.render_svg(
+            angle=0, fgcolor="#000000", compact=True,
+        )),
+    ]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument("--number", type=int, default=200000)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    print("{:<24} {:>10}".format("call", "ns/call"))
+
+    for name, func in cases():
+        best = min(timeit.repeat(func, number=args.number, repeat=args.repeat))
+        print("{:<24} {:>10.0f}".format(name, best / args.number * 1e9))
+
+
+if __name__ == "__main__":
+    main()
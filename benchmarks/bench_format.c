@@ -0,0 +1,98 @@
+/* "%.2f" formatter micro benchmark, checks czint_buffer_fixed2 against
+ * snprintf and reports time per number for both.
+ *
+ *     make bench_format
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zint_buffer.h"
+
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int check(float value) {
+    czint_buffer buffer;
+    char expected[64];
+    int failed;
+
+    czint_buffer_init(&buffer);
+    czint_buffer_fixed2(&buffer, value);
+    snprintf(expected, sizeof(expected), "%.2f", value);
+
+    failed = buffer.failed || strcmp(buffer.data, expected) != 0;
+    if (failed) {
+        fprintf(stderr, "%a: expected %s got %s\n", value, expected, buffer.data);
+    }
+
+    czint_buffer_free(&buffer);
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    unsigned int count = argc > 1 ? (unsigned int) atoi(argv[1]) : 1000000;
+    unsigned int failures = 0;
+    czint_buffer buffer;
+    float *values;
+    double started, fast, slow;
+    char tmp[64];
+
+    /* Ties and near ties of typical coordinates, both signs */
+    for (int i = -200000; i <= 200000; i++) {
+        failures += check(i / 800.0f);
+        failures += check(i * 0.005f);
+        failures += check(i * 0.86f);
+    }
+
+    /* Random bit patterns over whole float range */
+    srand(1);
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned int bits = ((unsigned int) rand() << 16) ^ (unsigned int) rand();
+        float value;
+
+        memcpy(&value, &bits, sizeof(value));
+        failures += check(value);
+    }
+
+    failures += check(0.0f);
+    failures += check(-0.0f);
+    failures += check(-0.001f);
+    failures += check(1e20f);
+
+    printf("checked, %u mismatches\n", failures);
+
+    values = malloc(count * sizeof(float));
+    if (values == NULL) return 1;
+    for (unsigned int i = 0; i < count; i++) {
+        values[i] = (rand() % 100000) / 7.0f;
+    }
+
+    czint_buffer_init(&buffer);
+    started = now();
+    for (unsigned int i = 0; i < count; i++) {
+        czint_buffer_fixed2(&buffer, values[i]);
+    }
+    fast = now() - started;
+    czint_buffer_free(&buffer);
+
+    czint_buffer_init(&buffer);
+    started = now();
+    for (unsigned int i = 0; i < count; i++) {
+        snprintf(tmp, sizeof(tmp), "%.2f", values[i]);
+        czint_buffer_puts(&buffer, tmp);
+    }
+    slow = now() - started;
+    czint_buffer_free(&buffer);
+
+    printf("fixed2   %8.1f ns/number\n", fast / count * 1e9);
+    printf("snprintf %8.1f ns/number\n", slow / count * 1e9);
+
+    free(values);
+    return failures != 0;
+}
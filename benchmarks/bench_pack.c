@@ -0,0 +1,108 @@
+/* Row packer micro benchmark, checks every kernel against scalar one
+ * and reports throughput in megapixels per second.
+ *
+ *     make bench_pack
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zint_pack.h"
+
+
+typedef struct {
+    const char *name;
+    czint_pack_fn fn;
+} kernel;
+
+static const kernel kernels[] = {
+    {"scalar", czint_pack_row_scalar},
+#ifdef CZINT_PACK_X86
+    {"sse2", czint_pack_row_sse2},
+    {"avx2", czint_pack_row_avx2},
+#endif
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill(unsigned char *rgb, unsigned int pixels) {
+    for (unsigned int i = 0; i < pixels; i++) {
+        memset(&rgb[i * 3], (rand() & 1) ? 0xFF : 0x00, 3);
+    }
+}
+
+static int check(const kernel *k) {
+    unsigned char rgb[300 * 3], expected[40], actual[40];
+
+    for (unsigned int width = 0; width <= 300; width++) {
+        fill(rgb, width);
+        memset(expected, 0xAA, sizeof(expected));
+        memset(actual, 0xAA, sizeof(actual));
+
+        czint_pack_row_scalar(rgb, width, expected);
+        k->fn(rgb, width, actual);
+
+        if (memcmp(expected, actual, sizeof(expected)) != 0) {
+            fprintf(stderr, "%s: mismatch at width %u\n", k->name, width);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    unsigned int width = argc > 1 ? (unsigned int) atoi(argv[1]) : 1000;
+    unsigned int rows = argc > 2 ? (unsigned int) atoi(argv[2]) : 2000;
+    unsigned int rounds = 20;
+    czint_pack_fn best = czint_pack_select();
+    unsigned char *rgb, *out;
+    size_t stride = (width + 7) / 8;
+    double started, elapsed;
+    int failed = 0;
+
+    rgb = malloc((size_t) width * rows * 3);
+    out = malloc(stride * rows);
+    if (rgb == NULL || out == NULL) return 1;
+
+    fill(rgb, width * rows);
+
+    printf("%ux%u pixels, %u rounds\n", width, rows, rounds);
+
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        const kernel *k = &kernels[i];
+
+#ifdef CZINT_PACK_X86
+        if (k->fn == czint_pack_row_avx2 && !__builtin_cpu_supports("avx2")) {
+            printf("%-8s unsupported\n", k->name);
+            continue;
+        }
+#endif
+        if (check(k) != 0) {
+            failed = 1;
+            continue;
+        }
+
+        started = now();
+        for (unsigned int r = 0; r < rounds; r++) {
+            for (unsigned int y = 0; y < rows; y++) {
+                k->fn(&rgb[(size_t) y * width * 3], width, &out[y * stride]);
+            }
+        }
+        elapsed = now() - started;
+
+        printf(
+            "%-8s %10.1f Mpx/s%s\n", k->name,
+            (double) width * rows * rounds / elapsed / 1e6,
+            k->fn == best ? "  (selected)" : ""
+        );
+    }
+
+    free(rgb);
+    free(out);
+    return failed;
+}
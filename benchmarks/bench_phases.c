@@ -0,0 +1,120 @@
+/* Native counterpart of bench_phases.py, times render phases without
+ * the interpreter. Reads cases printed by `bench_phases.py --cases`
+ * (symbology, scale, size, hex payload, hex primary) from stdin and
+ * writes JSON with microseconds per render to stdout.
+ *
+ *     make bench_phases
+ *     python3 benchmarks/bench_phases.py --cases | ./build/bench_phases [number]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zint_phases.h"
+
+
+#define LINE_MAX_SIZE 65536
+
+static int unhex(const char *hex, unsigned char *out, size_t capacity) {
+    size_t i, length = strlen(hex);
+    unsigned int byte;
+
+    if (length % 2 || length / 2 >= capacity) return -1;
+
+    for (i = 0; i < length / 2; i++) {
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) return -1;
+        out[i] = (unsigned char) byte;
+    }
+    out[i] = '\0';
+    return (int) i;
+}
+
+static char *field(char **line) {
+    char *start = *line, *end;
+
+    if (start == NULL) return "";
+
+    end = strpbrk(start, "\t\n");
+    if (end == NULL) {
+        *line = NULL;
+    } else {
+        *line = *end == '\t' ? end + 1 : NULL;
+        *end = '\0';
+    }
+    return start;
+}
+
+static void print_string(const char *value) {
+    putchar('"');
+    for (; *value; value++) {
+        if (*value == '"' || *value == '\\') putchar('\\');
+        if ((unsigned char) *value >= ' ') putchar(*value);
+    }
+    putchar('"');
+}
+
+int main(int argc, char **argv) {
+    static char line[LINE_MAX_SIZE];
+    static unsigned char payload[LINE_MAX_SIZE / 2];
+    static unsigned char primary[LINE_MAX_SIZE / 2];
+    unsigned int number = argc > 1 ? (unsigned int) atoi(argv[1]) : 200;
+    czint_render_options options;
+    czint_phases phases;
+    struct zint_symbol *template;
+    const char *first = "";
+    int symbology, size, length, res;
+    float scale;
+
+    if (number < 1) number = 1;
+
+    czint_render_init();
+    czint_render_options_init(&options);
+
+    printf("{\"number\": %u, \"unit\": \"us/render\", \"results\": [", number);
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        char *rest = line;
+
+        symbology = atoi(field(&rest));
+        scale = (float) atof(field(&rest));
+        size = atoi(field(&rest));
+        length = unhex(field(&rest), payload, sizeof(payload));
+        if (length < 0 || unhex(field(&rest), primary, sizeof(template->primary)) < 0) {
+            fprintf(stderr, "malformed case: %d\n", symbology);
+            continue;
+        }
+
+        template = ZBarcode_Create();
+        if (template == NULL) return 1;
+
+        template->symbology = symbology;
+        template->scale = scale;
+        strcpy(template->primary, (char *) primary);
+
+        res = czint_phases_run(template, payload, length, &options, number, &phases);
+
+        printf("%s\n  {\"symbology\": %d, \"scale\": %g, \"size\": %d, ", first, symbology, scale, size);
+        if (res) {
+            printf("\"code\": %d, \"error\": ", res);
+            print_string(phases.bmp_out.errtxt);
+            putchar('}');
+        } else {
+            printf(
+                "\"encode\": %.3f, \"buffer\": %.3f, \"pack\": %.3f, "
+                "\"vector\": %.3f, \"svg\": %.3f, "
+                "\"bmp_size\": %zu, \"svg_size\": %zu}",
+                phases.encode / number * 1e6, phases.buffer / number * 1e6,
+                phases.pack / number * 1e6, phases.vector / number * 1e6,
+                phases.svg / number * 1e6,
+                phases.bmp_out.size, phases.svg_out.size
+            );
+        }
+        first = ",";
+
+        czint_phases_free(&phases);
+        ZBarcode_Delete(template);
+    }
+
+    printf("\n]}\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+"""
+Per phase render time for every symbology in examples/make_examples.py:
+argument parsing, encoding, raster buffering, bmp packing, vector
+buffering, svg serialization and the final copy into bytes, at several
+scales and payload sizes. Payloads are the examples repeated --sizes
+times, cases the symbology rejects are reported and skipped.
+
+    python benchmarks/bench_phases.py [--number 200] [--scales 1,2,4]
+        [--sizes 1,4] [--direct] [--json results.json]
+
+--cases prints the same cases as tab separated lines for the native
+harness, which times the phases without the interpreter:
+
+    make bench_phases
+"""
+import argparse
+import json
+import os
+import sys
+import timeit
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "examples"))
+
+from make_examples import EXAMPLES  # noqa: E402
+
+from pyzint.zint import _phases  # noqa: E402
+
+
+PHASES = ("parse", "encode", "buffer", "pack", "vector", "svg", "copy")
+
+
+def numbers(value):
+    return [float(x) for x in value.split(",") if x]
+
+
+def cases(scales, sizes):
+    for kind, payload in EXAMPLES.items():
+        primary = None
+        if isinstance(payload, tuple):
+            payload, primary = payload
+
+        for size in sizes:
+            for scale in scales:
+                yield kind, scale, int(size), payload * int(size), primary
+
+
+def measure(kind, scale, payload, primary, args):
+    def make():
+        return kind(payload, scale=scale, primary=primary)
+
+    parse = timeit.timeit(make, number=args.number)
+    result = _phases(make(), args.number, direct=args.direct)
+    result["parse"] = parse
+    return result
+
+
+def print_cases(args):
+    for kind, scale, size, payload, primary in cases(args.scales, args.sizes):
+        print("\t".join((
+            str(int(kind)), repr(scale), str(size),
+            payload.encode().hex(), (primary or "").encode().hex(),
+        )))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.strip(),
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+    )
+    parser.add_argument("--number", type=int, default=200)
+    parser.add_argument("--scales", type=numbers, default="1,2,4")
+    parser.add_argument("--sizes", type=numbers, default="1,4")
+    parser.add_argument("--direct", action="store_true")
+    parser.add_argument("--json", metavar="FILE")
+    parser.add_argument("--cases", action="store_true")
+    args = parser.parse_args()
+
+    if args.cases:
+        print_cases(args)
+        return
+
+    results = []
+    totals = dict.fromkeys(PHASES, 0.0)
+
+    print("{:<20} {:>5} {:>4} {}".format(
+        "symbology", "scale", "size",
+        " ".join("{:>8}".format(x) for x in PHASES),
+    ))
+
+    for kind, scale, size, payload, primary in cases(args.scales, args.sizes):
+        try:
+            result = measure(kind, scale, payload, primary, args)
+        except (RuntimeError, ValueError) as e:
+            results.append({
+                "symbology": kind.name, "scale": scale, "size": size,
+                "error": str(e),
+            })
+            print("{:<20} {:>5} {:>4} {}".format(kind.name, scale, size, e))
+            continue
+
+        row = {
+            "symbology": kind.name, "scale": scale, "size": size,
+            "bmp_size": result["bmp_size"], "svg_size": result["svg_size"],
+        }
+
+        for phase in PHASES:
+            row[phase] = result[phase] / args.number * 1e6
+            totals[phase] += result[phase]
+
+        results.append(row)
+
+        print("{:<20} {:>5} {:>4} {}".format(
+            kind.name, scale, size,
+            " ".join("{:>8.1f}".format(row[x]) for x in PHASES),
+        ))
+
+    print("{:<20} {:>5} {:>4} {}".format(
+        "total", "", "",
+        " ".join("{:>8.1f}".format(totals[x] / args.number * 1e6) for x in PHASES),
+    ))
+
+    if args.json:
+        with open(args.json, "w") as fp:
+            json.dump({
+                "number": args.number,
+                "direct": args.direct,
+                "unit": "us/render",
+                "results": results,
+            }, fp, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,48 @@
+"""
+SVG render time for every symbology in examples/make_examples.py.
+
+    python benchmarks/bench_svg.py [--number 200] [--scale 2]
+"""
+import argparse
+import os
+import sys
+import timeit
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "examples"))
+
+from make_examples import EXAMPLES  # noqa: E402
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument("--number", type=int, default=200)
+    parser.add_argument("--scale", type=float, default=2)
+    args = parser.parse_args()
+
+    total = 0.0
+
+    print("{:<20} {:>10} {:>12}".format("symbology", "bytes", "us/render"))
+
+    for kind, payload in EXAMPLES.items():
+        primary = None
+        if isinstance(payload, tuple):
+            payload, primary = payload
+
+        symbol = kind(payload, scale=args.scale, primary=primary)
+        size = len(symbol.render_svg())
+
+        elapsed = timeit.timeit(symbol.render_svg, number=args.number)
+        total += elapsed
+
+        print("{:<20} {:>10} {:>12.1f}".format(
+            kind.name, size, elapsed / args.number * 1e6
+        ))
+
+    print("{:<20} {:>10} {:>12.1f}".format(
+        "total", "", total / args.number * 1e6
+    ))
+
+
+if __name__ == "__main__":
+    main()
@@ -110,46 +110,51 @@ EXAMPLES = {
 }
 
 
-with open("README.md", "w+") as fp:
-    fp.write("Barcode Examples\n")
-    fp.write("================\n")
-    fp.write("Auto generated examples. "
-             "See `make_examples.py` for details.\n\n")
-
-    for kind, payload in EXAMPLES.items():
-        print("Creating example for", kind.name, "with payload", payload)
-
-        primary = None
-        if isinstance(payload, tuple):
-            payload, primary = payload
-
-        symbol = kind(payload, scale=2, primary=primary)
-
-        with BytesIO(symbol.render_bmp()) as bmp:
-            img = Image.open(bmp)
-            fname = "images/{}.png".format(kind.name.lower())
-            img.save(fname)
-
-        fp.write("## {}\n\n".format(kind.name))
-
-        fp.write("Example `{}` barcode with content `{}`".format(
-            kind.name,
-            payload
-        ))
-
-        if primary:
-            fp.write(" and primary `{}`".format(primary))
-
-        fp.write("\n\n")
-
-        fp.write("![{} barcode example]({})\n\n".format(kind.name, fname))
-        fp.write("Code example:\n")
-        fp.write("```python\n")
-        fp.write("import pyzint\n\n")
-        fp.write("symbol = pyzint.Barcode.{}({!r}".format(kind.name, payload))
-        if primary:
-            fp.write(", primary={!r}".format(primary))
-        fp.write(")\n\n")
-        fp.write("with open('{!s}.bmp', \"wb\") as bmp:\n".format(kind.name))
-        fp.write("    bmp.write(symbol.render_bmp())\n".format(kind.name))
-        fp.write("```\n")
+def main():
+    with open("README.md", "w+") as fp:
+        fp.write("Barcode Examples\n")
+        fp.write("================\n")
+        fp.write("Auto generated examples. "
+                 "See `make_examples.py` for details.\n\n")
+
+        for kind, payload in EXAMPLES.items():
+            print("Creating example for", kind.name, "with payload", payload)
+
+            primary = None
+            if isinstance(payload, tuple):
+                payload, primary = payload
+
+            symbol = kind(payload, scale=2, primary=primary)
+
+            with BytesIO(symbol.render_bmp()) as bmp:
+                img = Image.open(bmp)
+                fname = "images/{}.png".format(kind.name.lower())
+                img.save(fname)
+
+            fp.write("## {}\n\n".format(kind.name))
+
+            fp.write("Example `{}` barcode with content `{}`".format(
+                kind.name,
+                payload
+            ))
+
+            if primary:
+                fp.write(" and primary `{}`".format(primary))
+
+            fp.write("\n\n")
+
+            fp.write("![{} barcode example]({})\n\n".format(kind.name, fname))
+            fp.write("Code example:\n")
+            fp.write("```python\n")
+            fp.write("import pyzint\n\n")
+            fp.write("symbol = pyzint.Barcode.{}({!r}".format(kind.name, payload))
+            if primary:
+                fp.write(", primary={!r}".format(primary))
+            fp.write(")\n\n")
+            fp.write("with open('{!s}.bmp', \"wb\") as bmp:\n".format(kind.name))
+            fp.write("    bmp.write(symbol.render_bmp())\n".format(kind.name))
+            fp.write("```\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,18 +1,30 @@
-#include "endianness.h"
 #include "src/zint/backend/zint.h"
-#include "src/zint/backend/common.h"
-#include "src/zint/backend/gb18030.h"
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #include <structmember.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-extern void make_html_friendly(const unsigned char * string, char * html_version);
+#include "zint_args.h"
+#include "zint_buffer.h"
+#include "zint_cache.h"
+#include "zint_pack.h"
+#include "zint_phases.h"
+#include "zint_png.h"
+#include "zint_pool.h"
+#include "zint_registry.h"
+#include "zint_render.h"
+#include "zint_sheet.h"
+#include "zint_shm.h"
+#include "zint_stats.h"
+#include "zint_symbols.h"
 
 typedef struct {
     PyObject_HEAD
     PyObject *data;
-    char *human_symbology;
+    const char *human_symbology;
     float dot_size;
     float scale;
     int border_width;
@@ -30,8 +42,60 @@ typedef struct {
     Py_buffer primary;
     Py_buffer text;
     Py_ssize_t length;
+    struct zint_symbol *symbol;
+    int symbol_result;
+    PyThread_type_lock lock;
 } CZINT;
 
+/* Signatures of vectorcall entry points, see czint_args_specs */
+enum {
+    CZINT_ARGS_INIT,
+    CZINT_ARGS_RENDER_BMP,
+    CZINT_ARGS_RENDER_BMP_BUFFER,
+    CZINT_ARGS_RENDER_BMP_ASYNC,
+    CZINT_ARGS_RENDER_SVG,
+    CZINT_ARGS_RENDER_SVG_ASYNC,
+    CZINT_ARGS_RENDER_INTO,
+    CZINT_ARGS_BMP_SIZE,
+    CZINT_ARGS_MEASURE,
+    CZINT_ARGS_RENDER_PNG,
+    CZINT_ARGS_RENDER_FORMATS,
+    CZINT_ARGS_RENDER_ZPL,
+    CZINT_ARGS_RENDER_ESCPOS,
+    CZINT_ARGS_RENDER_BMP_TO,
+    CZINT_ARGS_RENDER_SVG_TO,
+    CZINT_ARGS_COUNT
+};
+
+/* Per module state, every interpreter importing pyzint.zint gets its
+ * own types and asyncio helpers. */
+typedef struct {
+    PyTypeObject *ZintType;
+    PyTypeObject *RasterType;
+    PyTypeObject *MatrixType;
+    PyTypeObject *CompletionsType;
+    PyTypeObject *SharedCacheType;
+    PyTypeObject *RangeRendersType;
+    /* Interned keyword names for every czint_args_specs entry */
+    PyObject *kwnames[CZINT_ARGS_COUNT];
+    /* asyncio.get_running_loop and weak loop -> completion queue mapping,
+     * set up on first async render */
+    PyObject *get_running_loop;
+    PyObject *async_queues;
+    /* Rendered bytes objects, off until a limit is set */
+    czint_cache cache;
+    /* SharedCache consulted after cache misses or NULL, swapped under
+     * shared_lock */
+    PyThread_type_lock shared_lock;
+    PyObject *shared_cache;
+} czint_state;
+
+/* State of module defining type of obj. Types are not subclassable so
+ * the defining module is always found. */
+static czint_state *czint_get_state(PyObject *obj) {
+    return (czint_state *) PyType_GetModuleState(Py_TYPE(obj));
+}
+
 static void PyErr_CodeFormat(PyObject * err, int code, char const * format, ...) {
     va_list vargs;
     PyObject *s;
@@ -49,322 +113,59 @@ static void PyErr_CodeFormat(PyObject * err, int code, char const * format, ...)
     Py_XDECREF(s);
 }
 
+static PyObject* PyErr_CodeObject(PyObject * err, int code, char const * errtxt) {
+    PyObject *result;
+    PyObject *s;
+
+    s = PyUnicode_FromFormat("Error while rendering: %s", errtxt);
+    if (s == NULL) return NULL;
+
+    result = PyObject_CallFunction(err, "iO", code, s);
+    Py_DECREF(s);
+    return result;
+}
+
 static PyObject *
 CZINT_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
     CZINT *self;
 
     self = (CZINT *) type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+
+    self->lock = PyThread_allocate_lock();
+    if (self->lock == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+
     return (PyObject *) self;
 }
 
-static void
-CZINT_dealloc(CZINT *self) {
+/* Release payload, buffers and encoded symbol */
+static void czint_clear(CZINT *self) {
     Py_CLEAR(self->data);
     self->buffer = NULL;
-    Py_TYPE(self)->tp_free((PyObject *) self);
-}
-
-static inline uint8_t octet2char(const unsigned char* src, int shift) {
-    unsigned char result = 0;
-    for (int i = 0; i < 8; i++) {
-        result |= (src[i * shift]?1:0) << (7 - i);
+    if (self->symbol != NULL) {
+        ZBarcode_Delete(self->symbol);
+        self->symbol = NULL;
     }
-    return result;
+    PyBuffer_Release(&self->primary);
+    PyBuffer_Release(&self->text);
 }
 
-static int set_human_symbology(CZINT* self) {
-    switch (self->symbology) {
-        case (BARCODE_CODE11):
-            self->human_symbology = "code11";
-            return 0;
-        case (BARCODE_C25MATRIX):
-            self->human_symbology = "c25matrix";
-            return 0;
-        case (BARCODE_C25INTER):
-            self->human_symbology = "c25inter";
-            return 0;
-        case (BARCODE_C25IATA):
-            self->human_symbology = "c25iata";
-            return 0;
-        case (BARCODE_C25LOGIC):
-            self->human_symbology = "c25logic";
-            return 0;
-        case (BARCODE_C25IND):
-            self->human_symbology = "c25ind";
-            return 0;
-        case (BARCODE_CODE39):
-            self->human_symbology = "code39";
-            return 0;
-        case (BARCODE_EXCODE39):
-            self->human_symbology = "excode39";
-            return 0;
-        case (BARCODE_EANX):
-            self->human_symbology = "eanx";
-            return 0;
-        case (BARCODE_EANX_CHK):
-            self->human_symbology = "eanx_chk";
-            return 0;
-        case (BARCODE_EAN128):
-            self->human_symbology = "ean128";
-            return 0;
-        case (BARCODE_CODABAR):
-            self->human_symbology = "codabar";
-            return 0;
-        case (BARCODE_CODE128):
-            self->human_symbology = "code128";
-            return 0;
-        case (BARCODE_DPLEIT):
-            self->human_symbology = "dpleit";
-            return 0;
-        case (BARCODE_DPIDENT):
-            self->human_symbology = "dpident";
-            return 0;
-        case (BARCODE_CODE16K):
-            self->human_symbology = "code16k";
-            return 0;
-        case (BARCODE_CODE49):
-            self->human_symbology = "code49";
-            return 0;
-        case (BARCODE_CODE93):
-            self->human_symbology = "code93";
-            return 0;
-        case (BARCODE_FLAT):
-            self->human_symbology = "flat";
-            return 0;
-        case (BARCODE_RSS14):
-            self->human_symbology = "rss14";
-            return 0;
-        case (BARCODE_RSS_LTD):
-            self->human_symbology = "rss_ltd";
-            return 0;
-        case (BARCODE_RSS_EXP):
-            self->human_symbology = "rss_exp";
-            return 0;
-        case (BARCODE_TELEPEN):
-            self->human_symbology = "telepen";
-            return 0;
-        case (BARCODE_UPCA):
-            self->human_symbology = "upca";
-            return 0;
-        case (BARCODE_UPCA_CHK):
-            self->human_symbology = "upca_chk";
-            return 0;
-        case (BARCODE_UPCE):
-            self->human_symbology = "upce";
-            return 0;
-        case (BARCODE_UPCE_CHK):
-            self->human_symbology = "upce_chk";
-            return 0;
-        case (BARCODE_POSTNET):
-            self->human_symbology = "postnet";
-            return 0;
-        case (BARCODE_MSI_PLESSEY):
-            self->human_symbology = "msi_plessey";
-            return 0;
-        case (BARCODE_FIM):
-            self->human_symbology = "fim";
-            return 0;
-        case (BARCODE_LOGMARS):
-            self->human_symbology = "logmars";
-            return 0;
-        case (BARCODE_PHARMA):
-            self->human_symbology = "pharma";
-            return 0;
-        case (BARCODE_PZN):
-            self->human_symbology = "pzn";
-            return 0;
-        case (BARCODE_PHARMA_TWO):
-            self->human_symbology = "pharma_two";
-            return 0;
-        case (BARCODE_PDF417):
-            self->human_symbology = "pdf417";
-            return 0;
-        case (BARCODE_PDF417TRUNC):
-            self->human_symbology = "pdf417trunc";
-            return 0;
-        case (BARCODE_MAXICODE):
-            self->human_symbology = "maxicode";
-            return 0;
-        case (BARCODE_QRCODE):
-            self->human_symbology = "qrcode";
-            return 0;
-        case (BARCODE_CODE128B):
-            self->human_symbology = "code128b";
-            return 0;
-        case (BARCODE_AUSPOST):
-            self->human_symbology = "auspost";
-            return 0;
-        case (BARCODE_AUSREPLY):
-            self->human_symbology = "ausreply";
-            return 0;
-        case (BARCODE_AUSROUTE):
-            self->human_symbology = "ausroute";
-            return 0;
-        case (BARCODE_AUSREDIRECT):
-            self->human_symbology = "ausredirect";
-            return 0;
-        case (BARCODE_ISBNX):
-            self->human_symbology = "isbnx";
-            return 0;
-        case (BARCODE_RM4SCC):
-            self->human_symbology = "rm4scc";
-            return 0;
-        case (BARCODE_DATAMATRIX):
-            self->human_symbology = "datamatrix";
-            return 0;
-        case (BARCODE_EAN14):
-            self->human_symbology = "ean14";
-            return 0;
-        case (BARCODE_VIN):
-            self->human_symbology = "vin";
-            return 0;
-        case (BARCODE_CODABLOCKF):
-            self->human_symbology = "codablockf";
-            return 0;
-        case (BARCODE_NVE18):
-            self->human_symbology = "nve18";
-            return 0;
-        case (BARCODE_JAPANPOST):
-            self->human_symbology = "japanpost";
-            return 0;
-        case (BARCODE_KOREAPOST):
-            self->human_symbology = "koreapost";
-            return 0;
-        case (BARCODE_RSS14STACK):
-            self->human_symbology = "rss14stack";
-            return 0;
-        case (BARCODE_RSS14STACK_OMNI):
-            self->human_symbology = "rss14stack_omni";
-            return 0;
-        case (BARCODE_RSS_EXPSTACK):
-            self->human_symbology = "rss_expstack";
-            return 0;
-        case (BARCODE_PLANET):
-            self->human_symbology = "planet";
-            return 0;
-        case (BARCODE_MICROPDF417):
-            self->human_symbology = "micropdf417";
-            return 0;
-        case (BARCODE_ONECODE):
-            self->human_symbology = "onecode";
-            return 0;
-        case (BARCODE_PLESSEY):
-            self->human_symbology = "plessey";
-            return 0;
-        case (BARCODE_TELEPEN_NUM):
-            self->human_symbology = "telepen_num";
-            return 0;
-        case (BARCODE_ITF14):
-            self->human_symbology = "itf14";
-            return 0;
-        case (BARCODE_KIX):
-            self->human_symbology = "kix";
-            return 0;
-        case (BARCODE_AZTEC):
-            self->human_symbology = "aztec";
-            return 0;
-        case (BARCODE_DAFT):
-            self->human_symbology = "daft";
-            return 0;
-        case (BARCODE_MICROQR):
-            self->human_symbology = "microqr";
-            return 0;
-        case (BARCODE_HIBC_128):
-            self->human_symbology = "hibc_128";
-            return 0;
-        case (BARCODE_HIBC_39):
-            self->human_symbology = "hibc_39";
-            return 0;
-        case (BARCODE_HIBC_DM):
-            self->human_symbology = "hibc_dm";
-            return 0;
-        case (BARCODE_HIBC_QR):
-            self->human_symbology = "hibc_qr";
-            return 0;
-        case (BARCODE_HIBC_PDF):
-            self->human_symbology = "hibc_pdf";
-            return 0;
-        case (BARCODE_HIBC_MICPDF):
-            self->human_symbology = "hibc_micpdf";
-            return 0;
-        case (BARCODE_HIBC_BLOCKF):
-            self->human_symbology = "hibc_blockf";
-            return 0;
-        case (BARCODE_HIBC_AZTEC):
-            self->human_symbology = "hibc_aztec";
-            return 0;
-        case (BARCODE_DOTCODE):
-            self->human_symbology = "dotcode";
-            return 0;
-        case (BARCODE_HANXIN):
-            self->human_symbology = "hanxin";
-            return 0;
-        case (BARCODE_MAILMARK):
-            self->human_symbology = "mailmark";
-            return 0;
-        case (BARCODE_AZRUNE):
-            self->human_symbology = "azrune";
-            return 0;
-        case (BARCODE_CODE32):
-            self->human_symbology = "code32";
-            return 0;
-        case (BARCODE_EANX_CC):
-            self->human_symbology = "eanx_cc";
-            return 0;
-        case (BARCODE_EAN128_CC):
-            self->human_symbology = "ean128_cc";
-            return 0;
-        case (BARCODE_RSS14_CC):
-            self->human_symbology = "rss14_cc";
-            return 0;
-        case (BARCODE_RSS_LTD_CC):
-            self->human_symbology = "rss_ltd_cc";
-            return 0;
-        case (BARCODE_RSS_EXP_CC):
-            self->human_symbology = "rss_exp_cc";
-            return 0;
-        case (BARCODE_UPCA_CC):
-            self->human_symbology = "upca_cc";
-            return 0;
-        case (BARCODE_UPCE_CC):
-            self->human_symbology = "upce_cc";
-            return 0;
-        case (BARCODE_RSS14STACK_CC):
-            self->human_symbology = "rss14stack_cc";
-            return 0;
-        case (BARCODE_RSS14_OMNI_CC):
-            self->human_symbology = "rss14_omni_cc";
-            return 0;
-        case (BARCODE_RSS_EXPSTACK_CC):
-            self->human_symbology = "rss_expstack_cc";
-            return 0;
-        case (BARCODE_CHANNEL):
-            self->human_symbology = "channel";
-            return 0;
-        case (BARCODE_CODEONE):
-            self->human_symbology = "codeone";
-            return 0;
-        case (BARCODE_GRIDMATRIX):
-            self->human_symbology = "gridmatrix";
-            return 0;
-        case (BARCODE_UPNQR):
-            self->human_symbology = "upnqr";
-            return 0;
-        case (BARCODE_RMQR):
-            self->human_symbology = "rmqr";
-            return 0;
-        default:
-            PyErr_Format(
-                PyExc_ValueError,
-                "Unknown barcode type %d",
-                self->symbology
-            );
-            return -1;
+static void
+CZINT_dealloc(CZINT *self) {
+    czint_clear(self);
+    if (self->lock != NULL) {
+        PyThread_free_lock(self->lock);
+        self->lock = NULL;
     }
-}
 
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
 
-#define CZINT_SCALE_MAX 10
 #define CZINT_SCALE_MIN 0
 #define CZINT_SCALE_DEFAULT 1.0
 #define CZINT_DEFAULT_HEIGHT 50
@@ -373,16 +174,99 @@ static int set_human_symbology(CZINT* self) {
 
 static const float CZINT_DEFAULT_DOT_SIZE = 4.0 / 5.0;
 
-static int
-CZINT_init(CZINT *self, PyObject *args, PyObject *kwds)
-{
-    static char *kwlist[] = {
-      "data", "kind", "option_1", "option_2", "option_3",
-      "scale", "show_text", "fontsize", "height", "whitespace_width",
-      "border_width", "eci", "primary", "text", "dot_size",
-       NULL
-    };
+static const char *const czint_init_kwlist[] = {
+    "data", "kind", "option_1", "option_2", "option_3",
+    "scale", "show_text", "fontsize", "height", "whitespace_width",
+    "border_width", "eci", "primary", "text", "dot_size",
+    NULL
+};
+
+static const char *const czint_render_kwlist[] = {
+    "angle", "fgcolor", "bgcolor", "direct", "compact", NULL
+};
+
+static const char *const czint_render_into_kwlist[] = {
+    "buffer", "offset", "angle", "fgcolor", "bgcolor", "direct", NULL
+};
+
+static const char *const czint_bmp_size_kwlist[] = {
+    "angle", "direct", NULL
+};
+
+static const char *const czint_measure_kwlist[] = {
+    "angle", NULL
+};
+
+static const char *const czint_render_png_kwlist[] = {
+    "angle", "fgcolor", "bgcolor", "direct",
+    "level", "strategy", "filter", NULL
+};
+
+static const char *const czint_render_formats_kwlist[] = {
+    "formats", "angle", "fgcolor", "bgcolor", "direct", "compact",
+    "level", "strategy", "filter", NULL
+};
+
+static const char *const czint_render_zpl_kwlist[] = {
+    "angle", "direct", "compression", "label", NULL
+};
+
+static const char *const czint_render_to_kwlist[] = {
+    "file", "angle", "fgcolor", "bgcolor", "direct", "compact", NULL
+};
+
+static const czint_args_spec czint_args_specs[CZINT_ARGS_COUNT] = {
+    [CZINT_ARGS_INIT] = {
+        "Zint", "Ob|iii$fbiBBBBz*s*f", czint_init_kwlist
+    },
+    [CZINT_ARGS_RENDER_BMP] = {
+        "render_bmp", "|isspp", czint_render_kwlist
+    },
+    [CZINT_ARGS_RENDER_BMP_BUFFER] = {
+        "render_bmp_buffer", "|isspp", czint_render_kwlist
+    },
+    [CZINT_ARGS_RENDER_BMP_ASYNC] = {
+        "render_bmp_async", "|isspp", czint_render_kwlist
+    },
+    [CZINT_ARGS_RENDER_SVG] = {
+        "render_svg", "|isspp", czint_render_kwlist
+    },
+    [CZINT_ARGS_RENDER_SVG_ASYNC] = {
+        "render_svg_async", "|isspp", czint_render_kwlist
+    },
+    [CZINT_ARGS_RENDER_INTO] = {
+        "render_bmp_into", "w*|nissp", czint_render_into_kwlist
+    },
+    [CZINT_ARGS_BMP_SIZE] = {
+        "bmp_size", "|ip", czint_bmp_size_kwlist
+    },
+    [CZINT_ARGS_MEASURE] = {
+        "measure", "|i", czint_measure_kwlist
+    },
+    [CZINT_ARGS_RENDER_PNG] = {
+        "render_png", "|isspiss", czint_render_png_kwlist
+    },
+    [CZINT_ARGS_RENDER_FORMATS] = {
+        "render", "|Oissppiss", czint_render_formats_kwlist
+    },
+    [CZINT_ARGS_RENDER_ZPL] = {
+        "render_zpl", "|ipsp", czint_render_zpl_kwlist
+    },
+    [CZINT_ARGS_RENDER_ESCPOS] = {
+        "render_escpos", "|ip", czint_bmp_size_kwlist
+    },
+    [CZINT_ARGS_RENDER_BMP_TO] = {
+        "render_bmp_to", "O|isspp", czint_render_to_kwlist
+    },
+    [CZINT_ARGS_RENDER_SVG_TO] = {
+        "render_svg_to", "O|isspp", czint_render_to_kwlist
+    },
+};
 
+#define CZINT_ARGS(state, id) &czint_args_specs[id], (state)->kwnames[id]
+
+/* Set defaults of constructor arguments */
+static void czint_reset(CZINT *self) {
     self->show_hrt = 1;
 
     self->option_1 = -1;
@@ -395,33 +279,38 @@ CZINT_init(CZINT *self, PyObject *args, PyObject *kwds)
     self->height = CZINT_DEFAULT_HEIGHT;
     self->eci = CZINT_DEFAULT_ECI;
     self->dot_size = CZINT_DEFAULT_DOT_SIZE;
+}
 
-    if (!PyArg_ParseTupleAndKeywords(
-            args, kwds, "Ob|iii$fbiBBBBz*s*f", kwlist,
-            &self->data,
-            &self->symbology,
-
-            &self->option_1,
-            &self->option_2,
-            &self->option_3,
-
-            &self->scale,
-            &self->show_hrt,
-            &self->fontsize,
-
-            &self->height,
-            &self->whitespace_width,
-            &self->border_width,
+/* Swap settings, payload and encoded symbol of self with staged ones
+ * under self->lock. Renders running without GIL only read them under
+ * that lock, so they see either old or new object, never a mix. Every
+ * field from data up to lock belongs to the swapped part. */
+static void czint_swap(CZINT *self, CZINT *staged) {
+    const size_t start = offsetof(CZINT, data);
+    const size_t size = offsetof(CZINT, lock) - start;
+    char old[sizeof(CZINT)];
 
-            &self->eci,
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    memcpy(old, (char *) self + start, size);
+    memcpy((char *) self + start, (char *) staged + start, size);
+    memcpy((char *) staged + start, old, size);
+    PyThread_release_lock(self->lock);
+}
 
-            &self->primary,
-            &self->text,
+/* Targets of CZINT_ARGS_INIT, shared by tp_init and vectorcall */
+#define CZINT_INIT_TARGETS(self, data) \
+    &data, &self->symbology, \
+    &self->option_1, &self->option_2, &self->option_3, \
+    &self->scale, &self->show_hrt, &self->fontsize, \
+    &self->height, &self->whitespace_width, &self->border_width, \
+    &self->eci, &self->primary, &self->text, &self->dot_size
 
-            &self->dot_size
-    )) return -1;
+/* Validate parsed constructor arguments */
+static int czint_setup(CZINT *self, PyObject *data) {
+    const czint_symbology *symbology;
 
-    Py_INCREF(self->data);
+    Py_INCREF(data);
+    Py_XSETREF(self->data, data);
 
     if (self->scale <= CZINT_SCALE_MIN) {
         PyErr_Format(
@@ -442,7 +331,16 @@ CZINT_init(CZINT *self, PyObject *args, PyObject *kwds)
         return -1;
     }
 
-    if (set_human_symbology(self) == -1) return -1;
+    symbology = czint_symbology_get(self->symbology);
+    if (symbology == NULL) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "Unknown barcode type %d",
+            self->symbology
+        );
+        return -1;
+    }
+    self->human_symbology = symbology->name;
 
     if (self->primary.len >= 128) {
         PyErr_Format(
@@ -472,6 +370,55 @@ CZINT_init(CZINT *self, PyObject *args, PyObject *kwds)
     return 0;
 }
 
+static int
+CZINT_init(CZINT *self, PyObject *args, PyObject *kwds)
+{
+    czint_state *state = czint_get_state((PyObject *) self);
+    PyObject *data = NULL;
+    CZINT staged;
+    int res;
+
+    /* Object may already be rendered by other threads, arguments are
+     * parsed into a scratch copy and swapped in only when valid */
+    memset(&staged, 0, sizeof(staged));
+    czint_reset(&staged);
+
+    res = czint_args_parse_dict(
+        CZINT_ARGS(state, CZINT_ARGS_INIT), args, kwds,
+        CZINT_INIT_TARGETS((&staged), data)
+    ) || czint_setup(&staged, data);
+
+    if (res == 0) czint_swap(self, &staged);
+    czint_clear(&staged);
+    return res ? -1 : 0;
+}
+
+/* Zint(...) without building args tuple and kwargs dict */
+static PyObject *
+CZINT_vectorcall(
+    PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames
+) {
+    czint_state *state = PyType_GetModuleState((PyTypeObject *) type);
+    PyObject *data = NULL;
+    CZINT *self;
+
+    self = (CZINT *) CZINT_new((PyTypeObject *) type, NULL, NULL);
+    if (self == NULL) return NULL;
+
+    czint_reset(self);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_INIT),
+        args, PyVectorcall_NARGS(nargsf), kwnames,
+        CZINT_INIT_TARGETS(self, data)
+    ) || czint_setup(self, data)) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject *) self;
+}
+
 static PyObject* CZINT_repr(CZINT *self) {
     return PyUnicode_FromFormat(
         "<%s as %p: kind=%s (%d) buffer=%s (%d) option-1=%d option-2=%d option-3=%d>",
@@ -523,69 +470,7 @@ int parse_color_str(const char *str, char *target) {
 }
 
 
-PyDoc_STRVAR(CZINT_render_bmp_docstring,
-    "Render bmp barcode. Image will 1bit color depth "
-    "and user defined palette.\n\n"
-    "    Zint('data', BARCODE_QRCODE).render_bmp(angle: int = 0, fgcolor: str = '#FFFFFF', bgcolor: str = '#000000') -> bytes"
-);
-static PyObject* CZINT_render_bmp(
-    CZINT *self, PyObject *args, PyObject *kwds
-) {
-    static char *kwlist[] = {"angle", "fgcolor", "bgcolor", NULL};
-
-    int angle = 0;
-    unsigned int fgcolor[3] = {0, 0, 0};
-    unsigned int bgcolor[3] = {255, 255, 255};
-
-    char *fgcolor_str = NULL;
-    char *bgcolor_str = NULL;
-
-
-    if (!PyArg_ParseTupleAndKeywords(
-        args, kwds, "|iss", kwlist,
-        &angle, &fgcolor_str, &bgcolor_str
-    )) return NULL;
-
-    if (parse_color_hex(fgcolor_str, (unsigned int *)&fgcolor)) return NULL;
-    if (parse_color_hex(bgcolor_str, (unsigned int *)&bgcolor)) return NULL;
-
-    int res = 0;
-    char *bmp = NULL;
-    int bmp_1bit_size = 0;
-    unsigned int offset = 0;
-
-    static const unsigned int header_size = 62;
-    static const unsigned char bmp_template[] = {
-        0x42, 0x4d,
-        0x00, 0x00, 0x00, 0x00, // size
-        0x00, 0x00, 0x00, 0x00, // padding (zero)
-        0x3e, 0x00, 0x00, 0x00, // 62
-        0x28, 0x00, 0x00, 0x00, // 40
-        0x00, 0x00, 0x00, 0x00, // width
-        0x00, 0x00, 0x00, 0x00, // height
-        0x01, 0x00, 0x01, 0x00, // planes and bpp
-        0x00, 0x00, 0x00, 0x00, // compression
-        0x00, 0x00, 0x00, 0x00, // size
-        0xc4, 0x0e, 0x00, 0x00, // x pxls per meter
-        0xc4, 0x0e, 0x00, 0x00, // y pxls per meter
-        0x02, 0x00, 0x00, 0x00, // colors in table
-        0x02, 0x00, 0x00, 0x00, // important color in table
-        0x00, 0x00, 0x00, 0x00, // red channel - fgcolor
-        0xff, 0xff, 0xff, 0xff  // green channel - bgcolor
-    };
-
-    struct zint_symbol *symbol = ZBarcode_Create();
-
-    if (symbol == NULL) {
-        PyErr_Format(
-            PyExc_RuntimeError,
-            "Symbol initialization failed"
-        );
-        return NULL;
-    }
-
-    Py_BEGIN_ALLOW_THREADS
-
+static void czint_symbol_setup(CZINT *self, struct zint_symbol *symbol) {
     symbol->symbology = self->symbology;
     symbol->scale = self->scale;
     symbol->show_hrt = self->show_hrt;
@@ -606,417 +491,4010 @@ static PyObject* CZINT_render_bmp(
     if (self->text.len > 0) {
         memcpy(symbol->text, self->text.buf, self->text.len);
     }
+}
 
-    res = ZBarcode_Encode_and_Buffer(
-        symbol,
-        (unsigned char *)self->buffer,
-        self->length, angle
-    );
-
-    unsigned int width = symbol->bitmap_width;
-    unsigned int height = symbol->bitmap_height;
+static int czint_render_options_parse(
+    czint_render_options *options,
+    const char *fgcolor_str, const char *bgcolor_str
+) {
+    if (parse_color_hex(fgcolor_str, options->fgcolor)) return -1;
+    if (parse_color_hex(bgcolor_str, options->bgcolor)) return -1;
+    if (parse_color_str(fgcolor_str, options->fgcolour)) return -1;
+    if (parse_color_str(bgcolor_str, options->bgcolour)) return -1;
+    return 0;
+}
 
-    const int bmp_1bit_with_bytes = (width / 8 + (width % 8 == 0?0:1));
+static int parse_format(const char *str) {
+    if (strcmp(str, "bmp") == 0) return CZINT_FORMAT_BMP;
+    if (strcmp(str, "svg") == 0) return CZINT_FORMAT_SVG;
+    if (strcmp(str, "png") == 0) return CZINT_FORMAT_PNG;
+    if (strcmp(str, "zpl") == 0) return CZINT_FORMAT_ZPL;
+    if (strcmp(str, "escpos") == 0) return CZINT_FORMAT_ESCPOS;
 
-    const int padding = (bmp_1bit_with_bytes * 3) % 4;
-    bmp_1bit_size = (
-        header_size + bmp_1bit_with_bytes * height + (height * padding)
+    PyErr_Format(
+        PyExc_ValueError,
+        "Invalid format: %s. Format must be 'bmp', 'svg', 'png', "
+        "'zpl' or 'escpos'",
+        str
     );
+    return -1;
+}
 
-    if (res == 0) {
-        bmp = calloc(bmp_1bit_size * 1.1, sizeof(char *));
-
-        memcpy(bmp, &bmp_template, header_size);
-
-        unsigned int be_value = hton32(bmp_1bit_size);
-        bmp[5] = (unsigned char)(be_value);
-        bmp[4] = (unsigned char)(be_value >> 8);
-        bmp[3] = (unsigned char)(be_value >> 16);
-        bmp[2] = (unsigned char)(be_value >> 24);
-
-        be_value = hton32(width);
-        bmp[21] = (unsigned char)(be_value);
-        bmp[20] = (unsigned char)(be_value >> 8);
-        bmp[19] = (unsigned char)(be_value >> 16);
-        bmp[18] = (unsigned char)(be_value >> 24);
-
-        be_value = hton32(height);
-        bmp[25] = (unsigned char)(be_value);
-        bmp[24] = (unsigned char)(be_value >> 8);
-        bmp[23] = (unsigned char)(be_value >> 16);
-        bmp[22] = (unsigned char)(be_value >> 24);
-
-        bmp[54] = (unsigned char)fgcolor[0];
-        bmp[55] = (unsigned char)fgcolor[1];
-        bmp[56] = (unsigned char)fgcolor[2];
-
-        bmp[58] = (unsigned char)bgcolor[0];
-        bmp[59] = (unsigned char)bgcolor[1];
-        bmp[60] = (unsigned char)bgcolor[2];
-
-        char *pixels = &bmp[header_size];
-
-        for(int y=height-1; y >= 0; y--) {
-            for(int x=0; x < width; x+=8) {
-                pixels[offset] = octet2char(
-                    &symbol->bitmap[((y * width) + x) * 3], 3
-                );
-                offset++;
-            }
-            offset += padding;
+/* Parse png (level, strategy, filter) arguments, NULL means default */
+static int czint_png_options_parse(
+    czint_png_options *options,
+    int level, const char *strategy, const char *filter
+) {
+    if (level < -1 || level > 9) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "level must be in range -1..9 got %d",
+            level
+        );
+        return -1;
+    }
+    options->level = level;
+
+    if (strategy != NULL) {
+        options->strategy = czint_png_strategy(strategy);
+        if (options->strategy < 0) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "Invalid strategy: %s. Strategy must be 'default', "
+                "'filtered', 'huffman', 'rle' or 'fixed'",
+                strategy
+            );
+            return -1;
         }
     }
 
-    if (res == 0) {
-        ZBarcode_Clear(symbol);
-        ZBarcode_Delete(symbol);
+    if (filter != NULL) {
+        options->filter = czint_png_filter_type(filter);
+        if (options->filter < 0) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "Invalid filter: %s. Filter must be 'none', 'sub', 'up', "
+                "'average' or 'paeth'",
+                filter
+            );
+            return -1;
+        }
     }
 
-    Py_END_ALLOW_THREADS
+    return 0;
+}
 
-    if (res > 0) {
+/* Take ownership of rendered data. Raises on render error. */
+static PyObject* czint_result_bytes(czint_result *result) {
+    PyObject *bytes;
+    uint64_t started;
+
+    if (result->res > 0) {
         PyErr_CodeFormat(
             PyExc_RuntimeError,
-            res,
+            result->res,
             "Error while rendering: %s",
-            symbol->errtxt
+            result->errtxt
         );
-        ZBarcode_Clear(symbol);
-        ZBarcode_Delete(symbol);
         return NULL;
     }
 
-    PyObject *result = PyBytes_FromStringAndSize(bmp, bmp_1bit_size);
-    free(bmp);
-    return result;
+    started = czint_stats_start();
+    bytes = PyBytes_FromStringAndSize(result->data, result->size);
+    czint_stats_add(result->symbology, CZINT_STATS_COPY, started, result->size);
+    free(result->data);
+    result->data = NULL;
+    return bytes;
 }
 
-PyDoc_STRVAR(CZINT_render_svg_docstring,
-    "Render svg barcode.\n\n"
-    "    Zint('data', BARCODE_QRCODE).render_svg(angle: int = 0, fgcolor: str = '#FFFFFF', bgcolor: str = '#000000') -> bytes"
-);
-static PyObject* CZINT_render_svg(
-    CZINT *self, PyObject *args, PyObject *kwds
-) {
-    static char *kwlist[] = {"angle", "scale", "fgcolor", "bgcolor", NULL};
+typedef struct {
+    PyObject_HEAD
+    char *data;
+    Py_ssize_t size;
+    int width;
+    int height;
+    Py_ssize_t stride;
+    Py_ssize_t offset;
+} CZINTRaster;
 
-    int angle = 0;
-    char *fgcolor_str = "#000000";
-    char *bgcolor_str = "#FFFFFF";
+static void
+CZINTRaster_dealloc(CZINTRaster *self) {
+    free(self->data);
+    self->data = NULL;
 
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
 
-    if (!PyArg_ParseTupleAndKeywords(
-        args, kwds, "|iss", kwlist,
-        &angle, &fgcolor_str, &bgcolor_str
-    )) return NULL;
+static int
+CZINTRaster_getbuffer(CZINTRaster *self, Py_buffer *view, int flags) {
+    return PyBuffer_FillInfo(
+        view, (PyObject *) self, self->data, self->size, 1, flags
+    );
+}
 
+static Py_ssize_t CZINTRaster_length(CZINTRaster *self) {
+    return self->size;
+}
 
-    struct zint_symbol *symbol = ZBarcode_Create();
+static PyObject* CZINTRaster_repr(CZINTRaster *self) {
+    return PyUnicode_FromFormat(
+        "<%s as %p: width=%d height=%d stride=%zd size=%zd>",
+        Py_TYPE(self)->tp_name, self, self->width,
+        self->height, self->stride, self->size
+    );
+}
 
-    if (symbol == NULL) {
-        PyErr_Format(
+static PyMemberDef
+CZINTRaster_members[] = {
+    {
+        "width", T_INT,
+        offsetof(CZINTRaster, width),
+        READONLY, "Image width in pixels"
+    },
+    {
+        "height", T_INT,
+        offsetof(CZINTRaster, height),
+        READONLY, "Image height in pixels"
+    },
+    {
+        "stride", T_PYSSIZET,
+        offsetof(CZINTRaster, stride),
+        READONLY, "Bytes per pixel row including padding"
+    },
+    {
+        "offset", T_PYSSIZET,
+        offsetof(CZINTRaster, offset),
+        READONLY, "Offset of first pixel row in buffer"
+    },
+
+    {NULL}  /* Sentinel */
+};
+
+static PyType_Slot CZINTRaster_slots[] = {
+    {
+        Py_tp_doc,
+        "Rendered 1bit bmp image owning its native buffer. "
+        "Exposes the whole bmp file through the buffer protocol "
+        "without copying. Pixel rows start at offset, are stored "
+        "bottom-up, stride bytes apart, one bit per pixel with "
+        "the most significant bit first, 0 is fgcolor."
+    },
+    {Py_tp_dealloc, CZINTRaster_dealloc},
+    {Py_tp_members, CZINTRaster_members},
+    {Py_tp_repr, CZINTRaster_repr},
+    {Py_bf_getbuffer, CZINTRaster_getbuffer},
+    {Py_sq_length, CZINTRaster_length},
+    {0, NULL}
+};
+
+static PyType_Spec CZINTRaster_spec = {
+    .name = "pyzint.zint.Raster",
+    .basicsize = sizeof(CZINTRaster),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINTRaster_slots,
+};
+
+/* Hand rendered data over to a Raster without copying. Raises on
+ * render error. */
+static PyObject* czint_result_raster(
+    czint_state *state, czint_result *result
+) {
+    CZINTRaster *raster;
+
+    if (result->res > 0) {
+        PyErr_CodeFormat(
             PyExc_RuntimeError,
-            "Symbol initialization failed"
+            result->res,
+            "Error while rendering: %s",
+            result->errtxt
         );
         return NULL;
     }
 
-    if (parse_color_str(fgcolor_str, (char *)&symbol->fgcolour)) return NULL;
-    if (parse_color_str(bgcolor_str, (char *)&symbol->bgcolour)) return NULL;
-
-    symbol->symbology = self->symbology;
-    symbol->scale = self->scale;
-    symbol->show_hrt = self->show_hrt;
-    symbol->option_1 = self->option_1;
-    symbol->option_2 = self->option_2;
-    symbol->option_3 = self->option_3;
-    symbol->fontsize = self->fontsize;
-    symbol->height = self->height;
-    symbol->whitespace_width = self->whitespace_width;
-    symbol->border_width = self->border_width;
-    symbol->eci = self->eci;
-    symbol->dot_size = self->dot_size;
-
-    if (self->primary.len > 0) {
-        memcpy(symbol->primary, self->primary.buf, self->primary.len);
+    raster = PyObject_New(CZINTRaster, state->RasterType);
+    if (raster == NULL) {
+        free(result->data);
+        result->data = NULL;
+        return NULL;
     }
 
-    if (self->text.len > 0) {
-        memcpy(symbol->text, self->text.buf, self->text.len);
-    }
+    raster->data = result->data;
+    raster->size = result->size;
+    raster->width = result->width;
+    raster->height = result->height;
+    raster->stride = result->stride;
+    raster->offset = result->offset;
+    result->data = NULL;
+    return (PyObject *) raster;
+}
 
+typedef struct {
+    PyObject_HEAD
+    char *data;
+    Py_ssize_t size;
+    Py_ssize_t stride;
+    Py_ssize_t shape[2];    /* rows, stride */
+    Py_ssize_t strides[2];
+    int rows;
+    int columns;
+} CZINTMatrix;
 
-    int res = 0;
-    char *fsvg = NULL;
-    int len_fsvg = 0;
-    int max_len = 4 * 1024 * 1024;
-    struct zint_vector_rect *rect;
-    struct zint_vector_hexagon *hex;
-    struct zint_vector_circle *circle;
-    struct zint_vector_string *string;
-    float ax, ay, bx, by, cx, cy, dx, dy, ex, ey, fx, fy;
-    float radius;
+static void
+CZINTMatrix_dealloc(CZINTMatrix *self) {
+    free(self->data);
+    self->data = NULL;
 
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
 
-    Py_BEGIN_ALLOW_THREADS
+/* Rows x stride bytes, C contiguous, so numpy may view it as 2D uint8
+ * array without copying */
+static int
+CZINTMatrix_getbuffer(CZINTMatrix *self, Py_buffer *view, int flags) {
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "Matrix is not writable");
+        view->obj = NULL;
+        return -1;
+    }
 
-    res = ZBarcode_Encode_and_Buffer_Vector(symbol, (unsigned char *)self->buffer, self->length, angle);
+    view->obj = (PyObject *) self;
+    Py_INCREF(self);
+    view->buf = self->data;
+    view->len = self->size;
+    view->readonly = 1;
+    view->itemsize = 1;
+    view->format = (flags & PyBUF_FORMAT) ? "B" : NULL;
+    view->ndim = (flags & PyBUF_ND) == PyBUF_ND ? 2 : 1;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : NULL;
+    view->strides = (
+        (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL
+    );
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
 
-    if (res == 0) {
+static Py_ssize_t CZINTMatrix_length(CZINTMatrix *self) {
+    return self->size;
+}
 
-        int html_len = strlen((char *)symbol->text) + 1;
-
-        {
-            unsigned int text_length = strlen((char *)symbol->text);
-            for(unsigned int i = 0; i < text_length; i++) {
-                switch(symbol->text[i]) {
-                    case '>':
-                    case '<':
-                    case '"':
-                    case '&':
-                    case '\'':
-                        html_len += 6;
-                        break;
-                }
-            }
-        }
-        char *html_string = calloc(sizeof(char), html_len);
-
-        fsvg = calloc(max_len, sizeof(char *));
-
-        /* Start writing the header */
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<?xml version=\"1.0\" standalone=\"no\"?>\n");
-
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n");
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<svg width=\"%d\" height=\"%d\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\">\n", (int) ceil(symbol->vector->width), (int) ceil(symbol->vector->height));
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<desc>Zint Generated Symbol via pyzint</desc>\n");
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<g id=\"barcode\" fill=\"#%s\">\n", symbol->fgcolour);
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len, "<rect x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" fill=\"#%s\" />\n", (int) ceil(symbol->vector->width), (int) ceil(symbol->vector->height), symbol->bgcolour);
-        rect = symbol->vector->rectangles;
-        while (rect) {
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" />\n", rect->x, rect->y, rect->width, rect->height);
-            rect = rect->next;
-        }
+static PyObject* CZINTMatrix_repr(CZINTMatrix *self) {
+    return PyUnicode_FromFormat(
+        "<%s as %p: rows=%d columns=%d stride=%zd>",
+        Py_TYPE(self)->tp_name, self, self->rows,
+        self->columns, self->stride
+    );
+}
 
-        hex = symbol->vector->hexagons;
-        while (hex) {
-            radius = hex->diameter / 2.0;
-            ay = hex->y + (1.0 * radius);
-            by = hex->y + (0.5 * radius);
-            cy = hex->y - (0.5 * radius);
-            dy = hex->y - (1.0 * radius);
-            ey = hex->y - (0.5 * radius);
-            fy = hex->y + (0.5 * radius);
-            ax = hex->x;
-            bx = hex->x + (0.86 * radius);
-            cx = hex->x + (0.86 * radius);
-            dx = hex->x;
-            ex = hex->x - (0.86 * radius);
-            fx = hex->x - (0.86 * radius);
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "<path d=\"M %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f Z\" \n/>", ax, ay, bx, by, cx, cy, dx, dy, ex, ey, fx, fy);
-            hex = hex->next;
-        }
+static PyMemberDef
+CZINTMatrix_members[] = {
+    {
+        "rows", T_INT,
+        offsetof(CZINTMatrix, rows),
+        READONLY, "Number of module rows"
+    },
+    {
+        "columns", T_INT,
+        offsetof(CZINTMatrix, columns),
+        READONLY, "Number of modules in a row"
+    },
+    {
+        "stride", T_PYSSIZET,
+        offsetof(CZINTMatrix, stride),
+        READONLY, "Bytes per row"
+    },
 
-        circle = symbol->vector->circles;
-        while (circle) {
-            if (circle->colour) {
-                len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"#%s\" \n/>", circle->x, circle->y, circle->diameter / 2.0, symbol->bgcolour);
+    {NULL}  /* Sentinel */
+};
+
+static PyType_Slot CZINTMatrix_slots[] = {
+    {
+        Py_tp_doc,
+        "Module matrix of encoded symbol owning its native buffer. "
+        "Exposes rows x stride bytes through the buffer protocol with "
+        "shape and strides, without copying. Rows are stored top-down, "
+        "one bit per module with the most significant bit first, "
+        "1 is a dark module. Unused bits of the last byte are 0."
+    },
+    {Py_tp_dealloc, CZINTMatrix_dealloc},
+    {Py_tp_members, CZINTMatrix_members},
+    {Py_tp_repr, CZINTMatrix_repr},
+    {Py_bf_getbuffer, CZINTMatrix_getbuffer},
+    {Py_sq_length, CZINTMatrix_length},
+    {0, NULL}
+};
+
+static PyType_Spec CZINTMatrix_spec = {
+    .name = "pyzint.zint.Matrix",
+    .basicsize = sizeof(CZINTMatrix),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINTMatrix_slots,
+};
+
+/* Encode data into set up symbol, input registry knows zint would
+ * refuse is rejected before encoding. Called without GIL. */
+static int czint_encode_symbol(
+    struct zint_symbol *symbol, const char *data, Py_ssize_t length
+) {
+    uint64_t started;
+    int res;
+
+    res = czint_symbology_check(symbol, (const unsigned char *) data, length);
+    if (res) return res;
+
+    started = czint_stats_start();
+    res = ZBarcode_Encode(symbol, (unsigned char *) data, length);
+    czint_stats_add(symbol->symbology, CZINT_STATS_ENCODE, started, length);
+    return res;
+}
+
+/* Encode data on first use and keep encoded symbol on the object,
+ * later renders only run raster or vector stage. Returns copy of
+ * encoded symbol taken under self->lock, which re-initialization may
+ * delete once it is released, or NULL with error set in result.
+ * Warnings fail like errors unless warnings is set, result keeps them
+ * either way. Called without GIL. */
+static struct zint_symbol *czint_encode(
+    CZINT *self, int warnings, czint_result *result
+) {
+    struct zint_symbol *symbol = NULL;
+
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+
+    if (self->symbol == NULL) {
+        symbol = ZBarcode_Create();
+
+        if (symbol == NULL) {
+            PyThread_release_lock(self->lock);
+            czint_result_error(result, "Symbol initialization failed");
+            return NULL;
+        }
+
+        czint_symbol_setup(self, symbol);
+
+        self->symbol_result = czint_encode_symbol(
+            symbol, self->buffer, self->length
+        );
+        self->symbol = symbol;
+        symbol = NULL;
+    }
+
+    czint_result_set(result, self->symbol, self->symbol_result);
+
+    if (result->res < (warnings ? ZINT_ERROR_TOO_LONG : 1)) {
+        symbol = czint_symbol_acquire_copy(self->symbol);
+        if (symbol == NULL) czint_result_error(result, "Insufficient memory");
+    }
+
+    PyThread_release_lock(self->lock);
+    return symbol;
+}
+
+/* Called without GIL. */
+static void czint_render_encoded(
+    CZINT *self, int format,
+    const czint_render_options *options, czint_result *result
+) {
+    struct zint_symbol *symbol = czint_encode(self, 0, result);
+
+    if (symbol == NULL) return;
+
+    czint_render_symbol(symbol, format, options, result);
+    czint_symbol_release(symbol);
+}
+
+
+/* Learn bmp dimensions of encoded symbol copy from direct layout when
+ * *direct is set and symbol allows it, otherwise by buffering it, which
+ * clears *direct and leaves bitmap for czint_make_bmp. Returns zint
+ * error code. Called without GIL. */
+static int czint_measure_bmp_symbol(
+    struct zint_symbol *symbol, int angle, int *direct, czint_result *result
+) {
+    czint_direct_layout layout;
+    int res;
+
+    if (*direct && czint_direct_layout_init(symbol, angle, &layout) == 0) {
+        result->width = layout.width * layout.k;
+        result->height = layout.height * layout.k;
+        result->size = czint_bmp_size(
+            result->width, result->height, &result->stride
+        );
+        result->offset = CZINT_BMP_HEADER_SIZE;
+        return 0;
+    }
+
+    *direct = 0;
+    res = ZBarcode_Buffer(symbol, angle);
+    if (res == 0) {
+        result->width = symbol->bitmap_width;
+        result->height = symbol->bitmap_height;
+        result->size = czint_bmp_size(
+            result->width, result->height, &result->stride
+        );
+        result->offset = CZINT_BMP_HEADER_SIZE;
+    }
+
+    czint_result_set(result, symbol, res);
+    return res;
+}
+
+/* Buffer encoded symbol only to learn bmp dimensions.
+ * Called without GIL. */
+static void czint_measure_bmp(
+    CZINT *self, int angle, int direct, czint_result *result
+) {
+    struct zint_symbol *symbol = czint_encode(self, 0, result);
+
+    if (symbol == NULL) return;
+
+    czint_measure_bmp_symbol(symbol, angle, &direct, result);
+    czint_symbol_release(symbol);
+}
+
+/* Render bmp into result->data when it fits into result->capacity
+ * bytes, otherwise only fill result->size. Size is learned like
+ * czint_measure_bmp does before any pixel is drawn, and the buffered
+ * symbol is packed afterwards without a second raster stage.
+ * Called without GIL. */
+static void czint_render_bmp_into(
+    CZINT *self, const czint_render_options *options, czint_result *result
+) {
+    struct zint_symbol *symbol = czint_encode(self, 0, result);
+    int direct = options->direct;
+    uint64_t started;
+    int res;
+
+    if (symbol == NULL) return;
+
+    started = czint_stats_start();
+    res = czint_measure_bmp_symbol(symbol, options->angle, &direct, result);
+    if (res == 0 && !direct) {
+        czint_stats_add(
+            symbol->symbology, CZINT_STATS_RASTER, started,
+            (uint64_t) symbol->bitmap_width * symbol->bitmap_height * 3
+        );
+    }
+
+    if (res == 0 && result->size <= result->capacity) {
+        started = czint_stats_start();
+        if (direct) {
+            res = czint_make_bmp_direct(
+                symbol, options->angle,
+                options->fgcolor, options->bgcolor, result
+            );
+        } else {
+            res = czint_make_bmp(
+                symbol, options->fgcolor, options->bgcolor, result
+            );
+        }
+        if (res) {
+            czint_result_set(result, symbol, czint_symbol_oom(symbol));
+        } else {
+            czint_stats_add(
+                symbol->symbology, CZINT_STATS_BMP, started, result->size
+            );
+        }
+    }
+
+    czint_symbol_release(symbol);
+}
+
+
+/* Fixed part of render cache key: every symbol setting and render
+ * option that changes rendered bytes. Zeroed before filling, so padding
+ * compares equal. Primary, text and data follow it. */
+typedef struct {
+    int format;
+    int symbology;
+    int option_1;
+    int option_2;
+    int option_3;
+    int show_hrt;
+    int fontsize;
+    int height;
+    int whitespace_width;
+    int border_width;
+    int eci;
+    float scale;
+    float dot_size;
+    int angle;
+    int direct;
+    int compact;
+    unsigned int fgcolor[3];
+    unsigned int bgcolor[3];
+    char fgcolour[6];
+    char bgcolour[6];
+    czint_png_options png;
+    czint_zpl_options zpl;
+    Py_ssize_t primary_length;
+    Py_ssize_t text_length;
+} czint_cache_header;
+
+/* Render cache key of data rendered with settings of self, NULL when
+ * out of memory. Settings of Zint objects are only stable with GIL
+ * held, batch templates may be read without it. */
+static unsigned char *czint_cache_key(
+    const CZINT *self, int format, const czint_render_options *options,
+    const char *data, Py_ssize_t length, size_t *size
+) {
+    czint_cache_header header;
+    unsigned char *key, *end;
+
+    memset(&header, 0, sizeof(header));
+    header.format = format;
+    header.symbology = self->symbology;
+    header.option_1 = self->option_1;
+    header.option_2 = self->option_2;
+    header.option_3 = self->option_3;
+    header.show_hrt = self->show_hrt;
+    header.fontsize = self->fontsize;
+    header.height = self->height;
+    header.whitespace_width = self->whitespace_width;
+    header.border_width = self->border_width;
+    header.eci = self->eci;
+    header.scale = self->scale;
+    header.dot_size = self->dot_size;
+    header.angle = options->angle;
+    header.direct = options->direct;
+    header.compact = options->compact;
+    memcpy(header.fgcolor, options->fgcolor, sizeof(header.fgcolor));
+    memcpy(header.bgcolor, options->bgcolor, sizeof(header.bgcolor));
+    memcpy(header.fgcolour, options->fgcolour, sizeof(header.fgcolour));
+    memcpy(header.bgcolour, options->bgcolour, sizeof(header.bgcolour));
+    header.png.level = options->png.level;
+    header.png.strategy = options->png.strategy;
+    header.png.filter = options->png.filter;
+    header.zpl.compression = options->zpl.compression;
+    header.zpl.label = options->zpl.label;
+    header.primary_length = self->primary.buf ? self->primary.len : 0;
+    header.text_length = self->text.buf ? self->text.len : 0;
+
+    *size = sizeof(header) + header.primary_length + header.text_length + length;
+    key = malloc(*size ? *size : 1);
+    if (key == NULL) return NULL;
+
+    memcpy(key, &header, sizeof(header));
+    end = key + sizeof(header);
+    if (header.primary_length) {
+        memcpy(end, self->primary.buf, header.primary_length);
+        end += header.primary_length;
+    }
+    if (header.text_length) {
+        memcpy(end, self->text.buf, header.text_length);
+        end += header.text_length;
+    }
+    if (length) memcpy(end, data, length);
+    return key;
+}
+
+/* czint_cache_free of render cache */
+static void czint_cache_decref(void *value) {
+    Py_DECREF((PyObject *) value);
+}
+
+/* Keep bytes in render cache, failures only mean it is not cached */
+static void czint_cache_store(
+    czint_cache *cache, const unsigned char *key, size_t key_size,
+    uint64_t hash, PyObject *bytes
+) {
+    Py_INCREF(bytes);
+    if (czint_cache_put(
+        cache, key, key_size, hash, bytes, PyBytes_GET_SIZE(bytes)
+    )) Py_DECREF(bytes);
+}
+
+typedef struct {
+    PyObject_HEAD
+    czint_shm shm;
+    PyObject *path;
+} CZINTSharedCache;
+
+static PyObject* CZINTSharedCache_new(
+    PyTypeObject *type, PyObject *args, PyObject *kwds
+) {
+    static char *kwlist[] = {"path", "size", NULL};
+
+    PyObject *path = Py_None;
+    PyObject *path_bytes = NULL;
+    Py_ssize_t size = CZINT_SHM_SIZE_DEFAULT;
+    CZINTSharedCache *self;
+    int res;
+
+    if (!PyArg_ParseTupleAndKeywords(
+        args, kwds, "|On", kwlist, &path, &size
+    )) return NULL;
+
+    if (size < CZINT_SHM_SIZE_MIN) {
+        PyErr_Format(
+            PyExc_ValueError, "size must be at least %d got %zd",
+            CZINT_SHM_SIZE_MIN, size
+        );
+        return NULL;
+    }
+
+    if (path != Py_None && !PyUnicode_FSConverter(path, &path_bytes)) {
+        return NULL;
+    }
+
+    self = (CZINTSharedCache *) type->tp_alloc(type, 0);
+    if (self == NULL) {
+        Py_XDECREF(path_bytes);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    res = czint_shm_open(
+        &self->shm,
+        path_bytes == NULL ? NULL : PyBytes_AS_STRING(path_bytes),
+        (size_t) size
+    );
+    Py_END_ALLOW_THREADS
+
+    Py_XDECREF(path_bytes);
+
+    if (res == -1) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+    } else if (res) {
+        PyErr_Format(
+            PyExc_ValueError, "%R does not hold a pyzint shared cache", path
+        );
+    }
+    if (res) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    Py_INCREF(path);
+    self->path = path;
+    return (PyObject *) self;
+}
+
+static void
+CZINTSharedCache_dealloc(CZINTSharedCache *self) {
+    czint_shm_close(&self->shm);
+    Py_XDECREF(self->path);
+
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
+
+static PyObject* CZINTSharedCache_repr(CZINTSharedCache *self) {
+    return PyUnicode_FromFormat(
+        "<%s as %p: path=%R size=%zd>",
+        Py_TYPE(self)->tp_name, self, self->path, (Py_ssize_t) self->shm.size
+    );
+}
+
+PyDoc_STRVAR(CZINTSharedCache_stats_docstring,
+    "Counters summed over every process using the segment: lookups "
+    "which hit and missed, records stored and index slots taken over "
+    "from older records. Entries are live records now, slots and "
+    "capacity bound how many and how many bytes fit.\n\n"
+    "    SharedCache.stats() -> Dict[str, int]"
+);
+static PyObject* CZINTSharedCache_stats(
+    CZINTSharedCache *self, PyObject *unused
+) {
+    czint_shm_stats stats;
+
+    czint_shm_stats_get(&self->shm, &stats);
+
+    return Py_BuildValue(
+        "{sKsKsKsKsnsnsnsn}",
+        "hits", stats.hits,
+        "misses", stats.misses,
+        "insertions", stats.insertions,
+        "evictions", stats.evictions,
+        "entries", (Py_ssize_t) stats.entries,
+        "slots", (Py_ssize_t) stats.slots,
+        "capacity", (Py_ssize_t) stats.capacity,
+        "size", (Py_ssize_t) stats.size
+    );
+}
+
+PyDoc_STRVAR(CZINTSharedCache_clear_docstring,
+    "Drop every record for all processes, counters stay.\n\n"
+    "    SharedCache.clear() -> None"
+);
+static PyObject* CZINTSharedCache_clear(
+    CZINTSharedCache *self, PyObject *unused
+) {
+    int res;
+
+    Py_BEGIN_ALLOW_THREADS
+    res = czint_shm_clear(&self->shm);
+    Py_END_ALLOW_THREADS
+
+    if (res) {
+        errno = EBUSY;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef CZINTSharedCache_methods[] = {
+    {
+        "stats",
+        (PyCFunction) CZINTSharedCache_stats, METH_NOARGS,
+        CZINTSharedCache_stats_docstring
+    },
+    {
+        "clear",
+        (PyCFunction) CZINTSharedCache_clear, METH_NOARGS,
+        CZINTSharedCache_clear_docstring
+    },
+    {NULL}  /* Sentinel */
+};
+
+static PyMemberDef CZINTSharedCache_members[] = {
+    {
+        "path", T_OBJECT,
+        offsetof(CZINTSharedCache, path),
+        READONLY, "Mapped file, None for anonymous segment"
+    },
+    {NULL}  /* Sentinel */
+};
+
+static PyType_Slot CZINTSharedCache_slots[] = {
+    {
+        Py_tp_doc,
+        "Render cache in a memory segment shared by processes, for "
+        "pre-fork servers where every worker would warm its own cache. "
+        "Maps the file at path, creating it with size bytes when empty, "
+        "so any process opening the same path (a file in /dev/shm for "
+        "instance) shares it. Without path the segment is anonymous "
+        "and shared with processes forked afterwards. Oldest records "
+        "are overwritten first. Enable it with set_shared_render_cache.\n\n"
+        "    SharedCache(path: Optional[str] = None, size: int = 64 MiB)"
+    },
+    {Py_tp_new, CZINTSharedCache_new},
+    {Py_tp_dealloc, CZINTSharedCache_dealloc},
+    {Py_tp_repr, CZINTSharedCache_repr},
+    {Py_tp_methods, CZINTSharedCache_methods},
+    {Py_tp_members, CZINTSharedCache_members},
+    {0, NULL}
+};
+
+static PyType_Spec CZINTSharedCache_spec = {
+    .name = "pyzint.zint.SharedCache",
+    .basicsize = sizeof(CZINTSharedCache),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINTSharedCache_slots,
+};
+
+/* New reference to shared render cache in use, NULL when there is none */
+static CZINTSharedCache *czint_shared_cache_get(czint_state *state) {
+    PyObject *shared;
+
+    PyThread_acquire_lock(state->shared_lock, WAIT_LOCK);
+    shared = state->shared_cache;
+    Py_XINCREF(shared);
+    PyThread_release_lock(state->shared_lock);
+    return (CZINTSharedCache *) shared;
+}
+
+/* Render into bytes through render caches. Lookups run without GIL
+ * together with rendering, a hit of the process cache returns stored
+ * bytes object, a hit of the shared one copies its record, neither
+ * encodes or renders. */
+static PyObject *czint_render_cached(
+    CZINT *self, int format, const czint_render_options *options
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_cache *cache = &state->cache;
+    CZINTSharedCache *shared = czint_shared_cache_get(state);
+    czint_cache_entry *entry = NULL;
+    czint_result result = {0};
+    unsigned char *key = NULL;
+    size_t key_size = 0;
+    uint64_t hash = 0;
+    int shared_hit = 0;
+    PyObject *bytes;
+
+    /* Key is built with GIL held, re-initialization of self swaps
+     * payload, primary and text only with GIL held too */
+    if (czint_cache_enabled(cache) || shared != NULL) {
+        key = czint_cache_key(
+            self, format, options, self->buffer, self->length, &key_size
+        );
+        result.symbology = self->symbology;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (key != NULL) {
+        hash = czint_cache_hash(key, key_size);
+        entry = czint_cache_get(cache, key, key_size, hash);
+
+        if (entry == NULL && shared != NULL) {
+            shared_hit = czint_shm_get(
+                &shared->shm, key, key_size, hash, &result.data, &result.size
+            ) > 0;
+        }
+    }
+    if (entry == NULL && !shared_hit) {
+        czint_render_encoded(self, format, options, &result);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (entry != NULL) {
+        bytes = entry->value;
+        Py_INCREF(bytes);
+        czint_cache_release(cache, entry);
+        goto exit;
+    }
+
+    bytes = czint_result_bytes(&result);
+    if (bytes == NULL || key == NULL) goto exit;
+
+    czint_cache_store(cache, key, key_size, hash, bytes);
+
+    if (shared != NULL && !shared_hit) {
+        Py_BEGIN_ALLOW_THREADS
+        czint_shm_put(
+            &shared->shm, key, key_size, hash,
+            PyBytes_AS_STRING(bytes), PyBytes_GET_SIZE(bytes)
+        );
+        Py_END_ALLOW_THREADS
+    }
+
+exit:
+    Py_XDECREF(shared);
+    free(key);
+    return bytes;
+}
+
+
+/* Parse (angle, fgcolor, bgcolor, direct, compact) arguments of
+ * method with signature id */
+static int czint_render_parse(
+    CZINT *self, int id,
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+    czint_render_options *options
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    const char *fgcolor_str = NULL;
+    const char *bgcolor_str = NULL;
+
+    czint_render_options_init(options);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, id), args, nargs, kwnames,
+        &options->angle, &fgcolor_str, &bgcolor_str,
+        &options->direct, &options->compact
+    )) return -1;
+
+    return czint_render_options_parse(options, fgcolor_str, bgcolor_str);
+}
+
+/* Parse render arguments and render one format */
+static int czint_render_args(
+    CZINT *self, int id,
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames,
+    int format, czint_result *result
+) {
+    czint_render_options options;
+
+    if (czint_render_parse(self, id, args, nargs, kwnames, &options)) return -1;
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_render_encoded(self, format, &options, result);
+    Py_END_ALLOW_THREADS
+
+    return 0;
+}
+
+
+PyDoc_STRVAR(CZINT_render_bmp_docstring,
+    "Render bmp barcode. Image will 1bit color depth "
+    "and user defined palette.\n\n"
+    "With direct=True image is drawn straight from encoded module "
+    "matrix without intermediate 24bit raster, when symbol allows "
+    "it (no human readable text, no rotation, scale multiple of 0.5). "
+    "Other symbols are rendered as usual.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_bmp(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_bmp(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_render_options options;
+
+    if (czint_render_parse(
+        self, CZINT_ARGS_RENDER_BMP, args, nargs, kwnames, &options
+    )) return NULL;
+    return czint_render_cached(self, CZINT_FORMAT_BMP, &options);
+}
+
+PyDoc_STRVAR(CZINT_render_bmp_buffer_docstring,
+    "Render bmp barcode like render_bmp, but return Raster object "
+    "which owns rendered image and exposes it through buffer protocol "
+    "without copying into bytes.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_bmp_buffer(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False) -> Raster"
+);
+static PyObject* CZINT_render_bmp_buffer(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_result result = {0};
+
+    if (czint_render_args(
+        self, CZINT_ARGS_RENDER_BMP_BUFFER, args, nargs, kwnames, CZINT_FORMAT_BMP, &result
+    )) return NULL;
+    return czint_result_raster(czint_get_state((PyObject *) self), &result);
+}
+
+/* Encode if needed and pack module matrix. Called without GIL. */
+static void czint_render_matrix(CZINT *self, czint_result *result) {
+    struct zint_symbol *symbol = czint_encode(self, 0, result);
+
+    if (symbol == NULL) return;
+
+    if (czint_make_matrix(symbol, result)) {
+        czint_result_error(result, "Insufficient memory");
+    }
+    czint_symbol_release(symbol);
+}
+
+PyDoc_STRVAR(CZINT_render_matrix_docstring,
+    "Return module matrix of encoded symbol as Matrix object, without "
+    "raster stage, scaling, quiet zones or text. Matrix exposes rows "
+    "of bit packed modules through buffer protocol, numpy.unpackbits("
+    "numpy.asarray(matrix), axis=1)[:, :matrix.columns] gives one byte "
+    "per module.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_matrix() -> Matrix"
+);
+static PyObject* CZINT_render_matrix(CZINT *self, PyObject *unused) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_result result = {0};
+    CZINTMatrix *matrix;
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_render_matrix(self, &result);
+    Py_END_ALLOW_THREADS
+
+    if (result.res > 0) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError,
+            result.res,
+            "Error while rendering: %s",
+            result.errtxt
+        );
+        return NULL;
+    }
+
+    matrix = PyObject_New(CZINTMatrix, state->MatrixType);
+    if (matrix == NULL) {
+        free(result.data);
+        return NULL;
+    }
+
+    matrix->data = result.data;
+    matrix->size = result.size;
+    matrix->rows = result.height;
+    matrix->columns = result.width;
+    matrix->stride = result.stride;
+    matrix->shape[0] = result.height;
+    matrix->shape[1] = result.stride;
+    matrix->strides[0] = result.stride;
+    matrix->strides[1] = 1;
+    return (PyObject *) matrix;
+}
+
+PyDoc_STRVAR(CZINT_render_bmp_into_docstring,
+    "Render bmp barcode straight into writable buffer (bytearray, mmap, "
+    "etc.) at offset, without allocating image. Returns number of "
+    "bytes written. Use bmp_size() to learn required size.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_bmp_into(buffer, offset: int = 0, angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False) -> int"
+);
+static PyObject* CZINT_render_bmp_into(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+    czint_result result = {0};
+    Py_buffer view;
+    Py_ssize_t offset = 0;
+
+    const char *fgcolor_str = NULL;
+    const char *bgcolor_str = NULL;
+
+    czint_render_options_init(&options);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_RENDER_INTO), args, nargs, kwnames,
+        &view, &offset, &options.angle, &fgcolor_str, &bgcolor_str,
+        &options.direct
+    )) return NULL;
+
+    if (offset < 0 || offset > view.len) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "offset must be in range 0..%zd got %zd",
+            view.len, offset
+        );
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    if (czint_render_options_parse(&options, fgcolor_str, bgcolor_str)) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+
+    result.data = (char *) view.buf + offset;
+    result.capacity = view.len - offset;
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_render_bmp_into(self, &options, &result);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&view);
+
+    if (result.res > 0) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError,
+            result.res,
+            "Error while rendering: %s",
+            result.errtxt
+        );
+        return NULL;
+    }
+
+    if (result.size > result.capacity) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "buffer is too small, %zu bytes required at offset %zd got %zu",
+            result.size, offset, result.capacity
+        );
+        return NULL;
+    }
+
+    return PyLong_FromSize_t(result.size);
+}
+
+PyDoc_STRVAR(CZINT_bmp_size_docstring,
+    "Size in bytes of bmp image render_bmp would produce.\n\n"
+    "    Zint('data', BARCODE_QRCODE).bmp_size(angle: int = 0, direct: bool = False) -> int"
+);
+static PyObject* CZINT_bmp_size(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_result result = {0};
+    int angle = 0;
+    int direct = 0;
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_BMP_SIZE), args, nargs, kwnames,
+        &angle, &direct
+    )) return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_measure_bmp(self, angle, direct, &result);
+    Py_END_ALLOW_THREADS
+
+    if (result.res > 0) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError,
+            result.res,
+            "Error while rendering: %s",
+            result.errtxt
+        );
+        return NULL;
+    }
+
+    return PyLong_FromSize_t(result.size);
+}
+
+/* Set dict[key] to value, None when not present. Returns -1 with
+ * exception set. */
+static int czint_dict_set_optional(
+    PyObject *dict, const char *key, int present, long value
+) {
+    PyObject *item;
+    int res;
+
+    if (present) {
+        item = PyLong_FromLong(value);
+        if (item == NULL) return -1;
+    } else {
+        Py_INCREF(Py_None);
+        item = Py_None;
+    }
+
+    res = PyDict_SetItemString(dict, key, item);
+    Py_DECREF(item);
+    return res;
+}
+
+/* Encode if needed and compute output sizes without raster or vector
+ * stage, along with rows and columns of module matrix. Returns -1 when
+ * only those stages know the sizes, errors are reported through result.
+ * Called without GIL. */
+static int czint_measure_encoded(
+    CZINT *self, int angle, czint_measure *measure, int *rows, int *columns,
+    czint_result *result
+) {
+    struct zint_symbol *symbol = czint_encode(self, 1, result);
+    int unknown;
+
+    if (symbol == NULL) return 0;
+
+    if (angle != 0 && angle != 90 && angle != 180 && angle != 270) {
+        result->res = ZINT_ERROR_INVALID_OPTION;
+        strcpy(result->errtxt, "Invalid rotation angle");
+        czint_symbol_release(symbol);
+        return 0;
+    }
+
+    *rows = symbol->rows;
+    *columns = symbol->width;
+    unknown = czint_measure_symbol(symbol, angle, measure);
+    czint_symbol_release(symbol);
+    return unknown;
+}
+
+PyDoc_STRVAR(CZINT_measure_docstring,
+    "Encode symbol and return its dimensions without rendering: rows "
+    "and columns of module matrix, bitmap_width and bitmap_height of "
+    "render_bmp image, vector_width and vector_height of render_svg "
+    "image and warning code of encoder (None without warning). Image "
+    "sizes are None where only rendering can tell: MaxiCode, dotty "
+    "symbols, UPC/EAN with text, and svg text in non default font size.\n\n"
+    "    Zint('data', BARCODE_QRCODE).measure(angle: int = 0) -> Dict[str, Optional[int]]"
+);
+static PyObject* CZINT_measure(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    static const char *const keys[] = {
+        "bitmap_width", "bitmap_height", "vector_width", "vector_height"
+    };
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_result result = {0};
+    czint_measure measure;
+    PyObject *dict;
+    int angle = 0, unknown, rows = 0, columns = 0, sizes[4];
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_MEASURE), args, nargs, kwnames, &angle
+    )) return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    unknown = czint_measure_encoded(
+        self, angle, &measure, &rows, &columns, &result
+    );
+    Py_END_ALLOW_THREADS
+
+    if (result.res >= ZINT_ERROR_TOO_LONG) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError,
+            result.res,
+            "Error while rendering: %s",
+            result.errtxt
+        );
+        return NULL;
+    }
+
+    dict = Py_BuildValue(
+        "{s:i,s:i}", "rows", rows, "columns", columns
+    );
+    if (dict == NULL) return NULL;
+
+    sizes[0] = measure.bitmap_width;
+    sizes[1] = measure.bitmap_height;
+    sizes[2] = measure.vector_width;
+    sizes[3] = measure.vector_height;
+
+    for (int i = 0; i < 4; i++) {
+        if (czint_dict_set_optional(
+            dict, keys[i], !unknown && sizes[i] >= 0, sizes[i]
+        )) goto error;
+    }
+    if (czint_dict_set_optional(dict, "warning", result.res != 0, result.res)) goto error;
+    return dict;
+
+error:
+    Py_DECREF(dict);
+    return NULL;
+}
+
+PyDoc_STRVAR(CZINT_render_svg_docstring,
+    "Render svg barcode.\n\n"
+    "With compact=True adjacent modules are merged into runs and all "
+    "bars are written as one path element with relative coordinates, "
+    "which makes output several times smaller.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_svg(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', compact: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_svg(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_render_options options;
+
+    if (czint_render_parse(
+        self, CZINT_ARGS_RENDER_SVG, args, nargs, kwnames, &options
+    )) return NULL;
+    return czint_render_cached(self, CZINT_FORMAT_SVG, &options);
+}
+
+/* Called without GIL. */
+static void czint_stream_encoded(
+    CZINT *self, int format,
+    const czint_render_options *options, czint_sink *sink,
+    czint_result *result
+) {
+    struct zint_symbol *symbol = czint_encode(self, 0, result);
+    int res;
+
+    if (symbol == NULL) return;
+
+    if (format == CZINT_FORMAT_BMP) {
+        res = czint_stream_bmp_symbol(symbol, options, sink);
+    } else {
+        res = czint_stream_svg_symbol(symbol, options, sink);
+    }
+
+    czint_result_set(result, symbol, res);
+    czint_symbol_release(symbol);
+}
+
+/* Sink calling write() of Python file object. Render runs without GIL
+ * and thread is its saved state, GIL is taken back for write only. */
+typedef struct {
+    PyObject *write;
+    PyThreadState *thread;
+} czint_file_sink;
+
+static int czint_file_sink_write(void *ctx, struct iovec *iov, int count) {
+    czint_file_sink *file = ctx;
+    PyObject *chunk, *piece = NULL, *written = NULL;
+    Py_ssize_t size = 0, offset = 0;
+    char *target;
+
+    for (int i = 0; i < count; i++) size += iov[i].iov_len;
+
+    PyEval_RestoreThread(file->thread);
+
+    /* Copy, so file can't keep memory which is reused for next rows */
+    chunk = PyBytes_FromStringAndSize(NULL, size);
+    if (chunk == NULL) goto exit;
+
+    target = PyBytes_AS_STRING(chunk);
+    for (int i = 0; i < count; i++) {
+        memcpy(target, iov[i].iov_base, iov[i].iov_len);
+        target += iov[i].iov_len;
+    }
+
+    /* Raw files may write less, like os.write does */
+    while (offset < size) {
+        Py_ssize_t length;
+
+        Py_XDECREF(piece);
+        if (offset == 0) {
+            Py_INCREF(chunk);
+            piece = chunk;
+        } else {
+            piece = PyBytes_FromStringAndSize(
+                PyBytes_AS_STRING(chunk) + offset, size - offset
+            );
+            if (piece == NULL) goto exit;
+        }
+
+        Py_XDECREF(written);
+        written = PyObject_CallOneArg(file->write, piece);
+        if (written == NULL || !PyLong_Check(written)) break;
+
+        length = PyLong_AsSsize_t(written);
+        if (length == -1 && PyErr_Occurred()) break;
+        if (length <= 0 || length > size - offset) {
+            PyErr_Format(
+                PyExc_OSError, "write() returned %zd of %zd bytes",
+                length, size - offset
+            );
+            Py_CLEAR(written);
+            break;
+        }
+        offset += length;
+    }
+
+exit:
+    Py_XDECREF(written);
+    Py_XDECREF(piece);
+    Py_XDECREF(chunk);
+
+    count = PyErr_Occurred() ? -1 : 0;
+    file->thread = PyEval_SaveThread();
+    return count;
+}
+
+/* Parse (file, angle, fgcolor, bgcolor, direct, compact), stream
+ * format into file descriptor or file object, return bytes written */
+static PyObject* czint_render_to(
+    CZINT *self, int id,
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames, int format
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+    czint_result result = {0};
+    czint_file_sink file_sink;
+    czint_sink sink;
+    PyObject *file = NULL;
+    const char *fgcolor_str = NULL;
+    const char *bgcolor_str = NULL;
+    long fd;
+
+    czint_render_options_init(&options);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, id), args, nargs, kwnames,
+        &file, &options.angle, &fgcolor_str, &bgcolor_str,
+        &options.direct, &options.compact
+    )) return NULL;
+
+    if (czint_render_options_parse(&options, fgcolor_str, bgcolor_str)) return NULL;
+
+    if (PyLong_Check(file)) {
+        int descriptor;
+
+        fd = PyLong_AsLong(file);
+        if (fd == -1 && PyErr_Occurred()) return NULL;
+        if (fd < 0 || fd > INT_MAX) {
+            PyErr_Format(PyExc_ValueError, "invalid file descriptor %ld", fd);
+            return NULL;
+        }
+
+        descriptor = (int) fd;
+        czint_sink_init(&sink, czint_sink_fd, &descriptor);
+
+        Py_BEGIN_ALLOW_THREADS
+        czint_stream_encoded(self, format, &options, &sink, &result);
+        Py_END_ALLOW_THREADS
+    } else {
+        file_sink.write = PyObject_GetAttrString(file, "write");
+        if (file_sink.write == NULL) {
+            if (!PyErr_ExceptionMatches(PyExc_AttributeError)) return NULL;
+            PyErr_Clear();
+            PyErr_Format(
+                PyExc_TypeError,
+                "file must be file descriptor or have write() method, not %.50s",
+                Py_TYPE(file)->tp_name
+            );
+            return NULL;
+        }
+
+        czint_sink_init(&sink, czint_file_sink_write, &file_sink);
+
+        file_sink.thread = PyEval_SaveThread();
+        czint_stream_encoded(self, format, &options, &sink, &result);
+        PyEval_RestoreThread(file_sink.thread);
+
+        Py_DECREF(file_sink.write);
+
+        /* Exception raised by write() */
+        if (sink.failed) return NULL;
+    }
+
+    if (sink.failed) {
+        errno = sink.error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    if (result.res > 0) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError,
+            result.res,
+            "Error while rendering: %s",
+            result.errtxt
+        );
+        return NULL;
+    }
+
+    return PyLong_FromSize_t(sink.size);
+}
+
+PyDoc_STRVAR(CZINT_render_bmp_to_docstring,
+    "Render bmp barcode like render_bmp, writing it to file "
+    "descriptor or file object (anything with write() method) while "
+    "rendering, instead of building whole image in memory. Rows are "
+    "written in chunks of about 64KiB, direct images are streamed "
+    "from one packed line per symbol row. Descriptors are written with "
+    "writev() without GIL and should be blocking, file objects get "
+    "bytes chunks. Returns number of bytes written, after a failed "
+    "write part of the image may already be in file.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_bmp_to(file: Union[int, BinaryIO], angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False) -> int"
+);
+static PyObject* CZINT_render_bmp_to(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    return czint_render_to(
+        self, CZINT_ARGS_RENDER_BMP_TO, args, nargs, kwnames, CZINT_FORMAT_BMP
+    );
+}
+
+PyDoc_STRVAR(CZINT_render_svg_to_docstring,
+    "Render svg barcode like render_svg, writing it to file "
+    "descriptor or file object in chunks of about 64KiB as elements "
+    "are serialized, see render_bmp_to.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_svg_to(file: Union[int, BinaryIO], angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', compact: bool = False) -> int"
+);
+static PyObject* CZINT_render_svg_to(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    return czint_render_to(
+        self, CZINT_ARGS_RENDER_SVG_TO, args, nargs, kwnames, CZINT_FORMAT_SVG
+    );
+}
+
+PyDoc_STRVAR(CZINT_render_png_docstring,
+    "Render 1bit palette png barcode. Rows are compressed with zlib "
+    "using given level (0..9, -1 for zlib default), strategy ('default', "
+    "'filtered', 'huffman', 'rle', 'fixed') and png row filter ('none', "
+    "'sub', 'up', 'average', 'paeth').\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_png(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False, level: int = 6, strategy: str = 'default', filter: str = 'none') -> bytes"
+);
+static PyObject* CZINT_render_png(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+
+    const char *fgcolor_str = NULL;
+    const char *bgcolor_str = NULL;
+    const char *strategy_str = NULL;
+    const char *filter_str = NULL;
+    int level;
+
+    czint_render_options_init(&options);
+    level = options.png.level;
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_RENDER_PNG), args, nargs, kwnames,
+        &options.angle, &fgcolor_str, &bgcolor_str, &options.direct,
+        &level, &strategy_str, &filter_str
+    )) return NULL;
+
+    if (czint_render_options_parse(&options, fgcolor_str, bgcolor_str)) return NULL;
+    if (czint_png_options_parse(
+        &options.png, level, strategy_str, filter_str
+    )) return NULL;
+
+    return czint_render_cached(self, CZINT_FORMAT_PNG, &options);
+}
+
+PyDoc_STRVAR(CZINT_render_zpl_docstring,
+    "Render barcode as ZPL ^GFA graphic field, packed straight from 1bit "
+    "bmp rows. compression is 'hex' (plain ASCII hex), 'acs' (ZPL "
+    "ASCII run length compression), 'b64' or 'z64' (zlib, base64 and "
+    "CRC). With label=True field is wrapped into ^XA^FO0,0 ... ^XZ, "
+    "otherwise it is ^GFA...^FS ready to follow ^FO.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_zpl(angle: int = 0, direct: bool = False, compression: str = 'z64', label: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_zpl(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+    const char *compression_str = NULL;
+
+    czint_render_options_init(&options);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_RENDER_ZPL), args, nargs, kwnames,
+        &options.angle, &options.direct, &compression_str, &options.zpl.label
+    )) return NULL;
+
+    if (compression_str != NULL) {
+        options.zpl.compression = czint_zpl_compression(compression_str);
+        if (options.zpl.compression < 0) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "Invalid compression: %s. Compression must be 'hex', "
+                "'acs', 'b64' or 'z64'",
+                compression_str
+            );
+            return NULL;
+        }
+    }
+
+    return czint_render_cached(self, CZINT_FORMAT_ZPL, &options);
+}
+
+PyDoc_STRVAR(CZINT_render_escpos_docstring,
+    "Render barcode as ESC/POS raster bit image (GS v 0) commands, "
+    "packed straight from 1bit bmp rows. Images taller than 2303 dots "
+    "are split into several commands.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render_escpos(angle: int = 0, direct: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_escpos(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+
+    czint_render_options_init(&options);
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_RENDER_ESCPOS), args, nargs, kwnames,
+        &options.angle, &options.direct
+    )) return NULL;
+
+    return czint_render_cached(self, CZINT_FORMAT_ESCPOS, &options);
+}
+
+PyDoc_STRVAR(CZINT_render_docstring,
+    "Render barcode into several formats at once. Data is encoded "
+    "only once, results are returned in order of formats.\n\n"
+    "    Zint('data', BARCODE_QRCODE).render(formats: Sequence[str] = ('bmp', 'svg'), angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False, compact: bool = False, level: int = 6, strategy: str = 'default', filter: str = 'none') -> Tuple[bytes, ...]"
+);
+static PyObject* CZINT_render(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    czint_render_options options;
+    czint_result *results = NULL;
+    int *formats = NULL;
+
+    PyObject *formats_arg = NULL;
+    PyObject *formats_seq = NULL;
+    PyObject *result = NULL;
+    Py_ssize_t count = 0;
+    Py_ssize_t i;
+
+    const char *fgcolor_str = NULL;
+    const char *bgcolor_str = NULL;
+    const char *strategy_str = NULL;
+    const char *filter_str = NULL;
+    int level;
+
+    czint_render_options_init(&options);
+    level = options.png.level;
+
+    if (czint_args_parse(
+        CZINT_ARGS(state, CZINT_ARGS_RENDER_FORMATS), args, nargs, kwnames,
+        &formats_arg, &options.angle, &fgcolor_str, &bgcolor_str,
+        &options.direct, &options.compact,
+        &level, &strategy_str, &filter_str
+    )) return NULL;
+
+    if (czint_render_options_parse(&options, fgcolor_str, bgcolor_str)) return NULL;
+    if (czint_png_options_parse(
+        &options.png, level, strategy_str, filter_str
+    )) return NULL;
+
+    if (formats_arg == NULL) {
+        formats_seq = Py_BuildValue("(ss)", "bmp", "svg");
+    } else {
+        formats_seq = PySequence_Tuple(formats_arg);
+    }
+    if (formats_seq == NULL) return NULL;
+
+    count = PyTuple_GET_SIZE(formats_seq);
+    formats = calloc(count ? count : 1, sizeof(int));
+    results = calloc(count ? count : 1, sizeof(czint_result));
+    if (formats == NULL || results == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    for (i = 0; i < count; i++) {
+        const char *format = PyUnicode_AsUTF8(PyTuple_GET_ITEM(formats_seq, i));
+        if (format == NULL) goto exit;
+        if ((formats[i] = parse_format(format)) < 0) goto exit;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < count; i++) {
+        czint_render_encoded(self, formats[i], &options, &results[i]);
+    }
+    Py_END_ALLOW_THREADS
+
+    result = PyTuple_New(count);
+    if (result == NULL) goto exit;
+
+    for (i = 0; i < count; i++) {
+        PyObject *value = czint_result_bytes(&results[i]);
+        if (value == NULL) {
+            Py_CLEAR(result);
+            goto exit;
+        }
+        PyTuple_SET_ITEM(result, i, value);
+    }
+
+exit:
+    if (results != NULL) {
+        for (i = 0; i < count; i++) free(results[i].data);
+        free(results);
+    }
+    free(formats);
+    Py_DECREF(formats_seq);
+    return result;
+}
+
+
+static PyMemberDef
+CZINT_members[] = {
+    {
+        "data", T_OBJECT,
+        offsetof(CZINT, data),
+        READONLY, "Symbol payload"
+    },
+    {
+        "symbology", T_INT,
+        offsetof(CZINT, symbology),
+        READONLY, "Code of symbol to use"
+    },
+    {
+        "symbology_name", T_STRING,
+        offsetof(CZINT, human_symbology),
+        READONLY, "Name of symbol to use"
+    },
+    {
+        "height", T_INT,
+        offsetof(CZINT, height),
+        READONLY, "Symbol height"
+    },
+    {
+        "dot_size", T_FLOAT,
+        offsetof(CZINT, dot_size),
+        READONLY, "Size of dots used in dotty mode"
+    },
+    {
+        "scale", T_FLOAT,
+        offsetof(CZINT, scale),
+        READONLY, "Scale factor for adjusting size of image"
+    },
+    {
+        "border_width", T_INT,
+        offsetof(CZINT, border_width),
+        READONLY, "Border width"
+    },
+    {
+        "eci", T_INT,
+        offsetof(CZINT, eci),
+        READONLY, "Extended Channel Interpretation mode (3 default)"
+    },
+    {
+        "fontsize", T_INT,
+        offsetof(CZINT, fontsize),
+        READONLY, "fontsize"
+    },
+    {
+        "show_text", T_BOOL,
+        offsetof(CZINT, show_hrt),
+        READONLY, "Set to False to hide text"
+    },
+    {
+        "option_1", T_INT,
+        offsetof(CZINT, option_1),
+        READONLY, "Symbol specific option 1"
+    },
+    {
+        "option_2", T_INT,
+        offsetof(CZINT, option_2),
+        READONLY, "Symbol specific option 2"
+    },
+    {
+        "option_3", T_INT,
+        offsetof(CZINT, option_3),
+        READONLY, "Symbol specific option 3"
+    },
+    {
+        "primary", T_STRING,
+        offsetof(CZINT, primary),
+        READONLY, "Primary message data for more complex symbols"
+    },
+    {
+        "text", T_STRING,
+        offsetof(CZINT, text),
+        READONLY, "Human readable text, which usually consists of input data plus one more check digit"
+    },
+    {
+        "whitespace_width", T_INT,
+        offsetof(CZINT, whitespace_width),
+        READONLY, "Whtespace width"
+    },
+    {
+        "border_width", T_INT,
+        offsetof(CZINT, border_width),
+        READONLY, "Border width"
+    },
+
+    {NULL}  /* Sentinel */
+};
+
+/* asyncio renders. Jobs run on native pool, finished ones are queued on
+ * completion queue of their event loop. Only the worker which finds
+ * queue idle wakes the loop, by writing a byte to a pipe watched with
+ * loop.add_reader, so a burst of renders finishing together wakes the
+ * loop once. Workers never run Python code, which keeps them out of
+ * interpreter lifetime. */
+
+typedef struct czint_async_job {
+    struct czint_async_job *next;
+    struct CZINTCompletions *queue;
+    CZINT *zint;
+    PyObject *future;
+    int format;
+    czint_render_options options;
+    czint_result result;
+} czint_async_job;
+
+typedef struct CZINTCompletions {
+    PyObject_HEAD
+    int rfd;
+    int wfd;
+    /* Used from the loop thread only */
+    Py_ssize_t inflight;
+    PyObject *loop;
+    /* Fields below are shared with workers and guarded by lock */
+    PyThread_type_lock lock;
+    czint_async_job *head;
+    czint_async_job *tail;
+    int scheduled;
+} CZINTCompletions;
+
+static void
+CZINTCompletions_dealloc(CZINTCompletions *self) {
+    if (self->lock != NULL) PyThread_free_lock(self->lock);
+    if (self->rfd >= 0) close(self->rfd);
+    if (self->wfd >= 0) close(self->wfd);
+    Py_XDECREF(self->loop);
+
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
+
+/* Complete futures of finished jobs, runs in event loop thread */
+static PyObject* CZINTCompletions_drain(
+    CZINTCompletions *self, PyObject *unused
+) {
+    czint_async_job *job, *next;
+    PyObject *value, *res, *loop;
+    char wakeups[64];
+
+    /* Empty pipe before taking jobs, a wakeup written after this point
+     * belongs to a job this drain may not see */
+    while (read(self->rfd, wakeups, sizeof(wakeups)) > 0);
+
+    PyThread_acquire_lock(self->lock, WAIT_LOCK);
+    job = self->head;
+    self->head = self->tail = NULL;
+    self->scheduled = 0;
+    PyThread_release_lock(self->lock);
+
+    for (; job != NULL; job = next) {
+        next = job->next;
+
+        res = PyObject_CallMethod(job->future, "cancelled", NULL);
+        if (res != NULL && res == Py_False) {
+            if (job->result.res > 0) {
+                value = PyErr_CodeObject(
+                    PyExc_RuntimeError, job->result.res, job->result.errtxt
+                );
+                Py_XDECREF(res);
+                res = value == NULL ? NULL : PyObject_CallMethod(
+                    job->future, "set_exception", "O", value
+                );
             } else {
-                len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"#%s\" \n/>", circle->x, circle->y, circle->diameter / 2.0, symbol->fgcolour);
+                value = czint_result_bytes(&job->result);
+                Py_XDECREF(res);
+                res = value == NULL ? NULL : PyObject_CallMethod(
+                    job->future, "set_result", "O", value
+                );
+            }
+            Py_XDECREF(value);
+        }
+        if (res == NULL) PyErr_WriteUnraisable(job->future);
+        Py_XDECREF(res);
+
+        free(job->result.data);
+        Py_DECREF(job->zint);
+        Py_DECREF(job->future);
+        free(job);
+
+        /* Loop is referenced only while jobs are in flight, so idle
+         * queue kept in weak mapping does not keep its loop alive */
+        if (--self->inflight == 0) {
+            loop = self->loop;
+            self->loop = NULL;
+
+            res = PyObject_CallMethod(loop, "remove_reader", "i", self->rfd);
+            if (res == NULL) PyErr_WriteUnraisable(loop);
+            Py_XDECREF(res);
+            Py_DECREF(loop);
+        }
+        Py_DECREF(self);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef CZINTCompletions_methods[] = {
+    {"_drain", (PyCFunction) CZINTCompletions_drain, METH_NOARGS, NULL},
+    {NULL}  /* Sentinel */
+};
+
+static PyType_Slot CZINTCompletions_slots[] = {
+    {Py_tp_dealloc, CZINTCompletions_dealloc},
+    {Py_tp_methods, CZINTCompletions_methods},
+    {0, NULL}
+};
+
+static PyType_Spec CZINTCompletions_spec = {
+    .name = "pyzint.zint._Completions",
+    .basicsize = sizeof(CZINTCompletions),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINTCompletions_slots,
+};
+
+/* Pipe is non blocking, when it is full the loop is woken anyway */
+static void czint_async_wake(int fd) {
+    ssize_t written = write(fd, "", 1);
+    (void) written;
+}
+
+/* Worker side, called without GIL */
+static void czint_async_run(void *arg) {
+    czint_async_job *job = arg;
+    CZINTCompletions *queue = job->queue;
+
+    czint_render_encoded(job->zint, job->format, &job->options, &job->result);
+
+    PyThread_acquire_lock(queue->lock, WAIT_LOCK);
+    job->next = NULL;
+    if (queue->tail == NULL) {
+        queue->head = job;
+    } else {
+        queue->tail->next = job;
+    }
+    queue->tail = job;
+    if (!queue->scheduled) {
+        queue->scheduled = 1;
+        czint_async_wake(queue->wfd);
+    }
+    PyThread_release_lock(queue->lock);
+}
+
+/* Completion queue of loop, cached in weak mapping */
+static CZINTCompletions *czint_async_queue(
+    czint_state *state, PyObject *loop
+) {
+    CZINTCompletions *queue;
+    int fds[2];
+
+    queue = (CZINTCompletions *) PyObject_GetItem(state->async_queues, loop);
+    if (queue != NULL) return queue;
+    if (!PyErr_ExceptionMatches(PyExc_KeyError)) return NULL;
+    PyErr_Clear();
+
+    queue = PyObject_New(CZINTCompletions, state->CompletionsType);
+    if (queue == NULL) return NULL;
+
+    queue->rfd = queue->wfd = -1;
+    queue->inflight = 0;
+    queue->loop = NULL;
+    queue->lock = PyThread_allocate_lock();
+    queue->head = queue->tail = NULL;
+    queue->scheduled = 0;
+
+    if (queue->lock == NULL) {
+        Py_DECREF(queue);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    if (pipe(fds) < 0) {
+        Py_DECREF(queue);
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    }
+
+    queue->rfd = fds[0];
+    queue->wfd = fds[1];
+
+    if (
+        fcntl(fds[0], F_SETFL, O_NONBLOCK) < 0 ||
+        fcntl(fds[1], F_SETFL, O_NONBLOCK) < 0 ||
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC) < 0 ||
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC) < 0
+    ) {
+        Py_DECREF(queue);
+        PyErr_SetFromErrno(PyExc_OSError);
+        return NULL;
+    }
+
+    /* Loops which can not be weakly referenced just get queue per call */
+    if (PyObject_SetItem(
+        state->async_queues, loop, (PyObject *) queue
+    )) PyErr_Clear();
+
+    return queue;
+}
+
+static int czint_async_init(czint_state *state) {
+    PyObject *module, *get_running_loop, *queues;
+
+    if (state->async_queues != NULL) return 0;
+
+    module = PyImport_ImportModule("asyncio");
+    if (module == NULL) return -1;
+    get_running_loop = PyObject_GetAttrString(module, "get_running_loop");
+    Py_DECREF(module);
+    if (get_running_loop == NULL) return -1;
+
+    module = PyImport_ImportModule("weakref");
+    if (module == NULL) {
+        Py_DECREF(get_running_loop);
+        return -1;
+    }
+    queues = PyObject_CallMethod(module, "WeakKeyDictionary", NULL);
+    Py_DECREF(module);
+    if (queues == NULL) {
+        Py_DECREF(get_running_loop);
+        return -1;
+    }
+
+    Py_XSETREF(state->get_running_loop, get_running_loop);
+    Py_XSETREF(state->async_queues, queues);
+    return 0;
+}
+
+/* Queue render of self on native pool, returns future of current loop */
+static PyObject* czint_async_submit(
+    CZINT *self, int format, const czint_render_options *options
+) {
+    czint_state *state = czint_get_state((PyObject *) self);
+    PyObject *loop = NULL, *future = NULL, *drain, *res;
+    CZINTCompletions *queue = NULL;
+    czint_async_job *job;
+
+    if (czint_async_init(state)) return NULL;
+
+    loop = PyObject_CallFunctionObjArgs(state->get_running_loop, NULL);
+    if (loop == NULL) return NULL;
+
+    queue = czint_async_queue(state, loop);
+    if (queue == NULL) goto error;
+
+    future = PyObject_CallMethod(loop, "create_future", NULL);
+    if (future == NULL) goto error;
+
+    /* First job in flight starts watching the pipe, drain of the last
+     * one stops */
+    if (queue->inflight == 0) {
+        drain = PyObject_GetAttrString((PyObject *) queue, "_drain");
+        if (drain == NULL) goto error;
+        res = PyObject_CallMethod(loop, "add_reader", "iO", queue->rfd, drain);
+        Py_DECREF(drain);
+        if (res == NULL) goto error;
+        Py_DECREF(res);
+
+        Py_INCREF(loop);
+        Py_XSETREF(queue->loop, loop);
+    }
+
+    job = calloc(1, sizeof(czint_async_job));
+    if (job == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    Py_INCREF(self);
+    Py_INCREF(future);
+    job->zint = self;
+    job->future = future;
+    job->queue = queue;
+    job->format = format;
+    job->options = *options;
+
+    if (czint_pool_submit(
+        czint_async_run, job, czint_pool_default_threads()
+    )) {
+        Py_DECREF(self);
+        Py_DECREF(future);
+        free(job);
+        PyErr_SetString(PyExc_RuntimeError, "Can not start worker thread");
+        goto error;
+    }
+
+    /* Job owns a queue reference, dropped by drain */
+    queue->inflight++;
+
+    Py_DECREF(loop);
+    return future;
+
+error:
+    if (queue != NULL && queue->inflight == 0 && queue->loop != NULL) {
+        PyObject *type, *value, *traceback;
+
+        PyErr_Fetch(&type, &value, &traceback);
+        res = PyObject_CallMethod(loop, "remove_reader", "i", queue->rfd);
+        if (res == NULL) PyErr_WriteUnraisable(loop);
+        Py_XDECREF(res);
+        Py_CLEAR(queue->loop);
+        PyErr_Restore(type, value, traceback);
+    }
+    Py_XDECREF(queue);
+    Py_XDECREF(future);
+    Py_XDECREF(loop);
+    return NULL;
+}
+
+PyDoc_STRVAR(CZINT_render_bmp_async_docstring,
+    "Render bmp barcode on native worker pool, returns asyncio future "
+    "of running event loop, RuntimeError is raised without one. "
+    "Arguments are the same as render_bmp.\n\n"
+    "    await Zint('data', BARCODE_QRCODE).render_bmp_async(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', direct: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_bmp_async(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_render_options options;
+
+    if (czint_render_parse(
+        self, CZINT_ARGS_RENDER_BMP_ASYNC, args, nargs, kwnames, &options
+    )) return NULL;
+    return czint_async_submit(self, CZINT_FORMAT_BMP, &options);
+}
+
+PyDoc_STRVAR(CZINT_render_svg_async_docstring,
+    "Render svg barcode on native worker pool, returns asyncio future "
+    "of running event loop, RuntimeError is raised without one. "
+    "Arguments are the same as render_svg.\n\n"
+    "    await Zint('data', BARCODE_QRCODE).render_svg_async(angle: int = 0, fgcolor: str = '#000000', bgcolor: str = '#FFFFFF', compact: bool = False) -> bytes"
+);
+static PyObject* CZINT_render_svg_async(
+    CZINT *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames
+) {
+    czint_render_options options;
+
+    if (czint_render_parse(
+        self, CZINT_ARGS_RENDER_SVG_ASYNC, args, nargs, kwnames, &options
+    )) return NULL;
+    return czint_async_submit(self, CZINT_FORMAT_SVG, &options);
+}
+
+
+static PyMethodDef CZINT_methods[] = {
+    {
+        "render_bmp",
+        (PyCFunction) CZINT_render_bmp, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_bmp_docstring
+    },
+    {
+        "render_bmp_buffer",
+        (PyCFunction) CZINT_render_bmp_buffer, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_bmp_buffer_docstring
+    },
+    {
+        "render_matrix",
+        (PyCFunction) CZINT_render_matrix, METH_NOARGS,
+        CZINT_render_matrix_docstring
+    },
+    {
+        "render_bmp_to",
+        (PyCFunction) CZINT_render_bmp_to, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_bmp_to_docstring
+    },
+    {
+        "render_svg_to",
+        (PyCFunction) CZINT_render_svg_to, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_svg_to_docstring
+    },
+    {
+        "render_bmp_into",
+        (PyCFunction) CZINT_render_bmp_into, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_bmp_into_docstring
+    },
+    {
+        "bmp_size",
+        (PyCFunction) CZINT_bmp_size, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_bmp_size_docstring
+    },
+    {
+        "measure",
+        (PyCFunction) CZINT_measure, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_measure_docstring
+    },
+    {
+        "render_png",
+        (PyCFunction) CZINT_render_png, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_png_docstring
+    },
+    {
+        "render_zpl",
+        (PyCFunction) CZINT_render_zpl, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_zpl_docstring
+    },
+    {
+        "render_escpos",
+        (PyCFunction) CZINT_render_escpos, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_escpos_docstring
+    },
+    {
+        "render_bmp_async",
+        (PyCFunction) CZINT_render_bmp_async, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_bmp_async_docstring
+    },
+    {
+        "render_svg_async",
+        (PyCFunction) CZINT_render_svg_async, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_svg_async_docstring
+    },
+    {
+        "render_svg",
+        (PyCFunction) CZINT_render_svg, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_svg_docstring
+    },
+    {
+        "render",
+        (PyCFunction) CZINT_render, METH_FASTCALL | METH_KEYWORDS,
+        CZINT_render_docstring
+    },
+    {NULL}  /* Sentinel */
+};
+
+
+
+static PyType_Slot CZINT_slots[] = {
+    {Py_tp_doc, "zint - python bindings for zint"},
+    {Py_tp_new, CZINT_new},
+    {Py_tp_init, CZINT_init},
+    {Py_tp_dealloc, CZINT_dealloc},
+    {Py_tp_methods, CZINT_methods},
+    {Py_tp_members, CZINT_members},
+    {Py_tp_repr, CZINT_repr},
+    {0, NULL}
+};
+
+static PyType_Spec CZINT_spec = {
+    .name = "pyzint.zint.Zint",
+    .basicsize = sizeof(CZINT),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINT_slots,
+};
+
+
+typedef struct {
+    const char *data;
+    Py_ssize_t length;
+    czint_result result;
+    /* Render cache key, entry on hit */
+    unsigned char *key;
+    size_t key_size;
+    uint64_t hash;
+    czint_cache_entry *entry;
+    int cached;         /* served by a render cache, nothing to share */
+} czint_batch_item;
+
+typedef struct {
+    CZINT *options;         /* template Zint, owned */
+    int format;
+    int threads;
+    czint_render_options render;
+    czint_batch_item *items;
+    czint_cache *cache;     /* NULL when render cache is off */
+    czint_shm *shm;         /* NULL without shared render cache */
+    CZINTSharedCache *shared;
+} czint_batch;
+
+/* Render one batch item on a pool thread. Called without GIL. */
+static void czint_batch_render(void *ctx, size_t index) {
+    czint_batch *batch = ctx;
+    czint_batch_item *item = &batch->items[index];
+    struct zint_symbol *symbol;
+    int res;
+
+    if (batch->cache != NULL || batch->shm != NULL) {
+        item->key = czint_cache_key(
+            batch->options, batch->format, &batch->render,
+            item->data, item->length, &item->key_size
+        );
+        if (item->key != NULL) {
+            item->hash = czint_cache_hash(item->key, item->key_size);
+        }
+        if (item->key != NULL && batch->cache != NULL) {
+            item->entry = czint_cache_get(
+                batch->cache, item->key, item->key_size, item->hash
+            );
+            item->cached = item->entry != NULL;
+            if (item->cached) return;
+        }
+        if (item->key != NULL && batch->shm != NULL) {
+            item->result.symbology = batch->options->symbology;
+            item->cached = czint_shm_get(
+                batch->shm, item->key, item->key_size, item->hash,
+                &item->result.data, &item->result.size
+            ) > 0;
+            if (item->cached) return;
+        }
+    }
+
+    symbol = czint_symbol_acquire();
+
+    if (symbol == NULL) {
+        czint_result_error(&item->result, "Symbol initialization failed");
+        return;
+    }
+
+    czint_symbol_setup(batch->options, symbol);
+
+    res = czint_encode_symbol(symbol, item->data, item->length);
+
+    if (res == 0) {
+        czint_render_symbol(symbol, batch->format, &batch->render, &item->result);
+    } else {
+        czint_result_set(&item->result, symbol, res);
+    }
+
+    czint_symbol_release(symbol);
+}
+
+/* Split keyword arguments named in kwlist from the Zint(...) options */
+static int czint_batch_split_kwds(
+    PyObject *kwds, char **kwlist, PyObject **own, PyObject **options
+) {
+    PyObject *key, *value;
+    Py_ssize_t pos = 0;
+
+    *own = PyDict_New();
+    *options = PyDict_New();
+    if (*own == NULL || *options == NULL) return -1;
+    if (kwds == NULL) return 0;
+
+    while (PyDict_Next(kwds, &pos, &key, &value)) {
+        int is_own = 0;
+        for (char **name = kwlist; *name != NULL; name++) {
+            if (PyUnicode_CompareWithASCIIString(key, *name) == 0) {
+                is_own = 1;
+                break;
+            }
+        }
+        if (PyDict_SetItem(is_own ? *own : *options, key, value)) return -1;
+    }
+    return 0;
+}
+
+/* Check format, threads, colors and png options of batch, whose render
+ * options were parsed already */
+static int czint_batch_parse(
+    czint_batch *batch, const char *format_str, int threads,
+    const char *fgcolor_str, const char *bgcolor_str,
+    int level, const char *strategy_str, const char *filter_str
+) {
+    if ((batch->format = parse_format(format_str)) < 0) return -1;
+
+    if (threads < 0) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "threads must be positive or zero got %d",
+            threads
+        );
+        return -1;
+    }
+    batch->threads = threads;
+
+    if (czint_render_options_parse(
+        &batch->render, fgcolor_str, bgcolor_str
+    )) return -1;
+
+    if (czint_png_options_parse(
+        &batch->render.png, level, strategy_str, filter_str
+    )) return -1;
+
+    return 0;
+}
+
+/* Build template Zint of batch payloads from kind and options */
+static int czint_batch_template(
+    czint_batch *batch, PyObject *module, PyObject *kind, PyObject *options
+) {
+    czint_state *state = PyModule_GetState(module);
+    PyObject *template_args, *template;
+
+    /* Options are validated exactly like Zint(...) does */
+    template_args = Py_BuildValue("(y#O)", "", (Py_ssize_t) 0, kind);
+    if (template_args == NULL) return -1;
+
+    template = PyObject_Call(
+        (PyObject *) state->ZintType, template_args, options
+    );
+    Py_DECREF(template_args);
+    if (template == NULL) return -1;
+
+    batch->options = (CZINT *) template;
+    return 0;
+}
+
+/* czint_batch_parse and czint_batch_template, then attach render
+ * caches. Batch must be zeroed before, czint_batch_release frees it
+ * either way. */
+static int czint_batch_setup(
+    czint_batch *batch, PyObject *module, PyObject *kind, PyObject *options,
+    const char *format_str, int threads,
+    const char *fgcolor_str, const char *bgcolor_str,
+    int level, const char *strategy_str, const char *filter_str
+) {
+    czint_state *state = PyModule_GetState(module);
+
+    if (czint_batch_parse(
+        batch, format_str, threads,
+        fgcolor_str, bgcolor_str, level, strategy_str, filter_str
+    )) return -1;
+
+    if (czint_batch_template(batch, module, kind, options)) return -1;
+
+    if (czint_cache_enabled(&state->cache)) batch->cache = &state->cache;
+    batch->shared = czint_shared_cache_get(state);
+    if (batch->shared != NULL) batch->shm = &batch->shared->shm;
+    return 0;
+}
+
+/* Free native results of first count items and zero them for reuse */
+static void czint_batch_clear(czint_batch *batch, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        czint_batch_item *item = &batch->items[i];
+
+        if (item->entry != NULL) czint_cache_release(batch->cache, item->entry);
+        free(item->key);
+        free(item->result.data);
+        memset(item, 0, sizeof(czint_batch_item));
+    }
+}
+
+static void czint_batch_release(czint_batch *batch) {
+    free(batch->items);
+    batch->items = NULL;
+    Py_CLEAR(batch->options);
+    Py_CLEAR(batch->shared);
+}
+
+/* Run fn(ctx, i) for first count items on the pool without GIL and
+ * collect them into list of bytes and RuntimeError instances, keeping
+ * fresh renders in render caches. Items are cleared afterwards. */
+static PyObject *czint_batch_run(
+    czint_batch *batch, size_t count, czint_pool_item fn, void *ctx
+) {
+    PyObject *result;
+    size_t i;
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_pool_map(count, batch->threads, fn, ctx);
+    Py_END_ALLOW_THREADS
+
+    result = PyList_New(count);
+    if (result == NULL) goto exit;
+
+    for (i = 0; i < count; i++) {
+        czint_batch_item *batch_item = &batch->items[i];
+        PyObject *value;
+
+        if (batch_item->entry != NULL) {
+            value = batch_item->entry->value;
+            Py_INCREF(value);
+            czint_cache_release(batch->cache, batch_item->entry);
+            batch_item->entry = NULL;
+        } else if (batch_item->result.res > 0) {
+            value = PyErr_CodeObject(
+                PyExc_RuntimeError,
+                batch_item->result.res, batch_item->result.errtxt
+            );
+        } else {
+            value = czint_result_bytes(&batch_item->result);
+            if (
+                value != NULL && batch_item->key != NULL && batch->cache != NULL
+            ) {
+                czint_cache_store(
+                    batch->cache, batch_item->key, batch_item->key_size,
+                    batch_item->hash, value
+                );
+            }
+        }
+
+        if (value == NULL) {
+            Py_CLEAR(result);
+            goto exit;
+        }
+
+        PyList_SET_ITEM(result, i, value);
+    }
+
+    /* Share fresh renders, list is not visible to anyone else yet */
+    if (batch->shm != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        for (i = 0; i < count; i++) {
+            czint_batch_item *batch_item = &batch->items[i];
+            PyObject *value = PyList_GET_ITEM(result, i);
+
+            if (
+                batch_item->key == NULL || batch_item->cached ||
+                !PyBytes_Check(value)
+            ) continue;
+
+            czint_shm_put(
+                batch->shm, batch_item->key, batch_item->key_size,
+                batch_item->hash, PyBytes_AS_STRING(value),
+                PyBytes_GET_SIZE(value)
+            );
+        }
+        Py_END_ALLOW_THREADS
+    }
+
+exit:
+    czint_batch_clear(batch, count);
+    return result;
+}
+
+PyDoc_STRVAR(CZINT_render_many_docstring,
+    "Render many payloads of the same kind on a native thread pool. "
+    "GIL is released once for the whole batch. Items which failed "
+    "to render are returned as RuntimeError(code, message) instances "
+    "instead of raising. Format is 'bmp', 'svg', 'png', 'zpl' or "
+    "'escpos', printer formats use render_zpl() defaults.\n\n"
+    "    render_many(BARCODE_QRCODE, ['a', 'b'], format: str = 'bmp', threads: int = 0, angle: int = 0, fgcolor: str = None, bgcolor: str = None, direct: bool = False, compact: bool = False, level: int = 6, strategy: str = None, filter: str = None, **options) -> List[Union[bytes, RuntimeError]]"
+);
+static PyObject* CZINT_render_many(
+    PyObject *module, PyObject *args, PyObject *kwds
+) {
+    static char *kwlist[] = {
+        "kind", "payloads", "format", "threads",
+        "angle", "fgcolor", "bgcolor", "direct", "compact",
+        "level", "strategy", "filter", NULL
+    };
+
+    PyObject *kind = NULL;
+    PyObject *payloads = NULL;
+    char *format_str = "bmp";
+    int threads = 0;
+    char *fgcolor_str = NULL;
+    char *bgcolor_str = NULL;
+    char *strategy_str = NULL;
+    char *filter_str = NULL;
+    int level;
+
+    PyObject *own_kwds = NULL;
+    PyObject *options = NULL;
+    PyObject *items = NULL;
+    PyObject *result = NULL;
+
+    czint_batch batch;
+    Py_ssize_t count = 0;
+    Py_ssize_t i;
+
+    memset(&batch, 0, sizeof(batch));
+    czint_render_options_init(&batch.render);
+    level = batch.render.png.level;
+
+    if (czint_batch_split_kwds(kwds, kwlist, &own_kwds, &options)) goto exit;
+
+    if (!PyArg_ParseTupleAndKeywords(
+        args, own_kwds, "OO|siizzppizz", kwlist,
+        &kind, &payloads, &format_str, &threads,
+        &batch.render.angle, &fgcolor_str, &bgcolor_str,
+        &batch.render.direct, &batch.render.compact,
+        &level, &strategy_str, &filter_str
+    )) goto exit;
+
+    if (czint_batch_setup(
+        &batch, module, kind, options, format_str, threads,
+        fgcolor_str, bgcolor_str, level, strategy_str, filter_str
+    )) goto exit;
+
+    /* Own the payloads, so a list can't be mutated under our feet */
+    items = PySequence_Tuple(payloads);
+    if (items == NULL) goto exit;
+
+    count = PyTuple_GET_SIZE(items);
+    batch.items = calloc(count ? count : 1, sizeof(czint_batch_item));
+    if (batch.items == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    for (i = 0; i < count; i++) {
+        PyObject *item = PyTuple_GET_ITEM(items, i);
+        czint_batch_item *batch_item = &batch.items[i];
+
+        if (PyBytes_Check(item)) {
+            if (PyBytes_AsStringAndSize(
+                item, (char **) &batch_item->data, &batch_item->length
+            ) == -1) goto exit;
+        } else if (PyUnicode_Check(item)) {
+            batch_item->data = PyUnicode_AsUTF8AndSize(item, &batch_item->length);
+            if (batch_item->data == NULL) goto exit;
+        } else {
+            PyErr_Format(
+                PyExc_ValueError,
+                "payload %zd must be str or bytes, got %s",
+                i, Py_TYPE(item)->tp_name
+            );
+            goto exit;
+        }
+    }
+
+    result = czint_batch_run(&batch, count, czint_batch_render, &batch);
+
+exit:
+    czint_batch_release(&batch);
+    Py_XDECREF(items);
+    Py_XDECREF(options);
+    Py_XDECREF(own_kwds);
+    return result;
+}
+
+
+#define CZINT_RANGE_CHUNK 256
+#define CZINT_RANGE_WIDTH_MAX 64
+
+/* Batch of payloads template formats from start + index * step. Item i
+ * of batch is range index first + i, formatted into its arena slot. */
+typedef struct {
+    czint_batch batch;
+    char *text;             /* prefix followed by suffix */
+    size_t prefix_length;
+    size_t suffix_length;
+    int zero;
+    int width;
+    long long start;
+    long long step;
+    size_t count;
+    size_t chunk;
+    size_t first;
+    char *arena;
+    size_t stride;
+} czint_range;
+
+/* Split template around its only %d conversion, which may have a 0
+ * flag and width, %% is a literal % */
+static int czint_range_template(
+    czint_range *range, const char *template, Py_ssize_t length
+) {
+    char *target;
+    int found = 0;
+
+    range->text = malloc(length ? length : 1);
+    if (range->text == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    target = range->text;
+
+    for (Py_ssize_t i = 0; i < length; i++) {
+        if (template[i] != '%') {
+            *target++ = template[i];
+            continue;
+        }
+
+        if (++i < length && template[i] == '%') {
+            *target++ = '%';
+            continue;
+        }
+
+        if (found) {
+            PyErr_SetString(
+                PyExc_ValueError, "template must have exactly one %d"
+            );
+            return -1;
+        }
+        found = 1;
+
+        if (i < length && template[i] == '0') {
+            range->zero = 1;
+            i++;
+        }
+        for (; i < length && template[i] >= '0' && template[i] <= '9'; i++) {
+            range->width = range->width * 10 + (template[i] - '0');
+            if (range->width > CZINT_RANGE_WIDTH_MAX) {
+                PyErr_Format(
+                    PyExc_ValueError, "template width must be at most %d",
+                    CZINT_RANGE_WIDTH_MAX
+                );
+                return -1;
+            }
+        }
+        if (i >= length || template[i] != 'd') {
+            PyErr_SetString(
+                PyExc_ValueError,
+                "template conversion must be %d with optional 0 and width"
+            );
+            return -1;
+        }
+
+        range->prefix_length = target - range->text;
+    }
+
+    if (!found) {
+        PyErr_SetString(PyExc_ValueError, "template must have exactly one %d");
+        return -1;
+    }
+
+    range->suffix_length = target - range->text - range->prefix_length;
+    return 0;
+}
+
+/* Number of values range(start, stop, step) yields, without overflow */
+static int czint_range_count(
+    long long start, long long stop, long long step, size_t *count
+) {
+    unsigned long long distance, steps;
+
+    if (step == 0) {
+        PyErr_SetString(PyExc_ValueError, "step must not be zero");
+        return -1;
+    }
+
+    if ((step > 0 && start >= stop) || (step < 0 && start <= stop)) {
+        *count = 0;
+        return 0;
+    }
+
+    if (step > 0) {
+        distance = (unsigned long long) stop - (unsigned long long) start;
+        steps = (unsigned long long) step;
+    } else {
+        distance = (unsigned long long) start - (unsigned long long) stop;
+        steps = -(unsigned long long) step;
+    }
+
+    distance = (distance - 1) / steps + 1;
+    if (distance > PY_SSIZE_T_MAX / sizeof(czint_batch_item)) {
+        PyErr_SetString(PyExc_OverflowError, "range is too long");
+        return -1;
+    }
+
+    *count = (size_t) distance;
+    return 0;
+}
+
+/* Allocate items and payload arena for chunk */
+static int czint_range_alloc(czint_range *range) {
+    size_t digits = range->width > 20 ? range->width : 20;
+
+    range->stride = range->prefix_length + digits + range->suffix_length + 1;
+    range->batch.items = calloc(range->chunk, sizeof(czint_batch_item));
+    range->arena = malloc(range->chunk * range->stride);
+    if (range->batch.items == NULL || range->arena == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static void czint_range_release(czint_range *range) {
+    czint_batch_release(&range->batch);
+    free(range->text);
+    free(range->arena);
+    range->text = range->arena = NULL;
+}
+
+/* Format payload of batch item index and render it. Called without
+ * GIL on pool threads. */
+static void czint_range_render(void *ctx, size_t index) {
+    czint_range *range = ctx;
+    czint_batch_item *item = &range->batch.items[index];
+    char *target = range->arena + index * range->stride;
+    unsigned long long offset = range->first + index;
+    long long value;
+    int digits;
+
+    /* Wraps like the two's complement sum, which is within range */
+    value = (long long) (
+        (unsigned long long) range->start +
+        offset * (unsigned long long) range->step
+    );
+
+    memcpy(target, range->text, range->prefix_length);
+    digits = snprintf(
+        target + range->prefix_length,
+        range->stride - range->prefix_length,
+        range->zero ? "%0*lld" : "%*lld", range->width, value
+    );
+    memcpy(
+        target + range->prefix_length + digits,
+        range->text + range->prefix_length, range->suffix_length
+    );
+
+    item->data = target;
+    item->length = range->prefix_length + digits + range->suffix_length;
+    czint_batch_render(&range->batch, index);
+}
+
+/* List of results for range indexes [first, first + count) */
+static PyObject *czint_range_run(czint_range *range, size_t first, size_t count) {
+    range->first = first;
+    return czint_batch_run(&range->batch, count, czint_range_render, range);
+}
+
+typedef struct {
+    PyObject_HEAD
+    PyThread_type_lock lock;
+    czint_range range;
+    size_t next;            /* range index of next chunk */
+    PyObject *results;      /* current chunk */
+    Py_ssize_t position;
+} CZINTRangeRenders;
+
+static void
+CZINTRangeRenders_dealloc(CZINTRangeRenders *self) {
+    czint_range_release(&self->range);
+    Py_XDECREF(self->results);
+    if (self->lock != NULL) PyThread_free_lock(self->lock);
+
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *) self);
+    Py_DECREF(type);
+}
+
+static PyObject* CZINTRangeRenders_next(CZINTRangeRenders *self) {
+    PyObject *value = NULL;
+
+    /* Chunks render without GIL, a second caller would race the first */
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        PyErr_SetString(PyExc_ValueError, "render_range iterator already executing");
+        return NULL;
+    }
+
+    if (self->results == NULL || self->position == PyList_GET_SIZE(self->results)) {
+        size_t count = self->range.count - self->next;
+
+        Py_CLEAR(self->results);
+        if (count > self->range.chunk) count = self->range.chunk;
+
+        if (count > 0) {
+            self->results = czint_range_run(&self->range, self->next, count);
+            if (self->results != NULL) {
+                self->next += count;
+                self->position = 0;
+            }
+        }
+    }
+
+    if (self->results != NULL) {
+        value = PyList_GET_ITEM(self->results, self->position++);
+        Py_INCREF(value);
+    }
+
+    PyThread_release_lock(self->lock);
+    return value;
+}
+
+static PyObject* CZINTRangeRenders_length_hint(
+    CZINTRangeRenders *self, PyObject *unused
+) {
+    size_t remaining = self->range.count - self->next;
+
+    if (self->results != NULL) {
+        remaining += PyList_GET_SIZE(self->results) - self->position;
+    }
+    return PyLong_FromSize_t(remaining);
+}
+
+static PyMethodDef CZINTRangeRenders_methods[] = {
+    {
+        "__length_hint__",
+        (PyCFunction) CZINTRangeRenders_length_hint, METH_NOARGS, NULL
+    },
+    {NULL}  /* Sentinel */
+};
+
+static PyType_Slot CZINTRangeRenders_slots[] = {
+    {
+        Py_tp_doc,
+        "Iterator of render_range results, rendered chunk by chunk "
+        "on the native pool as it is consumed."
+    },
+    {Py_tp_dealloc, CZINTRangeRenders_dealloc},
+    {Py_tp_iter, PyObject_SelfIter},
+    {Py_tp_iternext, CZINTRangeRenders_next},
+    {Py_tp_methods, CZINTRangeRenders_methods},
+    {0, NULL}
+};
+
+static PyType_Spec CZINTRangeRenders_spec = {
+    .name = "pyzint.zint._RangeRenders",
+    .basicsize = sizeof(CZINTRangeRenders),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = CZINTRangeRenders_slots,
+};
+
+/* Write rendered chunks back to back into file descriptor or file
+ * object, raise first failed item. Returns bytes written. */
+static PyObject* czint_range_write(czint_range *range, PyObject *file) {
+    czint_file_sink file_sink = {0};
+    czint_stream stream;
+    czint_sink sink;
+    PyObject *results = NULL;
+    PyObject *error = NULL;
+    int descriptor = -1;
+    size_t next, count;
+
+    if (PyLong_Check(file)) {
+        long fd = PyLong_AsLong(file);
+
+        if (fd == -1 && PyErr_Occurred()) return NULL;
+        if (fd < 0 || fd > INT_MAX) {
+            PyErr_Format(PyExc_ValueError, "invalid file descriptor %ld", fd);
+            return NULL;
+        }
+
+        descriptor = (int) fd;
+        czint_sink_init(&sink, czint_sink_fd, &descriptor);
+    } else {
+        file_sink.write = PyObject_GetAttrString(file, "write");
+        if (file_sink.write == NULL) {
+            if (!PyErr_ExceptionMatches(PyExc_AttributeError)) return NULL;
+            PyErr_Clear();
+            PyErr_Format(
+                PyExc_TypeError,
+                "file must be file descriptor or have write() method, not %.50s",
+                Py_TYPE(file)->tp_name
+            );
+            return NULL;
+        }
+        czint_sink_init(&sink, czint_file_sink_write, &file_sink);
+    }
+
+    for (next = 0; next < range->count; next += count) {
+        Py_ssize_t rendered = 0;
+
+        count = range->count - next;
+        if (count > range->chunk) count = range->chunk;
+
+        results = czint_range_run(range, next, count);
+        if (results == NULL) break;
+
+        for (; rendered < PyList_GET_SIZE(results); rendered++) {
+            error = PyList_GET_ITEM(results, rendered);
+            if (!PyBytes_Check(error)) break;
+        }
+        if (rendered == PyList_GET_SIZE(results)) error = NULL;
+        Py_XINCREF(error);
+
+        /* File object sink takes GIL back for write() only */
+        file_sink.thread = PyEval_SaveThread();
+        czint_stream_init(&stream, &sink);
+        for (Py_ssize_t i = 0; i < rendered; i++) {
+            PyObject *value = PyList_GET_ITEM(results, i);
+
+            if (czint_stream_add(
+                &stream, PyBytes_AS_STRING(value), PyBytes_GET_SIZE(value)
+            )) break;
+        }
+        czint_stream_flush(&stream);
+        PyEval_RestoreThread(file_sink.thread);
+
+        Py_CLEAR(results);
+        if (sink.failed || error != NULL) break;
+    }
+
+    Py_XDECREF(file_sink.write);
+
+    if (sink.failed) {
+        Py_XDECREF(error);
+        /* Exception raised by write() */
+        if (descriptor < 0) return NULL;
+        errno = sink.error;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+
+    if (error != NULL) {
+        PyErr_SetObject((PyObject *) Py_TYPE(error), error);
+        Py_DECREF(error);
+        return NULL;
+    }
+
+    if (PyErr_Occurred()) return NULL;
+    return PyLong_FromSize_t(sink.size);
+}
+
+PyDoc_STRVAR(CZINT_render_range_docstring,
+    "Render serial numbered payloads like render_many, payload of "
+    "every value of range(start, stop, step) is formatted natively "
+    "from template, which holds one %d conversion with optional 0 "
+    "flag and width: 'LOT-%06d'. Payloads are formatted and rendered "
+    "on the native pool chunk items at a time, so no Python objects "
+    "are made per item except the results. Returns an iterator of "
+    "bytes and RuntimeError instances rendering next chunk as it is "
+    "consumed. With file, a descriptor or an object with write() "
+    "method, renders are written back to back into it instead, "
+    "stopping at the first failed one which is raised, and number of "
+    "bytes written is returned.\n\n"
+    "    render_range(BARCODE_CODE128, 'LOT-%06d', 1, 500001, step: int = 1, format: str = 'bmp', threads: int = 0, chunk: int = 256, file: Union[int, BinaryIO] = None, angle: int = 0, fgcolor: str = None, bgcolor: str = None, direct: bool = False, compact: bool = False, level: int = 6, strategy: str = None, filter: str = None, **options) -> Union[Iterator[Union[bytes, RuntimeError]], int]"
+);
+static PyObject* CZINT_render_range(
+    PyObject *module, PyObject *args, PyObject *kwds
+) {
+    static char *kwlist[] = {
+        "kind", "template", "start", "stop", "step",
+        "format", "threads", "chunk", "file",
+        "angle", "fgcolor", "bgcolor", "direct", "compact",
+        "level", "strategy", "filter", NULL
+    };
+
+    czint_state *state = PyModule_GetState(module);
+    PyObject *kind = NULL;
+    PyObject *template = NULL;
+    long long start, stop, step = 1;
+    char *format_str = "bmp";
+    int threads = 0;
+    Py_ssize_t chunk = CZINT_RANGE_CHUNK;
+    PyObject *file = Py_None;
+    char *fgcolor_str = NULL;
+    char *bgcolor_str = NULL;
+    char *strategy_str = NULL;
+    char *filter_str = NULL;
+    int level;
+
+    PyObject *own_kwds = NULL;
+    PyObject *options = NULL;
+    PyObject *result = NULL;
+    CZINTRangeRenders *renders = NULL;
+    const char *template_str;
+    Py_ssize_t template_length;
+    czint_range range;
+
+    memset(&range, 0, sizeof(range));
+    czint_render_options_init(&range.batch.render);
+    level = range.batch.render.png.level;
+
+    if (czint_batch_split_kwds(kwds, kwlist, &own_kwds, &options)) goto exit;
+
+    if (!PyArg_ParseTupleAndKeywords(
+        args, own_kwds, "OOLL|LsinOizzppizz", kwlist,
+        &kind, &template, &start, &stop, &step,
+        &format_str, &threads, &chunk, &file,
+        &range.batch.render.angle, &fgcolor_str, &bgcolor_str,
+        &range.batch.render.direct, &range.batch.render.compact,
+        &level, &strategy_str, &filter_str
+    )) goto exit;
+
+    if (PyBytes_Check(template)) {
+        template_str = PyBytes_AS_STRING(template);
+        template_length = PyBytes_GET_SIZE(template);
+    } else if (PyUnicode_Check(template)) {
+        template_str = PyUnicode_AsUTF8AndSize(template, &template_length);
+        if (template_str == NULL) goto exit;
+    } else {
+        PyErr_Format(
+            PyExc_TypeError, "template must be str or bytes, got %s",
+            Py_TYPE(template)->tp_name
+        );
+        goto exit;
+    }
+
+    if (chunk < 1) {
+        PyErr_Format(PyExc_ValueError, "chunk must be positive got %zd", chunk);
+        goto exit;
+    }
+
+    if (czint_range_template(&range, template_str, template_length)) goto exit;
+    if (czint_range_count(start, stop, step, &range.count)) goto exit;
+
+    range.start = start;
+    range.step = step;
+    range.chunk = (size_t) chunk;
+    if (range.count > 0 && range.chunk > range.count) range.chunk = range.count;
+
+    if (czint_batch_setup(
+        &range.batch, module, kind, options, format_str, threads,
+        fgcolor_str, bgcolor_str, level, strategy_str, filter_str
+    )) goto exit;
+
+    if (czint_range_alloc(&range)) goto exit;
+
+    if (file != Py_None) {
+        result = czint_range_write(&range, file);
+        goto exit;
+    }
+
+    renders = PyObject_New(CZINTRangeRenders, state->RangeRendersType);
+    if (renders == NULL) goto exit;
+
+    renders->range = range;
+    renders->next = 0;
+    renders->results = NULL;
+    renders->position = 0;
+    renders->lock = PyThread_allocate_lock();
+    memset(&range, 0, sizeof(range));
+
+    if (renders->lock == NULL) {
+        PyErr_NoMemory();
+        Py_DECREF(renders);
+        goto exit;
+    }
+    result = (PyObject *) renders;
+
+exit:
+    czint_range_release(&range);
+    Py_XDECREF(options);
+    Py_XDECREF(own_kwds);
+    return result;
+}
+
+
+typedef struct {
+    const czint_batch *batch;   /* render options and payload settings */
+    CZINT **zints;              /* Zint item, NULL for payloads */
+    const char **data;
+    Py_ssize_t *lengths;
+} czint_sheet_items;
+
+/* Render one sheet tile on a pool thread. Called without GIL. */
+static void czint_sheet_render_item(void *ctx, size_t index, czint_result *bmp) {
+    czint_sheet_items *items = ctx;
+    CZINT *zint = items->zints[index];
+    struct zint_symbol *symbol;
+    int res;
+
+    if (zint != NULL) {
+        symbol = czint_encode(zint, 0, bmp);
+        if (symbol == NULL) return;
+
+        res = czint_render_bmp_symbol(symbol, &items->batch->render, bmp);
+    } else {
+        symbol = czint_symbol_acquire();
+        if (symbol == NULL) {
+            czint_result_error(bmp, "Symbol initialization failed");
+            return;
+        }
+
+        czint_symbol_setup(items->batch->options, symbol);
+
+        res = czint_encode_symbol(symbol, items->data[index], items->lengths[index]);
+
+        if (res == 0) res = czint_render_bmp_symbol(symbol, &items->batch->render, bmp);
+    }
+
+    czint_result_set(bmp, symbol, res);
+    czint_symbol_release(symbol);
+}
+
+/* Grid cells row by row, or explicit (x, y) positions */
+static int czint_sheet_layout(
+    czint_sheet *sheet, czint_sheet_box *boxes, PyObject *positions,
+    int columns, int cell_width, int cell_height, int margin, int gap
+) {
+    Py_ssize_t count = sheet->count, i;
+
+    if (positions != NULL && positions != Py_None) {
+        PyObject *items = PySequence_Tuple(positions);
+        if (items == NULL) return -1;
+
+        if (PyTuple_GET_SIZE(items) != count) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "positions must have one (x, y) pair per item, "
+                "got %zd for %zd items",
+                PyTuple_GET_SIZE(items), count
+            );
+            Py_DECREF(items);
+            return -1;
+        }
+
+        if (sheet->height == 0) {
+            PyErr_SetString(PyExc_ValueError, "height is required with positions");
+            Py_DECREF(items);
+            return -1;
+        }
+
+        for (i = 0; i < count; i++) {
+            long x, y;
+
+            if (!PyArg_ParseTuple(
+                PyTuple_GET_ITEM(items, i), "ll;position must be (x, y) pair", &x, &y
+            )) {
+                Py_DECREF(items);
+                return -1;
+            }
+
+            if (x < 0 || y < 0 || x >= (long) sheet->width || y >= (long) sheet->height) {
+                PyErr_Format(
+                    PyExc_ValueError,
+                    "position (%ld, %ld) of item %zd is outside of %ux%u page",
+                    x, y, i, sheet->width, sheet->height
+                );
+                Py_DECREF(items);
+                return -1;
+            }
+
+            boxes[i].x = x;
+            boxes[i].y = y;
+            boxes[i].width = cell_width > 0 ? cell_width : (long) sheet->width - x;
+            boxes[i].height = cell_height > 0 ? cell_height : (long) sheet->height - y;
+        }
+
+        Py_DECREF(items);
+        return 0;
+    }
+
+    if (cell_width <= 0 || cell_height <= 0) {
+        PyErr_SetString(
+            PyExc_ValueError, "cell_width and cell_height are required for grid"
+        );
+        return -1;
+    }
+
+    if (columns <= 0) {
+        columns = ((long) sheet->width - 2 * margin + gap) / (cell_width + gap);
+        if (columns < 1) columns = 1;
+    }
+
+    if (sheet->height == 0) {
+        long rows = count ? (count + columns - 1) / columns : 1;
+        long height = 2 * (long) margin + rows * cell_height + (rows - 1) * gap;
+
+        if (height > CZINT_SHEET_MAX_SIZE) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "page height %ld is larger than %d", height, CZINT_SHEET_MAX_SIZE
+            );
+            return -1;
+        }
+        sheet->height = (unsigned int) height;
+    }
+
+    for (i = 0; i < count; i++) {
+        boxes[i].x = margin + (i % columns) * (long) (cell_width + gap);
+        boxes[i].y = margin + (i / columns) * (long) (cell_height + gap);
+        boxes[i].width = cell_width;
+        boxes[i].height = cell_height;
+
+        if (boxes[i].x >= (long) sheet->width || boxes[i].y >= (long) sheet->height) {
+            PyErr_Format(
+                PyExc_ValueError,
+                "item %zd does not fit on %ux%u page",
+                i, sheet->width, sheet->height
+            );
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+PyDoc_STRVAR(CZINT_render_sheet_docstring,
+    "Compose many barcodes into one 1bit page of width x height pixels. "
+    "Items are Zint objects or payloads, payloads are encoded as "
+    "kind with **options like render_many does. Items are placed "
+    "row by row into grid cells of cell_width x cell_height pixels "
+    "with margin around the page and gap between cells (columns=0 "
+    "fits as many as page width allows, height=0 grows page to fit "
+    "all rows), or at top left corners given by positions. Every "
+    "barcode is clipped to its cell and the page. Tiles are rendered "
+    "on a native thread pool band by band and freed once copied into "
+    "the page. Format is 'bmp', 'png', 'zpl' or 'escpos'.\n\n"
+    "    render_sheet(items: Sequence[Union[Zint, str, bytes]], width: int, height: int = 0, columns: int = 0, cell_width: int = 0, cell_height: int = 0, margin: int = 0, gap: int = 0, positions: Sequence[Tuple[int, int]] = None, kind: int = None, format: str = 'bmp', threads: int = 0, angle: int = 0, fgcolor: str = None, bgcolor: str = None, direct: bool = False, level: int = 6, strategy: str = None, filter: str = None, **options) -> bytes"
+);
+static PyObject* CZINT_render_sheet(
+    PyObject *module, PyObject *args, PyObject *kwds
+) {
+    static char *kwlist[] = {
+        "items", "width", "height", "columns", "cell_width", "cell_height",
+        "margin", "gap", "positions", "kind", "format", "threads",
+        "angle", "fgcolor", "bgcolor", "direct",
+        "level", "strategy", "filter", NULL
+    };
+
+    czint_state *state = PyModule_GetState(module);
+    PyObject *payloads = NULL, *positions = NULL, *kind = NULL;
+    char *format_str = "bmp";
+    int width = 0, height = 0, columns = 0, cell_width = 0, cell_height = 0;
+    int margin = 0, gap = 0, threads = 0, level, res;
+    char *fgcolor_str = NULL;
+    char *bgcolor_str = NULL;
+    char *strategy_str = NULL;
+    char *filter_str = NULL;
+
+    PyObject *own_kwds = NULL;
+    PyObject *options = NULL;
+    PyObject *items = NULL;
+    PyObject *result = NULL;
+
+    czint_batch batch;
+    czint_sheet_items sheet_items;
+    czint_sheet sheet;
+    czint_sheet_box *boxes = NULL;
+    czint_result page = {0}, output = {0};
+    Py_ssize_t count = 0, i;
+    size_t failed = 0;
+    int need_template = 0;
+
+    memset(&batch, 0, sizeof(batch));
+    memset(&sheet_items, 0, sizeof(sheet_items));
+    memset(&sheet, 0, sizeof(sheet));
+    czint_render_options_init(&batch.render);
+    level = batch.render.png.level;
+    sheet_items.batch = &batch;
+
+    if (czint_batch_split_kwds(kwds, kwlist, &own_kwds, &options)) goto exit;
+
+    if (!PyArg_ParseTupleAndKeywords(
+        args, own_kwds, "Oi|iiiiiiOOsiizzpizz", kwlist,
+        &payloads, &width, &height, &columns, &cell_width, &cell_height,
+        &margin, &gap, &positions, &kind, &format_str, &threads,
+        &batch.render.angle, &fgcolor_str, &bgcolor_str,
+        &batch.render.direct, &level, &strategy_str, &filter_str
+    )) goto exit;
+
+    if (czint_batch_parse(
+        &batch, format_str, threads,
+        fgcolor_str, bgcolor_str, level, strategy_str, filter_str
+    )) goto exit;
+
+    if (batch.format == CZINT_FORMAT_SVG) {
+        PyErr_SetString(PyExc_ValueError, "render_sheet can't compose svg pages");
+        goto exit;
+    }
+
+    if (width < 1 || width > CZINT_SHEET_MAX_SIZE ||
+        height < 0 || height > CZINT_SHEET_MAX_SIZE) {
+        PyErr_Format(
+            PyExc_ValueError,
+            "page size must be in range 1..%d got %dx%d",
+            CZINT_SHEET_MAX_SIZE, width, height
+        );
+        goto exit;
+    }
+
+    if (margin < 0 || gap < 0 || columns < 0) {
+        PyErr_SetString(
+            PyExc_ValueError, "margin, gap and columns must not be negative"
+        );
+        goto exit;
+    }
+
+    /* Own the items, so a list can't be mutated under our feet */
+    items = PySequence_Tuple(payloads);
+    if (items == NULL) goto exit;
+
+    count = PyTuple_GET_SIZE(items);
+    sheet_items.zints = calloc(count ? count : 1, sizeof(CZINT *));
+    sheet_items.data = calloc(count ? count : 1, sizeof(char *));
+    sheet_items.lengths = calloc(count ? count : 1, sizeof(Py_ssize_t));
+    boxes = calloc(count ? count : 1, sizeof(czint_sheet_box));
+    if (sheet_items.zints == NULL || sheet_items.data == NULL ||
+        sheet_items.lengths == NULL || boxes == NULL) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    for (i = 0; i < count; i++) {
+        PyObject *item = PyTuple_GET_ITEM(items, i);
+
+        if (PyObject_TypeCheck(item, state->ZintType)) {
+            sheet_items.zints[i] = (CZINT *) item;
+        } else if (PyBytes_Check(item)) {
+            if (PyBytes_AsStringAndSize(
+                item, (char **) &sheet_items.data[i], &sheet_items.lengths[i]
+            ) == -1) goto exit;
+            need_template = 1;
+        } else if (PyUnicode_Check(item)) {
+            sheet_items.data[i] = PyUnicode_AsUTF8AndSize(item, &sheet_items.lengths[i]);
+            if (sheet_items.data[i] == NULL) goto exit;
+            need_template = 1;
+        } else {
+            PyErr_Format(
+                PyExc_ValueError,
+                "item %zd must be Zint, str or bytes, got %s",
+                i, Py_TYPE(item)->tp_name
+            );
+            goto exit;
+        }
+    }
+
+    if (need_template || PyDict_GET_SIZE(options) > 0) {
+        if (kind == NULL || kind == Py_None) {
+            PyErr_SetString(
+                PyExc_TypeError, "kind is required to render payload items"
+            );
+            goto exit;
+        }
+
+        if (czint_batch_template(&batch, module, kind, options)) goto exit;
+    }
+
+    sheet.width = width;
+    sheet.height = height;
+    sheet.boxes = boxes;
+    sheet.count = count;
+    sheet.render = czint_sheet_render_item;
+    sheet.ctx = &sheet_items;
+    sheet.threads = batch.threads;
+
+    if (czint_sheet_layout(
+        &sheet, boxes, positions, columns, cell_width, cell_height, margin, gap
+    )) goto exit;
+
+    Py_BEGIN_ALLOW_THREADS
+    res = czint_sheet_compose(
+        &sheet, batch.render.fgcolor, batch.render.bgcolor,
+        &page, &failed
+    );
+    if (res == 0 && batch.format == CZINT_FORMAT_PNG) {
+        res = czint_make_png(&page, &batch.render, &output) ? -1 : 0;
+    } else if (res == 0 && batch.format != CZINT_FORMAT_BMP) {
+        res = czint_make_label(&page, batch.format, &batch.render, &output) ? -1 : 0;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (res < 0) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+
+    if (res > 0) {
+        PyErr_CodeFormat(
+            PyExc_RuntimeError, page.res,
+            "Error while rendering item %zd: %s", (Py_ssize_t) failed, page.errtxt
+        );
+        goto exit;
+    }
+
+    result = czint_result_bytes(batch.format == CZINT_FORMAT_BMP ? &page : &output);
+
+exit:
+    free(page.data);
+    free(output.data);
+    free(boxes);
+    free(sheet_items.zints);
+    free((void *) sheet_items.data);
+    free(sheet_items.lengths);
+    Py_XDECREF(items);
+    czint_batch_release(&batch);
+    Py_XDECREF(options);
+    Py_XDECREF(own_kwds);
+    return result;
+}
+
+PyDoc_STRVAR(CZINT_symbol_pool_stats_docstring,
+    "Counters of per thread zint_symbol free lists used by renders: "
+    "symbols created, reused from a list, returned to a list and "
+    "discarded because list was full, plus current list limit.\n\n"
+    "    symbol_pool_stats() -> Dict[str, int]"
+);
+static PyObject* CZINT_symbol_pool_stats(PyObject *module, PyObject *unused) {
+    czint_symbol_pool_stats stats;
+
+    czint_symbol_pool_stats_get(&stats);
+
+    return Py_BuildValue(
+        "{sKsKsKsKsi}",
+        "created", stats.created,
+        "reused", stats.reused,
+        "pooled", stats.pooled,
+        "discarded", stats.discarded,
+        "limit", czint_symbol_pool_limit()
+    );
+}
+
+PyDoc_STRVAR(CZINT_set_symbol_pool_limit_docstring,
+    "Set how many free symbols every thread may keep, 0 disables "
+    "pooling. Values are clamped to 0..64.\n\n"
+    "    set_symbol_pool_limit(limit: int) -> None"
+);
+static PyObject* CZINT_set_symbol_pool_limit(PyObject *module, PyObject *arg) {
+    long limit = PyLong_AsLong(arg);
+
+    if (limit == -1 && PyErr_Occurred()) return NULL;
+
+    if (limit < 0) limit = 0;
+    if (limit > CZINT_SYMBOL_POOL_MAX) limit = CZINT_SYMBOL_POOL_MAX;
+
+    czint_symbol_pool_set_limit((int) limit);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(CZINT_render_cache_stats_docstring,
+    "Counters of render cache: lookups which hit and missed, bytes "
+    "objects stored and evicted, current entries and bytes they take "
+    "and the limit.\n\n"
+    "    render_cache_stats() -> Dict[str, int]"
+);
+static PyObject* CZINT_render_cache_stats(PyObject *module, PyObject *unused) {
+    czint_state *state = PyModule_GetState(module);
+    czint_cache_stats stats;
+
+    czint_cache_stats_get(&state->cache, &stats);
+
+    return Py_BuildValue(
+        "{sKsKsKsKsnsnsn}",
+        "hits", stats.hits,
+        "misses", stats.misses,
+        "insertions", stats.insertions,
+        "evictions", stats.evictions,
+        "entries", (Py_ssize_t) stats.entries,
+        "bytes", (Py_ssize_t) stats.bytes,
+        "limit", (Py_ssize_t) stats.limit
+    );
+}
+
+PyDoc_STRVAR(CZINT_set_render_cache_limit_docstring,
+    "Keep up to limit bytes of rendered output, least recently used "
+    "first out. Cached renders of the same data, settings and options "
+    "return the same bytes object without encoding or rendering. "
+    "Zint.render_bmp, render_svg, render_png, render_zpl, render_escpos "
+    "and render_many use it. 0, the default, turns cache off and drops "
+    "its content.\n\n"
+    "    set_render_cache_limit(limit: int) -> None"
+);
+static PyObject* CZINT_set_render_cache_limit(PyObject *module, PyObject *arg) {
+    czint_state *state = PyModule_GetState(module);
+    Py_ssize_t limit = PyLong_AsSsize_t(arg);
+
+    if (limit == -1 && PyErr_Occurred()) return NULL;
+
+    if (limit < 0) {
+        PyErr_Format(
+            PyExc_ValueError, "limit must be positive or zero got %zd", limit
+        );
+        return NULL;
+    }
+
+    czint_cache_set_limit(&state->cache, (size_t) limit);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(CZINT_clear_render_cache_docstring,
+    "Drop everything render cache keeps, counters stay.\n\n"
+    "    clear_render_cache() -> None"
+);
+static PyObject* CZINT_clear_render_cache(PyObject *module, PyObject *unused) {
+    czint_state *state = PyModule_GetState(module);
+
+    czint_cache_clear(&state->cache);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(CZINT_set_shared_render_cache_docstring,
+    "Look renders up in SharedCache after render cache misses and store "
+    "fresh ones there, so processes sharing its segment render each "
+    "symbol once. Keys are the same as render cache ones. None stops "
+    "using it.\n\n"
+    "    set_shared_render_cache(cache: Optional[SharedCache]) -> None"
+);
+static PyObject* CZINT_set_shared_render_cache(
+    PyObject *module, PyObject *cache
+) {
+    czint_state *state = PyModule_GetState(module);
+    PyObject *old;
+
+    if (cache != Py_None && !Py_IS_TYPE(cache, state->SharedCacheType)) {
+        PyErr_Format(
+            PyExc_TypeError, "SharedCache or None expected got %s",
+            Py_TYPE(cache)->tp_name
+        );
+        return NULL;
+    }
+
+    if (cache == Py_None) cache = NULL;
+    Py_XINCREF(cache);
+
+    PyThread_acquire_lock(state->shared_lock, WAIT_LOCK);
+    old = state->shared_cache;
+    state->shared_cache = cache;
+    PyThread_release_lock(state->shared_lock);
+
+    Py_XDECREF(old);
+    Py_RETURN_NONE;
+}
+
+/* {"count": int, "bytes": int, "ns": int, "histogram": [int, ...]} */
+static PyObject* czint_stats_counter_dict(const czint_stats_counter *counter) {
+    PyObject *histogram;
+    int i;
+
+    histogram = PyList_New(CZINT_STATS_BUCKETS);
+    if (histogram == NULL) return NULL;
+
+    for (i = 0; i < CZINT_STATS_BUCKETS; i++) {
+        PyObject *value = PyLong_FromUnsignedLongLong(counter->histogram[i]);
+        if (value == NULL) {
+            Py_DECREF(histogram);
+            return NULL;
+        }
+        PyList_SET_ITEM(histogram, i, value);
+    }
+
+    return Py_BuildValue(
+        "{sKsKsKsN}",
+        "count", (unsigned long long) counter->count,
+        "bytes", (unsigned long long) counter->bytes,
+        "ns", (unsigned long long) counter->ns,
+        "histogram", histogram
+    );
+}
+
+/* Add phases with any count into dict keyed by phase name */
+static int czint_stats_phases_dict(
+    PyObject *target, const czint_stats_symbology *symbology
+) {
+    PyObject *value;
+    int phase;
+
+    for (phase = 0; phase < CZINT_STATS_PHASES; phase++) {
+        if (symbology->phases[phase].count == 0) continue;
+
+        value = czint_stats_counter_dict(&symbology->phases[phase]);
+        if (value == NULL) return -1;
+
+        if (PyDict_SetItemString(
+            target, czint_stats_phase_names[phase], value
+        )) {
+            Py_DECREF(value);
+            return -1;
+        }
+        Py_DECREF(value);
+    }
+
+    return 0;
+}
+
+PyDoc_STRVAR(CZINT_stats_docstring,
+    "Render counters summed over all threads, per phase and per "
+    "symbology number. Phases are 'encode', 'raster', 'vector', 'bmp', "
+    "'svg', 'png', 'matrix', 'zpl', 'escpos' and 'copy' (into bytes "
+    "object). Every phase has "
+    "count, bytes (payload for encode, rgb bitmap for raster, output "
+    "otherwise), total ns and histogram where bucket i counts durations "
+    "of 2**i..2**(i+1) ns. Counting is off unless PYZINT_STATS "
+    "environment variable is set or set_stats_enabled(True) is called.\n\n"
+    "    stats() -> Dict[str, Any]"
+);
+static PyObject* CZINT_stats(PyObject *module, PyObject *unused) {
+    czint_stats_symbology *symbologies, total;
+    PyObject *result = NULL, *phases = NULL, *by_symbology = NULL;
+    PyObject *key, *value;
+    int i, phase;
+
+    symbologies = calloc(CZINT_STATS_SYMBOLOGIES, sizeof(czint_stats_symbology));
+    if (symbologies == NULL) return PyErr_NoMemory();
+
+    Py_BEGIN_ALLOW_THREADS
+    czint_stats_collect(symbologies);
+    Py_END_ALLOW_THREADS
+
+    memset(&total, 0, sizeof(total));
+
+    by_symbology = PyDict_New();
+    if (by_symbology == NULL) goto exit;
+
+    for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+        int used = 0;
+
+        for (phase = 0; phase < CZINT_STATS_PHASES; phase++) {
+            const czint_stats_counter *from = &symbologies[i].phases[phase];
+            czint_stats_counter *to = &total.phases[phase];
+            int bucket;
+
+            if (from->count == 0) continue;
+            used = 1;
+
+            to->count += from->count;
+            to->bytes += from->bytes;
+            to->ns += from->ns;
+            for (bucket = 0; bucket < CZINT_STATS_BUCKETS; bucket++) {
+                to->histogram[bucket] += from->histogram[bucket];
             }
-            circle = circle->next;
         }
 
-        string = symbol->vector->strings;
-        while (string) {
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "<text x=\"%.2f\" y=\"%.2f\" text-anchor=\"middle\" ", string->x, string->y);
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "font-family=\"Helvetica\" font-size=\"%.1f\" fill=\"#%s\">", string->fsize, symbol->fgcolour);
-            make_html_friendly(string->text, html_string);
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, " %s ", html_string);
-            len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "</text>");
-            string = string->next;
+        if (!used) continue;
+
+        value = PyDict_New();
+        if (value == NULL) goto exit;
+
+        key = PyLong_FromLong(i);
+        if (key == NULL || czint_stats_phases_dict(value, &symbologies[i]) ||
+            PyDict_SetItem(by_symbology, key, value)) {
+            Py_XDECREF(key);
+            Py_DECREF(value);
+            goto exit;
         }
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+
+    phases = PyDict_New();
+    if (phases == NULL || czint_stats_phases_dict(phases, &total)) goto exit;
+
+    result = Py_BuildValue(
+        "{sOsOsO}",
+        "enabled", czint_stats_enabled() ? Py_True : Py_False,
+        "phases", phases,
+        "symbologies", by_symbology
+    );
+
+exit:
+    Py_XDECREF(phases);
+    Py_XDECREF(by_symbology);
+    free(symbologies);
+    return result;
+}
+
+PyDoc_STRVAR(CZINT_reset_stats_docstring,
+    "Zero render counters of all threads.\n\n"
+    "    reset_stats() -> None"
+);
+static PyObject* CZINT_reset_stats(PyObject *module, PyObject *unused) {
+    Py_BEGIN_ALLOW_THREADS
+    czint_stats_reset();
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(CZINT_set_stats_enabled_docstring,
+    "Turn render counters on or off for the whole process.\n\n"
+    "    set_stats_enabled(enabled: bool) -> None"
+);
+static PyObject* CZINT_set_stats_enabled(PyObject *module, PyObject *arg) {
+    int enabled = PyObject_IsTrue(arg);
+
+    if (enabled < 0) return NULL;
 
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "</g>");
-        len_fsvg += snprintf(&fsvg[len_fsvg], max_len-len_fsvg, "</svg>");
+    czint_stats_set_enabled(enabled);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(CZINT_symbology_info_docstring,
+    "Capabilities and input limits the binding knows for symbology: name, "
+    "shape flags (linear, stacked, matrix, postal, composite), whether "
+    "data is GS1 and primary is required, whether renders may skip raster "
+    "stage (direct), max_length in bytes (None when only encoder knows) "
+    "and charset: 'bytes', 'ascii', 'numeric' or string of accepted "
+    "characters.\n\n"
+    "    symbology_info(kind: int) -> Dict[str, Any]"
+);
+static PyObject* CZINT_symbology_info(PyObject *module, PyObject *arg) {
+    static const struct {
+        const char *key;
+        unsigned int flag;
+    } flags[] = {
+        {"linear", CZINT_SYMBOLOGY_LINEAR},
+        {"stacked", CZINT_SYMBOLOGY_STACKED},
+        {"matrix", CZINT_SYMBOLOGY_MATRIX},
+        {"postal", CZINT_SYMBOLOGY_POSTAL},
+        {"composite", CZINT_SYMBOLOGY_COMPOSITE},
+        {"gs1", CZINT_SYMBOLOGY_GS1},
+        {"primary", CZINT_SYMBOLOGY_PRIMARY},
+        {"direct", CZINT_SYMBOLOGY_DIRECT},
+    };
+    const czint_symbology *info;
+    PyObject *result, *value;
+    long kind;
+    size_t i;
+
+    kind = PyLong_AsLong(arg);
+    if (kind == -1 && PyErr_Occurred()) return NULL;
+
+    info = czint_symbology_get(kind < 0 || kind > INT_MAX ? -1 : (int) kind);
+    if (info == NULL) {
+        PyErr_Format(PyExc_ValueError, "Unknown barcode type %ld", kind);
+        return NULL;
+    }
+
+    switch (info->charset) {
+        case CZINT_CHARSET_ASCII:
+            value = PyUnicode_FromString("ascii");
+            break;
+        case CZINT_CHARSET_NUMERIC:
+            value = PyUnicode_FromString("numeric");
+            break;
+        case CZINT_CHARSET_SET:
+            value = PyUnicode_FromString(info->set);
+            break;
+        default:
+            value = PyUnicode_FromString("bytes");
+    }
+
+    result = Py_BuildValue("{s:l,s:s,s:N}", "id", kind, "name", info->name, "charset", value);
+    if (result == NULL) return NULL;
+
+    for (i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        value = (info->flags & flags[i].flag) ? Py_True : Py_False;
+        if (PyDict_SetItemString(result, flags[i].key, value)) goto error;
+    }
+
+    if (info->max_length) {
+        value = PyLong_FromSize_t(info->max_length);
+        if (value == NULL) goto error;
+    } else {
+        Py_INCREF(Py_None);
+        value = Py_None;
+    }
+    if (PyDict_SetItemString(result, "max_length", value)) {
+        Py_DECREF(value);
+        goto error;
+    }
+    Py_DECREF(value);
+    return result;
+
+error:
+    Py_DECREF(result);
+    return NULL;
+}
+
+PyDoc_STRVAR(CZINT_phases_docstring,
+    "Render symbol into bmp and svg `number` times, timing every native "
+    "phase separately. Used by benchmarks/bench_phases.py, values are "
+    "seconds summed over all runs.\n\n"
+    "    _phases(symbol: Zint, number: int = 1, angle: int = 0, "
+    "direct: bool = False, compact: bool = False) -> Dict[str, float]"
+);
+static PyObject* CZINT_phases(PyObject *module, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {
+        "symbol", "number", "angle", "direct", "compact", NULL
+    };
+    czint_state *state = PyModule_GetState(module);
+    czint_render_options options;
+    czint_phases phases = {0};
+    struct zint_symbol *template;
+    PyObject *symbol, *data, *bmp, *svg, *result;
+    CZINT *self;
+    const char *buffer;
+    Py_ssize_t length;
+    double copy = 0, started;
+    int number = 1, res;
+    unsigned int i;
+
+    czint_render_options_init(&options);
 
-        ZBarcode_Clear(symbol);
-        ZBarcode_Delete(symbol);
+    if (!PyArg_ParseTupleAndKeywords(
+        args, kwds, "O!|iipp", kwlist,
+        state->ZintType, &symbol, &number,
+        &options.angle, &options.direct, &options.compact
+    )) return NULL;
 
-        free(html_string);
+    if (number < 1) {
+        PyErr_Format(PyExc_ValueError, "number must be positive got %d", number);
+        return NULL;
     }
 
+    self = (CZINT *) symbol;
+
+    template = ZBarcode_Create();
+    if (template == NULL) return PyErr_NoMemory();
+    czint_symbol_setup(self, template);
+
+    /* Re-initialization of self may release its payload meanwhile */
+    data = self->data;
+    buffer = self->buffer;
+    length = self->length;
+    Py_INCREF(data);
+
+    Py_BEGIN_ALLOW_THREADS
+    res = czint_phases_run(
+        template, (unsigned char *) buffer, length,
+        &options, (unsigned int) number, &phases
+    );
     Py_END_ALLOW_THREADS
 
-    if (res > 0) {
+    Py_DECREF(data);
+    ZBarcode_Delete(template);
+
+    if (res) {
         PyErr_CodeFormat(
-            PyExc_RuntimeError,
-            res,
-            "Error while rendering: %s",
-            symbol->errtxt
+            PyExc_RuntimeError, res,
+            "Error while rendering: %s", phases.bmp_out.errtxt
         );
-        ZBarcode_Clear(symbol);
-        ZBarcode_Delete(symbol);
+        czint_phases_free(&phases);
         return NULL;
     }
 
-    PyObject *result = PyBytes_FromStringAndSize(fsvg, len_fsvg);
-    free(fsvg);
+    /* Same copy render_bmp() and render_svg() do into bytes objects */
+    for (i = 0; i < phases.runs; i++) {
+        started = czint_phases_now();
+        bmp = PyBytes_FromStringAndSize(phases.bmp_out.data, phases.bmp_out.size);
+        svg = PyBytes_FromStringAndSize(phases.svg_out.data, phases.svg_out.size);
+        copy += czint_phases_now() - started;
+        Py_XDECREF(bmp);
+        Py_XDECREF(svg);
+        if (bmp == NULL || svg == NULL) {
+            czint_phases_free(&phases);
+            return NULL;
+        }
+    }
+
+    result = Py_BuildValue(
+        "{sdsdsdsdsdsdsnsn}",
+        "encode", phases.encode,
+        "buffer", phases.buffer,
+        "pack", phases.pack,
+        "vector", phases.vector,
+        "svg", phases.svg,
+        "copy", copy,
+        "bmp_size", (Py_ssize_t) phases.bmp_out.size,
+        "svg_size", (Py_ssize_t) phases.svg_out.size
+    );
+    czint_phases_free(&phases);
     return result;
 }
 
-
-static PyMemberDef
-CZINT_members[] = {
-    {
-        "data", T_OBJECT,
-        offsetof(CZINT, data),
-        READONLY, "Symbol payload"
-    },
-    {
-        "symbology", T_INT,
-        offsetof(CZINT, symbology),
-        READONLY, "Code of symbol to use"
-    },
-    {
-        "symbology_name", T_STRING,
-        offsetof(CZINT, human_symbology),
-        READONLY, "Name of symbol to use"
-    },
-    {
-        "height", T_INT,
-        offsetof(CZINT, height),
-        READONLY, "Symbol height"
-    },
-    {
-        "dot_size", T_FLOAT,
-        offsetof(CZINT, dot_size),
-        READONLY, "Size of dots used in dotty mode"
-    },
+static PyMethodDef pyzint_methods[] = {
     {
-        "scale", T_FLOAT,
-        offsetof(CZINT, scale),
-        READONLY, "Scale factor for adjusting size of image"
+        "render_many",
+        (PyCFunction) CZINT_render_many, METH_VARARGS | METH_KEYWORDS,
+        CZINT_render_many_docstring
     },
     {
-        "border_width", T_INT,
-        offsetof(CZINT, border_width),
-        READONLY, "Border width"
+        "render_range",
+        (PyCFunction) CZINT_render_range, METH_VARARGS | METH_KEYWORDS,
+        CZINT_render_range_docstring
     },
     {
-        "eci", T_INT,
-        offsetof(CZINT, eci),
-        READONLY, "Extended Channel Interpretation mode (3 default)"
+        "render_sheet",
+        (PyCFunction) CZINT_render_sheet, METH_VARARGS | METH_KEYWORDS,
+        CZINT_render_sheet_docstring
     },
     {
-        "fontsize", T_INT,
-        offsetof(CZINT, fontsize),
-        READONLY, "fontsize"
+        "symbol_pool_stats",
+        (PyCFunction) CZINT_symbol_pool_stats, METH_NOARGS,
+        CZINT_symbol_pool_stats_docstring
     },
     {
-        "show_text", T_BOOL,
-        offsetof(CZINT, show_hrt),
-        READONLY, "Set to False to hide text"
+        "set_symbol_pool_limit",
+        (PyCFunction) CZINT_set_symbol_pool_limit, METH_O,
+        CZINT_set_symbol_pool_limit_docstring
     },
     {
-        "option_1", T_INT,
-        offsetof(CZINT, option_1),
-        READONLY, "Symbol specific option 1"
+        "render_cache_stats",
+        (PyCFunction) CZINT_render_cache_stats, METH_NOARGS,
+        CZINT_render_cache_stats_docstring
     },
     {
-        "option_2", T_INT,
-        offsetof(CZINT, option_2),
-        READONLY, "Symbol specific option 2"
+        "set_render_cache_limit",
+        (PyCFunction) CZINT_set_render_cache_limit, METH_O,
+        CZINT_set_render_cache_limit_docstring
     },
     {
-        "option_3", T_INT,
-        offsetof(CZINT, option_3),
-        READONLY, "Symbol specific option 3"
+        "clear_render_cache",
+        (PyCFunction) CZINT_clear_render_cache, METH_NOARGS,
+        CZINT_clear_render_cache_docstring
     },
     {
-        "primary", T_STRING,
-        offsetof(CZINT, primary),
-        READONLY, "Primary message data for more complex symbols"
+        "set_shared_render_cache",
+        (PyCFunction) CZINT_set_shared_render_cache, METH_O,
+        CZINT_set_shared_render_cache_docstring
     },
     {
-        "text", T_STRING,
-        offsetof(CZINT, text),
-        READONLY, "Human readable text, which usually consists of input data plus one more check digit"
+        "stats",
+        (PyCFunction) CZINT_stats, METH_NOARGS,
+        CZINT_stats_docstring
     },
     {
-        "whitespace_width", T_INT,
-        offsetof(CZINT, whitespace_width),
-        READONLY, "Whtespace width"
+        "reset_stats",
+        (PyCFunction) CZINT_reset_stats, METH_NOARGS,
+        CZINT_reset_stats_docstring
     },
     {
-        "border_width", T_INT,
-        offsetof(CZINT, border_width),
-        READONLY, "Border width"
+        "set_stats_enabled",
+        (PyCFunction) CZINT_set_stats_enabled, METH_O,
+        CZINT_set_stats_enabled_docstring
     },
-
-    {NULL}  /* Sentinel */
-};
-
-static PyMethodDef CZINT_methods[] = {
     {
-        "render_bmp",
-        (PyCFunction) CZINT_render_bmp, METH_VARARGS | METH_KEYWORDS,
-        CZINT_render_bmp_docstring
+        "symbology_info",
+        (PyCFunction) CZINT_symbology_info, METH_O,
+        CZINT_symbology_info_docstring
     },
     {
-        "render_svg",
-        (PyCFunction) CZINT_render_svg, METH_VARARGS | METH_KEYWORDS,
-        CZINT_render_svg_docstring
+        "_phases",
+        (PyCFunction) CZINT_phases, METH_VARARGS | METH_KEYWORDS,
+        CZINT_phases_docstring
     },
     {NULL}  /* Sentinel */
 };
 
 
+static int pyzint_traverse(PyObject *module, visitproc visit, void *arg) {
+    czint_state *state = PyModule_GetState(module);
 
-static PyTypeObject
-ZINTType = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "Zint",
-    .tp_doc = "zint - python bindings for zint",
-    .tp_basicsize = sizeof(CZINT),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT,
-    .tp_new = CZINT_new,
-    .tp_init = (initproc) CZINT_init,
-    .tp_dealloc = (destructor) CZINT_dealloc,
-    .tp_methods = CZINT_methods,
-    .tp_members = CZINT_members,
-    .tp_repr = (reprfunc) CZINT_repr
-};
+    Py_VISIT(state->ZintType);
+    Py_VISIT(state->RasterType);
+    Py_VISIT(state->MatrixType);
+    Py_VISIT(state->CompletionsType);
+    Py_VISIT(state->SharedCacheType);
+    Py_VISIT(state->RangeRendersType);
+    for (int i = 0; i < CZINT_ARGS_COUNT; i++) Py_VISIT(state->kwnames[i]);
+    Py_VISIT(state->get_running_loop);
+    Py_VISIT(state->async_queues);
+    Py_VISIT(state->shared_cache);
+    return 0;
+}
 
+static int pyzint_clear(PyObject *module) {
+    czint_state *state = PyModule_GetState(module);
 
-static PyModuleDef pyzint_module = {
-    PyModuleDef_HEAD_INIT,
-    .m_name = "zint",
-    .m_doc = "zint c binding",
-    .m_size = -1,
-};
+    Py_CLEAR(state->ZintType);
+    Py_CLEAR(state->RasterType);
+    Py_CLEAR(state->MatrixType);
+    Py_CLEAR(state->CompletionsType);
+    Py_CLEAR(state->SharedCacheType);
+    Py_CLEAR(state->RangeRendersType);
+    for (int i = 0; i < CZINT_ARGS_COUNT; i++) Py_CLEAR(state->kwnames[i]);
+    Py_CLEAR(state->get_running_loop);
+    Py_CLEAR(state->async_queues);
+    Py_CLEAR(state->shared_cache);
+    return 0;
+}
 
-PyMODINIT_FUNC PyInit_zint(void) {
-    static PyTypeObject* ZINTTypeP = &ZINTType;
-    PyEval_InitThreads();
+static void pyzint_free(void *module) {
+    czint_state *state = PyModule_GetState((PyObject *) module);
 
-    PyObject *m;
+    pyzint_clear((PyObject *) module);
+    czint_cache_destroy(&state->cache);
+    if (state->shared_lock != NULL) PyThread_free_lock(state->shared_lock);
+    state->shared_lock = NULL;
+}
 
-    m = PyModule_Create(&pyzint_module);
+static int pyzint_exec(PyObject *m) {
+    czint_state *state = PyModule_GetState(m);
 
-    if (m == NULL) return NULL;
+    czint_render_init();
+    czint_stats_init();
 
-    if (PyType_Ready(ZINTTypeP) < 0) return NULL;
+    if (czint_cache_init(&state->cache, czint_cache_decref)) {
+        PyErr_NoMemory();
+        return -1;
+    }
 
-    Py_INCREF(ZINTTypeP);
+    state->shared_lock = PyThread_allocate_lock();
+    if (state->shared_lock == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
 
-    if (PyModule_AddObject(m, "Zint", (PyObject *) ZINTTypeP) < 0) {
-        Py_XDECREF(ZINTTypeP);
-        Py_XDECREF(m);
-        return NULL;
+    for (int i = 0; i < CZINT_ARGS_COUNT; i++) {
+        state->kwnames[i] = czint_args_names(&czint_args_specs[i]);
+        if (state->kwnames[i] == NULL) return -1;
     }
 
+    state->ZintType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINT_spec, NULL
+    );
+    if (state->ZintType == NULL) return -1;
+
+    /* Calls of the type object use its tp_vectorcall, there is no spec
+     * slot for it before 3.14 */
+    state->ZintType->tp_vectorcall = CZINT_vectorcall;
+
+    state->RasterType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINTRaster_spec, NULL
+    );
+    if (state->RasterType == NULL) return -1;
+
+    state->MatrixType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINTMatrix_spec, NULL
+    );
+    if (state->MatrixType == NULL) return -1;
+
+    state->CompletionsType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINTCompletions_spec, NULL
+    );
+    if (state->CompletionsType == NULL) return -1;
+
+    state->SharedCacheType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINTSharedCache_spec, NULL
+    );
+    if (state->SharedCacheType == NULL) return -1;
+
+    state->RangeRendersType = (PyTypeObject *) PyType_FromModuleAndSpec(
+        m, &CZINTRangeRenders_spec, NULL
+    );
+    if (state->RangeRendersType == NULL) return -1;
+
+    if (PyModule_AddType(m, state->ZintType) < 0) return -1;
+    if (PyModule_AddType(m, state->RasterType) < 0) return -1;
+    if (PyModule_AddType(m, state->MatrixType) < 0) return -1;
+    if (PyModule_AddType(m, state->SharedCacheType) < 0) return -1;
+
     PyModule_AddIntConstant(m, "SCALE_MAX", CZINT_SCALE_MAX);
     PyModule_AddIntConstant(m, "BARCODE_CODE11", BARCODE_CODE11);
     PyModule_AddIntConstant(m, "BARCODE_C25MATRIX", BARCODE_C25MATRIX);
@@ -1111,5 +4589,29 @@ PyMODINIT_FUNC PyInit_zint(void) {
     PyModule_AddIntConstant(m, "BARCODE_GRIDMATRIX", BARCODE_GRIDMATRIX);
     PyModule_AddIntConstant(m, "BARCODE_UPNQR", BARCODE_UPNQR);
     PyModule_AddIntConstant(m, "BARCODE_RMQR", BARCODE_RMQR);
-    return m;
+    return 0;
+}
+
+static PyModuleDef_Slot pyzint_slots[] = {
+    {Py_mod_exec, pyzint_exec},
+#ifdef Py_mod_multiple_interpreters
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+    {0, NULL}
+};
+
+static PyModuleDef pyzint_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "zint",
+    .m_doc = "zint c binding",
+    .m_size = sizeof(czint_state),
+    .m_methods = pyzint_methods,
+    .m_slots = pyzint_slots,
+    .m_traverse = pyzint_traverse,
+    .m_clear = pyzint_clear,
+    .m_free = pyzint_free,
+};
+
+PyMODINIT_FUNC PyInit_zint(void) {
+    return PyModuleDef_Init(&pyzint_module);
 }
@@ -1,4 +1,8 @@
-from typing import Union
+import asyncio
+from typing import (
+    Any, BinaryIO, Dict, Iterable, Iterator, List, Optional, Sequence, Tuple,
+    Union,
+)
 
 # Tbarcode 7 codes
 BARCODE_CODE11: int
@@ -106,6 +110,37 @@ BARCODE_UPNQR: int
 BARCODE_ULTRA: int
 BARCODE_RMQR: int
 
+# noinspection PyPropertyDefinition
+class Raster:
+    @property
+    def width(self) -> int: ...
+    @property
+    def height(self) -> int: ...
+    @property
+    def stride(self) -> int: ...
+    @property
+    def offset(self) -> int: ...
+    def __len__(self) -> int: ...
+
+class Matrix:
+    @property
+    def rows(self) -> int: ...
+    @property
+    def columns(self) -> int: ...
+    @property
+    def stride(self) -> int: ...
+    def __len__(self) -> int: ...
+
+# noinspection PyPropertyDefinition
+class SharedCache:
+    def __init__(
+        self, path: Optional[str] = None, size: int = 64 * 1024 * 1024,
+    ): ...
+    @property
+    def path(self) -> Optional[str]: ...
+    def stats(self) -> Dict[str, int]: ...
+    def clear(self) -> None: ...
+
 # noinspection PyPropertyDefinition
 class Zint:
     def __init__(
@@ -125,11 +160,98 @@ class Zint:
         dot_size: int = 4.0 / 5.0
     ): ...
     def render_bmp(
-        self, angle: int = 0, bgcolor="#FFFFFF", fgcolor="#000000"
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
     ): ...
+    def render_bmp_buffer(
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
+    ) -> Raster: ...
+    def render_matrix(self) -> Matrix: ...
+    def render_bmp_to(
+        self,
+        file: Union[int, BinaryIO],
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
+    ) -> int: ...
+    def render_bmp_into(
+        self,
+        buffer,
+        offset: int = 0,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
+    ) -> int: ...
+    def render_bmp_async(
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
+    ) -> "asyncio.Future[bytes]": ...
+    def bmp_size(self, angle: int = 0, direct: bool = False) -> int: ...
+    def measure(self, angle: int = 0) -> Dict[str, Optional[int]]: ...
+    def render_png(
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        direct: bool = False,
+        level: int = 6,
+        strategy: str = "default",
+        filter: str = "none",
+    ) -> bytes: ...
+    def render_zpl(
+        self,
+        angle: int = 0,
+        direct: bool = False,
+        compression: str = "z64",
+        label: bool = False,
+    ) -> bytes: ...
+    def render_escpos(self, angle: int = 0, direct: bool = False) -> bytes: ...
     def render_svg(
-        self, angle: int = 0, bgcolor="#FFFFFF", fgcolor="#000000"
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        compact: bool = False,
     ): ...
+    def render_svg_to(
+        self,
+        file: Union[int, BinaryIO],
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        compact: bool = False,
+    ) -> int: ...
+    def render_svg_async(
+        self,
+        angle: int = 0,
+        bgcolor="#FFFFFF",
+        fgcolor="#000000",
+        compact: bool = False,
+    ) -> "asyncio.Future[bytes]": ...
+    def render(
+        self,
+        formats: Sequence[str] = ("bmp", "svg"),
+        angle: int = 0,
+        fgcolor: str = "#000000",
+        bgcolor: str = "#FFFFFF",
+        direct: bool = False,
+        compact: bool = False,
+        level: int = 6,
+        strategy: str = "default",
+        filter: str = "none",
+    ) -> Tuple[bytes, ...]: ...
     @property
     def data(self) -> object: ...
     @property
@@ -162,3 +284,72 @@ class Zint:
     def whitespace_width(self) -> int: ...
     @property
     def border_width(self) -> int: ...
+
+
+def render_many(
+    kind: int,
+    payloads: Iterable[Union[str, bytes]],
+    format: str = "bmp",
+    threads: int = 0,
+    angle: int = 0,
+    fgcolor: str = None,
+    bgcolor: str = None,
+    direct: bool = False,
+    compact: bool = False,
+    level: int = 6,
+    strategy: str = None,
+    filter: str = None,
+    **options
+) -> List[Union[bytes, RuntimeError]]: ...
+def render_range(
+    kind: int,
+    template: Union[str, bytes],
+    start: int,
+    stop: int,
+    step: int = 1,
+    format: str = "bmp",
+    threads: int = 0,
+    chunk: int = 256,
+    file: Union[int, BinaryIO] = None,
+    angle: int = 0,
+    fgcolor: str = None,
+    bgcolor: str = None,
+    direct: bool = False,
+    compact: bool = False,
+    level: int = 6,
+    strategy: str = None,
+    filter: str = None,
+    **options
+) -> Union[Iterator[Union[bytes, RuntimeError]], int]: ...
+def render_sheet(
+    items: Sequence[Union[Zint, str, bytes]],
+    width: int,
+    height: int = 0,
+    columns: int = 0,
+    cell_width: int = 0,
+    cell_height: int = 0,
+    margin: int = 0,
+    gap: int = 0,
+    positions: Sequence[Tuple[int, int]] = None,
+    kind: int = None,
+    format: str = "bmp",
+    threads: int = 0,
+    angle: int = 0,
+    fgcolor: str = None,
+    bgcolor: str = None,
+    direct: bool = False,
+    level: int = 6,
+    strategy: str = None,
+    filter: str = None,
+    **options
+) -> bytes: ...
+def symbol_pool_stats() -> Dict[str, int]: ...
+def set_symbol_pool_limit(limit: int) -> None: ...
+def render_cache_stats() -> Dict[str, int]: ...
+def set_render_cache_limit(limit: int) -> None: ...
+def clear_render_cache() -> None: ...
+def set_shared_render_cache(cache: Optional[SharedCache]) -> None: ...
+def stats() -> Dict[str, Any]: ...
+def reset_stats() -> None: ...
+def set_stats_enabled(enabled: bool) -> None: ...
+def symbology_info(kind: int) -> Dict[str, Any]: ...
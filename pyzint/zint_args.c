@@ -0,0 +1,403 @@
+/* Python.h must come first, it sets feature macros for system headers */
+#include "zint_args.h"
+
+#include <limits.h>
+#include <stdarg.h>
+#include <string.h>
+
+
+typedef struct {
+    Py_ssize_t count;       /* all parameters */
+    Py_ssize_t required;    /* before '|' */
+    Py_ssize_t positional;  /* before '$' */
+} czint_args_shape;
+
+static void czint_args_shape_of(
+    const czint_args_spec *spec, czint_args_shape *shape
+) {
+    const char *f;
+
+    shape->count = 0;
+    shape->required = -1;
+    shape->positional = -1;
+
+    for (f = spec->format; *f; f++) {
+        if (*f == '|') {
+            shape->required = shape->count;
+        } else if (*f == '$') {
+            shape->positional = shape->count;
+        } else if (*f != '*') {
+            shape->count++;
+        }
+    }
+
+    if (shape->required < 0) shape->required = shape->count;
+    if (shape->positional < 0) shape->positional = shape->count;
+}
+
+PyObject *czint_args_names(const czint_args_spec *spec) {
+    czint_args_shape shape;
+    PyObject *names, *name;
+    Py_ssize_t i;
+
+    czint_args_shape_of(spec, &shape);
+
+    names = PyTuple_New(shape.count);
+    if (names == NULL) return NULL;
+
+    for (i = 0; i < shape.count; i++) {
+        name = PyUnicode_InternFromString(spec->kwlist[i]);
+        if (name == NULL) {
+            Py_DECREF(names);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(names, i, name);
+    }
+
+    return names;
+}
+
+static int czint_args_positional(
+    const czint_args_spec *spec, const czint_args_shape *shape,
+    Py_ssize_t nargs
+) {
+    if (nargs <= shape->positional) return 0;
+
+    PyErr_Format(
+        PyExc_TypeError,
+        "%s() takes at most %zd positional arguments (%zd given)",
+        spec->fname, shape->positional, nargs
+    );
+    return -1;
+}
+
+/* Keywords coming from Python code are interned, so identity almost
+ * always matches and string compare is only a fallback */
+static int czint_args_keyword(
+    const czint_args_spec *spec, PyObject *names, Py_ssize_t count,
+    PyObject *key, PyObject *value, PyObject **values
+) {
+    Py_ssize_t i;
+
+    for (i = 0; i < count; i++) {
+        if (PyTuple_GET_ITEM(names, i) == key) goto found;
+    }
+
+    if (!PyUnicode_Check(key)) {
+        PyErr_Format(PyExc_TypeError, "%s() keywords must be strings", spec->fname);
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (PyUnicode_Compare(PyTuple_GET_ITEM(names, i), key) == 0) goto found;
+    }
+
+    PyErr_Format(
+        PyExc_TypeError,
+        "'%U' is an invalid keyword argument for %s()",
+        key, spec->fname
+    );
+    return -1;
+
+found:
+    if (values[i] != NULL) {
+        PyErr_Format(
+            PyExc_TypeError,
+            "argument for %s() given by name ('%U') and position (%zd)",
+            spec->fname, key, i + 1
+        );
+        return -1;
+    }
+
+    values[i] = value;
+    return 0;
+}
+
+static int czint_args_required(
+    const czint_args_spec *spec, const czint_args_shape *shape,
+    PyObject **values
+) {
+    Py_ssize_t i;
+
+    for (i = 0; i < shape->required; i++) {
+        if (values[i] != NULL) continue;
+
+        PyErr_Format(
+            PyExc_TypeError,
+            "%s() missing required argument '%s' (pos %zd)",
+            spec->fname, spec->kwlist[i], i + 1
+        );
+        return -1;
+    }
+
+    return 0;
+}
+
+static int czint_args_long(
+    const czint_args_spec *spec, const char *name, PyObject *value,
+    long min, long max, long *target
+) {
+    long result;
+
+    if (PyFloat_Check(value)) {
+        PyErr_Format(
+            PyExc_TypeError,
+            "%s() argument '%s' must be int, not float",
+            spec->fname, name
+        );
+        return -1;
+    }
+
+    result = PyLong_AsLong(value);
+    if (result == -1 && PyErr_Occurred()) return -1;
+
+    if (result < min || result > max) {
+        PyErr_Format(
+            PyExc_OverflowError,
+            "%s() argument '%s' must be in range %ld..%ld",
+            spec->fname, name, min, max
+        );
+        return -1;
+    }
+
+    *target = result;
+    return 0;
+}
+
+static int czint_args_str(
+    const char *name, PyObject *value, const char **target, Py_ssize_t *size
+) {
+    const char *result;
+    Py_ssize_t length;
+
+    if (!PyUnicode_Check(value)) {
+        PyErr_Format(
+            PyExc_TypeError, "argument '%s' must be str, not %.50s",
+            name, Py_TYPE(value)->tp_name
+        );
+        return -1;
+    }
+
+    result = PyUnicode_AsUTF8AndSize(value, &length);
+    if (result == NULL) return -1;
+
+    if (size != NULL) {
+        *size = length;
+    } else if ((Py_ssize_t) strlen(result) != length) {
+        PyErr_SetString(PyExc_ValueError, "embedded null character");
+        return -1;
+    }
+
+    *target = result;
+    return 0;
+}
+
+static int czint_args_convert(
+    const czint_args_spec *spec, PyObject **values, va_list va
+) {
+    Py_buffer *buffers[CZINT_ARGS_MAX];
+    int nbuffers = 0;
+    Py_ssize_t i = 0;
+    const char *f;
+    long number;
+
+    for (f = spec->format; *f; f++) {
+        char code = *f;
+        int star;
+        PyObject *value;
+        const char *name;
+
+        if (code == '|' || code == '$') continue;
+
+        star = f[1] == '*';
+        if (star) f++;
+
+        value = values[i];
+        name = spec->kwlist[i];
+        i++;
+
+        switch (star ? code | 0x80 : code) {
+            case 'O': {
+                PyObject **target = va_arg(va, PyObject **);
+                if (value != NULL) *target = value;
+                break;
+            }
+            case 'b':
+            case 'i': {
+                int *target = va_arg(va, int *);
+                if (value == NULL) break;
+                if (czint_args_long(
+                    spec, name, value,
+                    code == 'b' ? 0 : INT_MIN,
+                    code == 'b' ? UCHAR_MAX : INT_MAX,
+                    &number
+                )) goto error;
+                *target = (int) number;
+                break;
+            }
+            case 'B': {
+                /* Like PyArg, no overflow checking */
+                int *target = va_arg(va, int *);
+                unsigned long mask;
+                if (value == NULL) break;
+                if (PyFloat_Check(value)) {
+                    PyErr_Format(
+                        PyExc_TypeError,
+                        "%s() argument '%s' must be int, not float",
+                        spec->fname, name
+                    );
+                    goto error;
+                }
+                mask = PyLong_AsUnsignedLongMask(value);
+                if (mask == (unsigned long) -1 && PyErr_Occurred()) goto error;
+                *target = (int) (mask & UCHAR_MAX);
+                break;
+            }
+            case 'n': {
+                Py_ssize_t *target = va_arg(va, Py_ssize_t *);
+                Py_ssize_t result;
+                if (value == NULL) break;
+                result = PyNumber_AsSsize_t(value, PyExc_OverflowError);
+                if (result == -1 && PyErr_Occurred()) goto error;
+                *target = result;
+                break;
+            }
+            case 'f': {
+                float *target = va_arg(va, float *);
+                double result;
+                if (value == NULL) break;
+                result = PyFloat_AsDouble(value);
+                if (result == -1.0 && PyErr_Occurred()) goto error;
+                *target = (float) result;
+                break;
+            }
+            case 'p': {
+                int *target = va_arg(va, int *);
+                int result;
+                if (value == NULL) break;
+                if ((result = PyObject_IsTrue(value)) < 0) goto error;
+                *target = result;
+                break;
+            }
+            case 's':
+            case 'z': {
+                const char **target = va_arg(va, const char **);
+                if (value == NULL) break;
+                if (code == 'z' && value == Py_None) {
+                    *target = NULL;
+                    break;
+                }
+                if (czint_args_str(name, value, target, NULL)) goto error;
+                break;
+            }
+            case 's' | 0x80:
+            case 'z' | 0x80:
+            case 'w' | 0x80: {
+                Py_buffer *target = va_arg(va, Py_buffer *);
+                const char *data;
+                Py_ssize_t size;
+
+                if (value == NULL) break;
+
+                if (code == 'w') {
+                    if (PyObject_GetBuffer(value, target, PyBUF_WRITABLE)) {
+                        PyErr_Clear();
+                        PyErr_Format(
+                            PyExc_TypeError,
+                            "argument '%s' must be read-write bytes-like "
+                            "object, not %.50s",
+                            name, Py_TYPE(value)->tp_name
+                        );
+                        goto error;
+                    }
+                } else if (code == 'z' && value == Py_None) {
+                    PyBuffer_FillInfo(target, NULL, NULL, 0, 1, 0);
+                } else if (PyUnicode_Check(value)) {
+                    if (czint_args_str(name, value, &data, &size)) goto error;
+                    PyBuffer_FillInfo(target, value, (void *) data, size, 1, 0);
+                } else if (PyObject_GetBuffer(value, target, PyBUF_SIMPLE)) {
+                    goto error;
+                }
+
+                buffers[nbuffers++] = target;
+                break;
+            }
+            default:
+                PyErr_Format(
+                    PyExc_SystemError,
+                    "%s() bad format unit '%c'", spec->fname, code
+                );
+                goto error;
+        }
+    }
+
+    return 0;
+
+error:
+    while (nbuffers > 0) PyBuffer_Release(buffers[--nbuffers]);
+    return -1;
+}
+
+int czint_args_parse(
+    const czint_args_spec *spec, PyObject *names,
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames, ...
+) {
+    PyObject *values[CZINT_ARGS_MAX] = {NULL};
+    czint_args_shape shape;
+    Py_ssize_t i, nkw;
+    va_list va;
+    int result;
+
+    czint_args_shape_of(spec, &shape);
+
+    if (czint_args_positional(spec, &shape, nargs)) return -1;
+
+    for (i = 0; i < nargs; i++) values[i] = args[i];
+
+    nkw = kwnames == NULL ? 0 : PyTuple_GET_SIZE(kwnames);
+    for (i = 0; i < nkw; i++) {
+        if (czint_args_keyword(
+            spec, names, shape.count,
+            PyTuple_GET_ITEM(kwnames, i), args[nargs + i], values
+        )) return -1;
+    }
+
+    if (czint_args_required(spec, &shape, values)) return -1;
+
+    va_start(va, kwnames);
+    result = czint_args_convert(spec, values, va);
+    va_end(va);
+    return result;
+}
+
+int czint_args_parse_dict(
+    const czint_args_spec *spec, PyObject *names,
+    PyObject *args, PyObject *kwds, ...
+) {
+    PyObject *values[CZINT_ARGS_MAX] = {NULL};
+    czint_args_shape shape;
+    PyObject *key, *value;
+    Py_ssize_t i, nargs, pos = 0;
+    va_list va;
+    int result;
+
+    czint_args_shape_of(spec, &shape);
+
+    nargs = PyTuple_GET_SIZE(args);
+    if (czint_args_positional(spec, &shape, nargs)) return -1;
+
+    for (i = 0; i < nargs; i++) values[i] = PyTuple_GET_ITEM(args, i);
+
+    while (kwds != NULL && PyDict_Next(kwds, &pos, &key, &value)) {
+        if (czint_args_keyword(
+            spec, names, shape.count, key, value, values
+        )) return -1;
+    }
+
+    if (czint_args_required(spec, &shape, values)) return -1;
+
+    va_start(va, kwds);
+    result = czint_args_convert(spec, values, va);
+    va_end(va);
+    return result;
+}
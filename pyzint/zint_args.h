@@ -0,0 +1,38 @@
+#ifndef _PYZINT_ARGS_H
+#define _PYZINT_ARGS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#define CZINT_ARGS_MAX 16
+
+/* Signature of a vectorcall entry point. format uses subset of
+ * PyArg_ParseTupleAndKeywords units: O b B i n f p s z s* z* w*, with
+ * '|' starting optional and '$' keyword only arguments. Unlike PyArg,
+ * b and B store into int. */
+typedef struct {
+    const char *fname;
+    const char *format;
+    const char *const *kwlist;   /* NULL terminated */
+} czint_args_spec;
+
+/* Tuple of interned keyword names of spec, kept in module state so
+ * keywords of calls from Python code match by identity. */
+PyObject *czint_args_names(const czint_args_spec *spec);
+
+/* Parse vectorcall arguments like PyArg_ParseTupleAndKeywords does,
+ * storing converted values through the trailing pointers. Absent
+ * optional arguments leave their targets untouched.
+ * Returns 0 on success, -1 with exception set. */
+int czint_args_parse(
+    const czint_args_spec *spec, PyObject *names,
+    PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames, ...
+);
+
+/* Same for tuple and dict arguments, used by tp_init */
+int czint_args_parse_dict(
+    const czint_args_spec *spec, PyObject *names,
+    PyObject *args, PyObject *kwds, ...
+);
+
+#endif
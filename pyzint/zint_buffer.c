@@ -0,0 +1,236 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zint_buffer.h"
+
+
+void czint_buffer_init(czint_buffer *buffer) {
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+    buffer->failed = 0;
+    buffer->sink = NULL;
+}
+
+void czint_buffer_init_sink(czint_buffer *buffer, czint_sink *sink) {
+    czint_buffer_init(buffer);
+    buffer->sink = sink;
+}
+
+void czint_buffer_free(czint_buffer *buffer) {
+    free(buffer->data);
+    czint_buffer_init(buffer);
+}
+
+int czint_buffer_flush(czint_buffer *buffer) {
+    czint_stream stream;
+
+    if (buffer->failed) return -1;
+    if (buffer->sink == NULL || buffer->size == 0) return 0;
+
+    czint_stream_init(&stream, buffer->sink);
+    if (czint_stream_add(&stream, buffer->data, buffer->size) ||
+        czint_stream_flush(&stream)) {
+        buffer->failed = 1;
+        return -1;
+    }
+
+    buffer->size = 0;
+    return 0;
+}
+
+int czint_buffer_reserve(czint_buffer *buffer, size_t extra) {
+    size_t capacity;
+    char *data;
+
+    if (buffer->failed) return -1;
+
+    if (buffer->sink != NULL && buffer->size + extra >= CZINT_STREAM_CHUNK) {
+        if (czint_buffer_flush(buffer)) return -1;
+    }
+
+    if (buffer->capacity - buffer->size > extra) return 0;
+
+    capacity = buffer->capacity ? buffer->capacity : CZINT_BUFFER_INITIAL;
+    while (capacity - buffer->size <= extra) {
+        if (capacity > ((size_t) -1) / 2) {
+            buffer->failed = 1;
+            return -1;
+        }
+        capacity *= 2;
+    }
+
+    data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->failed = 1;
+        return -1;
+    }
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+void czint_buffer_write(czint_buffer *buffer, const char *data, size_t length) {
+    if (czint_buffer_reserve(buffer, length)) return;
+
+    memcpy(&buffer->data[buffer->size], data, length);
+    buffer->size += length;
+    buffer->data[buffer->size] = '\0';
+}
+
+void czint_buffer_puts(czint_buffer *buffer, const char *str) {
+    czint_buffer_write(buffer, str, strlen(str));
+}
+
+void czint_buffer_printf(czint_buffer *buffer, const char *format, ...) {
+    va_list args;
+    size_t available;
+    int length;
+
+    /* Most records are short, try to print in place first */
+    if (czint_buffer_reserve(buffer, 128)) return;
+
+    available = buffer->capacity - buffer->size;
+
+    va_start(args, format);
+    length = vsnprintf(&buffer->data[buffer->size], available, format, args);
+    va_end(args);
+
+    if (length < 0) {
+        buffer->failed = 1;
+        return;
+    }
+
+    if ((size_t) length >= available) {
+        if (czint_buffer_reserve(buffer, length)) return;
+
+        va_start(args, format);
+        vsnprintf(&buffer->data[buffer->size], length + 1, format, args);
+        va_end(args);
+    }
+
+    buffer->size += length;
+}
+
+
+static const char czint_digits[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+void czint_buffer_fixed2(czint_buffer *buffer, double value) {
+    char digits[32];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    unsigned long long n;
+    unsigned int pair;
+    double scaled;
+
+    /* Vector coordinates are floats, value * 100 is then exact in
+     * double and rounding it half to even gives same digits as libc.
+     * Anything else goes the slow way. */
+    if (!(fabs(value) < 1e13) || (double) (float) value != value) {
+        czint_buffer_printf(buffer, "%.2f", value);
+        return;
+    }
+
+    scaled = nearbyint(fabs(value) * 100);
+    n = (unsigned long long) scaled;
+
+    pair = (unsigned int) (n % 100);
+    n /= 100;
+    p -= 2;
+    memcpy(p, &czint_digits[pair * 2], 2);
+    *--p = '.';
+
+    while (n >= 100) {
+        pair = (unsigned int) (n % 100);
+        n /= 100;
+        p -= 2;
+        memcpy(p, &czint_digits[pair * 2], 2);
+    }
+    if (n >= 10) {
+        p -= 2;
+        memcpy(p, &czint_digits[n * 2], 2);
+    } else {
+        *--p = (char) ('0' + n);
+    }
+
+    if (signbit(value)) *--p = '-';
+
+    czint_buffer_write(buffer, p, end - p);
+}
+
+void czint_buffer_centi(czint_buffer *buffer, long long n) {
+    char digits[32];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    unsigned long long value = n < 0 ? 0ULL - (unsigned long long) n : (unsigned long long) n;
+    unsigned int fraction = (unsigned int) (value % 100);
+
+    value /= 100;
+
+    if (fraction % 10) {
+        p -= 2;
+        memcpy(p, &czint_digits[fraction * 2], 2);
+        *--p = '.';
+    } else if (fraction) {
+        *--p = (char) ('0' + fraction / 10);
+        *--p = '.';
+    }
+
+    do {
+        *--p = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    if (n < 0) *--p = '-';
+
+    czint_buffer_write(buffer, p, end - p);
+}
+
+void czint_buffer_printf_fast(czint_buffer *buffer, const char *format, ...) {
+    va_list args;
+    const char *start = format;
+
+    va_start(args, format);
+
+    while (*format) {
+        if (*format != '%') {
+            format++;
+            continue;
+        }
+
+        czint_buffer_write(buffer, start, format - start);
+
+        if (strncmp(format, "%.2f", 4) == 0) {
+            czint_buffer_fixed2(buffer, va_arg(args, double));
+            format += 4;
+        } else if (format[1] == 's') {
+            czint_buffer_puts(buffer, va_arg(args, const char *));
+            format += 2;
+        } else if (format[1] == '%') {
+            czint_buffer_write(buffer, "%", 1);
+            format += 2;
+        } else {
+            /* Unsupported conversion, would desync varargs */
+            buffer->failed = 1;
+            break;
+        }
+        start = format;
+    }
+
+    czint_buffer_write(buffer, start, format - start);
+    va_end(args);
+}
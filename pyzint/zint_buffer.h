@@ -0,0 +1,54 @@
+#ifndef _PYZINT_BUFFER_H
+#define _PYZINT_BUFFER_H
+
+#include <stddef.h>
+
+#include "zint_stream.h"
+
+#define CZINT_BUFFER_INITIAL 4096
+
+/* Growable output buffer for serializers. Capacity starts at
+ * CZINT_BUFFER_INITIAL and doubles. When allocation fails further
+ * writes are dropped and `failed` is set, so writers check it once.
+ * With sink set, written data is passed on in CZINT_STREAM_CHUNK
+ * pieces and dropped from buffer, only for writers which never look
+ * back at data. */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+    czint_sink *sink;
+} czint_buffer;
+
+void czint_buffer_init(czint_buffer *buffer);
+void czint_buffer_init_sink(czint_buffer *buffer, czint_sink *sink);
+void czint_buffer_free(czint_buffer *buffer);
+
+/* Pass buffered data to sink. Returns 0 on success. */
+int czint_buffer_flush(czint_buffer *buffer);
+
+/* Make room for at least `extra` more bytes. Returns 0 on success. */
+int czint_buffer_reserve(czint_buffer *buffer, size_t extra);
+
+void czint_buffer_write(czint_buffer *buffer, const char *data, size_t length);
+void czint_buffer_puts(czint_buffer *buffer, const char *str);
+void czint_buffer_printf(czint_buffer *buffer, const char *format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+;
+
+/* Append value formatted exactly like printf("%.2f", value) */
+void czint_buffer_fixed2(czint_buffer *buffer, double value);
+
+/* Append n / 100 with trailing fractional zeros trimmed, "150" gives
+ * "1.5" and "-200" gives "-2" */
+void czint_buffer_centi(czint_buffer *buffer, long long n);
+
+/* Subset of czint_buffer_printf for vector writers, format may only
+ * contain "%.2f" (double), "%s" and "%%" conversions. Numbers go
+ * through czint_buffer_fixed2 instead of libc. */
+void czint_buffer_printf_fast(czint_buffer *buffer, const char *format, ...);
+
+#endif
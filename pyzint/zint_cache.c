@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "zint_cache.h"
+
+
+int czint_cache_init(czint_cache *cache, czint_cache_free free_value) {
+    memset(cache, 0, sizeof(czint_cache));
+
+    cache->buckets = calloc(CZINT_CACHE_BUCKETS_MIN, sizeof(czint_cache_entry *));
+    if (cache->buckets == NULL) return -1;
+
+    if (pthread_mutex_init(&cache->lock, NULL) != 0) {
+        free(cache->buckets);
+        cache->buckets = NULL;
+        return -1;
+    }
+
+    cache->bucket_count = CZINT_CACHE_BUCKETS_MIN;
+    cache->free_value = free_value;
+    return 0;
+}
+
+void czint_cache_destroy(czint_cache *cache) {
+    if (cache->buckets == NULL) return;
+
+    czint_cache_clear(cache);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->buckets);
+    cache->buckets = NULL;
+}
+
+/* FNV-1a */
+uint64_t czint_cache_hash(const void *key, size_t size) {
+    const unsigned char *bytes = key;
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+int czint_cache_enabled(czint_cache *cache) {
+    return __atomic_load_n(&cache->stats.limit, __ATOMIC_RELAXED) > 0;
+}
+
+static void czint_cache_free_entries(czint_cache *cache, czint_cache_entry *dead) {
+    while (dead != NULL) {
+        czint_cache_entry *next = dead->next;
+
+        cache->free_value(dead->value);
+        free(dead);
+        dead = next;
+    }
+}
+
+static czint_cache_entry **czint_cache_slot(
+    czint_cache *cache, const void *key, size_t key_size, uint64_t hash
+) {
+    czint_cache_entry **slot = &cache->buckets[hash & (cache->bucket_count - 1)];
+
+    for (; *slot != NULL; slot = &(*slot)->next) {
+        czint_cache_entry *entry = *slot;
+
+        if (
+            entry->hash == hash && entry->key_size == key_size &&
+            memcmp(entry->key, key, key_size) == 0
+        ) break;
+    }
+    return slot;
+}
+
+static void czint_cache_lru_remove(czint_cache *cache, czint_cache_entry *entry) {
+    if (entry->newer != NULL) entry->newer->older = entry->older;
+    else cache->newest = entry->older;
+
+    if (entry->older != NULL) entry->older->newer = entry->newer;
+    else cache->oldest = entry->newer;
+
+    entry->newer = entry->older = NULL;
+}
+
+static void czint_cache_lru_push(czint_cache *cache, czint_cache_entry *entry) {
+    entry->older = cache->newest;
+    entry->newer = NULL;
+
+    if (cache->newest != NULL) cache->newest->newer = entry;
+    else cache->oldest = entry;
+    cache->newest = entry;
+}
+
+/* Take entry out of cache, it joins dead list once unborrowed */
+static void czint_cache_unlink(
+    czint_cache *cache, czint_cache_entry *entry, czint_cache_entry **dead
+) {
+    czint_cache_entry **slot = czint_cache_slot(
+        cache, entry->key, entry->key_size, entry->hash
+    );
+
+    *slot = entry->next;
+    czint_cache_lru_remove(cache, entry);
+
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->charge;
+
+    if (--entry->refs == 0) {
+        entry->next = *dead;
+        *dead = entry;
+    } else {
+        entry->next = NULL;
+    }
+}
+
+static void czint_cache_evict(czint_cache *cache, czint_cache_entry **dead) {
+    while (cache->stats.bytes > cache->stats.limit && cache->oldest != NULL) {
+        czint_cache_unlink(cache, cache->oldest, dead);
+        cache->stats.evictions++;
+    }
+}
+
+/* Double buckets once there are more entries than buckets, cache keeps
+ * working with the old table when out of memory */
+static void czint_cache_grow(czint_cache *cache) {
+    size_t count = cache->bucket_count * 2;
+    czint_cache_entry **buckets;
+
+    if (cache->stats.entries < cache->bucket_count) return;
+
+    buckets = calloc(count, sizeof(czint_cache_entry *));
+    if (buckets == NULL) return;
+
+    for (size_t i = 0; i < cache->bucket_count; i++) {
+        czint_cache_entry *entry = cache->buckets[i];
+
+        while (entry != NULL) {
+            czint_cache_entry *next = entry->next;
+            czint_cache_entry **slot = &buckets[entry->hash & (count - 1)];
+
+            entry->next = *slot;
+            *slot = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = count;
+}
+
+czint_cache_entry *czint_cache_get(
+    czint_cache *cache, const void *key, size_t key_size, uint64_t hash
+) {
+    czint_cache_entry *entry;
+
+    pthread_mutex_lock(&cache->lock);
+
+    if (cache->stats.limit == 0) {
+        pthread_mutex_unlock(&cache->lock);
+        return NULL;
+    }
+
+    entry = *czint_cache_slot(cache, key, key_size, hash);
+    if (entry != NULL) {
+        czint_cache_lru_remove(cache, entry);
+        czint_cache_lru_push(cache, entry);
+        entry->refs++;
+        cache->stats.hits++;
+    } else {
+        cache->stats.misses++;
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+    return entry;
+}
+
+void czint_cache_release(czint_cache *cache, czint_cache_entry *entry) {
+    int dead;
+
+    pthread_mutex_lock(&cache->lock);
+    dead = --entry->refs == 0;
+    pthread_mutex_unlock(&cache->lock);
+
+    if (dead) {
+        entry->next = NULL;
+        czint_cache_free_entries(cache, entry);
+    }
+}
+
+int czint_cache_put(
+    czint_cache *cache, const void *key, size_t key_size, uint64_t hash,
+    void *value, size_t size
+) {
+    size_t charge = sizeof(czint_cache_entry) + key_size + size;
+    czint_cache_entry *entry, *old, **slot, *dead = NULL;
+
+    if (charge > __atomic_load_n(&cache->stats.limit, __ATOMIC_RELAXED)) return 1;
+
+    entry = malloc(sizeof(czint_cache_entry) + key_size);
+    if (entry == NULL) return -1;
+
+    entry->hash = hash;
+    entry->charge = charge;
+    entry->refs = 1;
+    entry->value = value;
+    entry->key_size = key_size;
+    memcpy(entry->key, key, key_size);
+
+    pthread_mutex_lock(&cache->lock);
+
+    /* Limit may have shrunk meanwhile */
+    if (charge > cache->stats.limit) {
+        pthread_mutex_unlock(&cache->lock);
+        free(entry);
+        return 1;
+    }
+
+    old = *czint_cache_slot(cache, key, key_size, hash);
+    if (old != NULL) czint_cache_unlink(cache, old, &dead);
+
+    czint_cache_grow(cache);
+
+    slot = &cache->buckets[hash & (cache->bucket_count - 1)];
+    entry->next = *slot;
+    *slot = entry;
+    czint_cache_lru_push(cache, entry);
+
+    cache->stats.entries++;
+    cache->stats.bytes += charge;
+    cache->stats.insertions++;
+
+    czint_cache_evict(cache, &dead);
+
+    pthread_mutex_unlock(&cache->lock);
+
+    czint_cache_free_entries(cache, dead);
+    return 0;
+}
+
+void czint_cache_set_limit(czint_cache *cache, size_t limit) {
+    czint_cache_entry *dead = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+    __atomic_store_n(&cache->stats.limit, limit, __ATOMIC_RELAXED);
+    czint_cache_evict(cache, &dead);
+    pthread_mutex_unlock(&cache->lock);
+
+    czint_cache_free_entries(cache, dead);
+}
+
+void czint_cache_clear(czint_cache *cache) {
+    czint_cache_entry *dead = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+    while (cache->oldest != NULL) {
+        czint_cache_unlink(cache, cache->oldest, &dead);
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    czint_cache_free_entries(cache, dead);
+}
+
+void czint_cache_stats_get(czint_cache *cache, czint_cache_stats *stats) {
+    pthread_mutex_lock(&cache->lock);
+    memcpy(stats, &cache->stats, sizeof(czint_cache_stats));
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,82 @@
+#ifndef _PYZINT_CACHE_H
+#define _PYZINT_CACHE_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CZINT_CACHE_BUCKETS_MIN 64
+
+/* Drops reference cache holds on a value */
+typedef void (*czint_cache_free)(void *value);
+
+typedef struct czint_cache_entry {
+    struct czint_cache_entry *next;     /* bucket chain */
+    struct czint_cache_entry *newer;    /* LRU list */
+    struct czint_cache_entry *older;
+    uint64_t hash;
+    size_t charge;          /* bytes counted against limit */
+    unsigned int refs;      /* cache link plus borrowers */
+    void *value;
+    size_t key_size;
+    unsigned char key[];
+} czint_cache_entry;
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long insertions;
+    unsigned long long evictions;
+    size_t entries;
+    size_t bytes;
+    size_t limit;
+} czint_cache_stats;
+
+/* Byte size bounded LRU map of opaque keys to values. Every function
+ * takes the cache mutex only, lookups may run on any thread. Values
+ * are freed by the thread dropping their last reference: put, evict,
+ * clear, set_limit or release. */
+typedef struct {
+    pthread_mutex_t lock;
+    czint_cache_entry **buckets;
+    size_t bucket_count;
+    czint_cache_entry *newest;
+    czint_cache_entry *oldest;
+    czint_cache_free free_value;
+    czint_cache_stats stats;
+} czint_cache;
+
+/* Empty cache with limit 0, which keeps nothing. Returns -1 when out
+ * of memory. */
+int czint_cache_init(czint_cache *cache, czint_cache_free free_value);
+void czint_cache_destroy(czint_cache *cache);
+
+uint64_t czint_cache_hash(const void *key, size_t size);
+
+/* Whether limit allows anything to be kept, racy hint for callers
+ * deciding to build a key at all */
+int czint_cache_enabled(czint_cache *cache);
+
+/* Borrow entry of key and mark it most recently used, NULL on miss.
+ * Entry and its value stay valid until czint_cache_release. */
+czint_cache_entry *czint_cache_get(
+    czint_cache *cache, const void *key, size_t key_size, uint64_t hash
+);
+void czint_cache_release(czint_cache *cache, czint_cache_entry *entry);
+
+/* Store value of size bytes under key, replacing older one and
+ * evicting least recently used entries over limit. Cache takes over
+ * the reference on 0, otherwise value is left to caller: 1 when it
+ * does not fit into limit, -1 when out of memory. */
+int czint_cache_put(
+    czint_cache *cache, const void *key, size_t key_size, uint64_t hash,
+    void *value, size_t size
+);
+
+/* New limit in bytes, 0 drops everything and disables cache */
+void czint_cache_set_limit(czint_cache *cache, size_t limit);
+void czint_cache_clear(czint_cache *cache);
+
+void czint_cache_stats_get(czint_cache *cache, czint_cache_stats *stats);
+
+#endif
@@ -0,0 +1,288 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "zint_label.h"
+
+
+static const char czint_label_hex[] = "0123456789ABCDEF";
+
+static const char czint_label_base64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void czint_zpl_options_init(czint_zpl_options *options) {
+    options->compression = CZINT_ZPL_Z64;
+    options->label = 0;
+}
+
+int czint_zpl_compression(const char *name) {
+    static const char *names[] = {"hex", "acs", "b64", "z64"};
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) return (int) i;
+    }
+    return -1;
+}
+
+/* Printers set a bit for every dot to print, which is foreground,
+ * stored as 0 in source rows */
+static void czint_label_row(
+    const unsigned char *src, size_t used, unsigned int width,
+    unsigned char *dst
+) {
+    for (size_t i = 0; i < used; i++) dst[i] = (unsigned char) ~src[i];
+    if (width % 8) dst[used - 1] &= (unsigned char) (0xFF << (8 - width % 8));
+}
+
+static void czint_zpl_hex(czint_buffer *out, const unsigned char *line, size_t used) {
+    char *target;
+
+    if (czint_buffer_reserve(out, used * 2)) return;
+
+    target = &out->data[out->size];
+    for (size_t i = 0; i < used; i++) {
+        *target++ = czint_label_hex[line[i] >> 4];
+        *target++ = czint_label_hex[line[i] & 0x0F];
+    }
+    out->size += used * 2;
+}
+
+/* Run of count equal hex digits, G..Y repeat 1..19 times and g..z
+ * 20..400 times, letters add up */
+static void czint_zpl_run(czint_buffer *out, char digit, size_t count) {
+    char code;
+
+    if (count <= 2) {
+        char pair[2] = {digit, digit};
+        czint_buffer_write(out, pair, count);
+        return;
+    }
+
+    while (count >= 20) {
+        size_t twenties = count / 20 > 20 ? 20 : count / 20;
+
+        code = (char) ('f' + twenties);
+        czint_buffer_write(out, &code, 1);
+        count -= twenties * 20;
+    }
+    if (count > 0) {
+        code = (char) ('F' + count);
+        czint_buffer_write(out, &code, 1);
+    }
+    czint_buffer_write(out, &digit, 1);
+}
+
+/* One row in ZPL ASCII compression: ':' repeats previous row, ',' and
+ * '!' fill the rest of the row with 0 and F */
+static void czint_zpl_acs(
+    czint_buffer *out, const unsigned char *line, const unsigned char *previous,
+    size_t used, char *hex
+) {
+    size_t length = used * 2, end, start;
+
+    if (previous != NULL && memcmp(line, previous, used) == 0) {
+        czint_buffer_write(out, ":", 1);
+        return;
+    }
+
+    for (size_t i = 0; i < used; i++) {
+        hex[i * 2] = czint_label_hex[line[i] >> 4];
+        hex[i * 2 + 1] = czint_label_hex[line[i] & 0x0F];
+    }
+
+    for (end = length; end > 0 && hex[end - 1] == '0'; end--);
+    if (end == length) {
+        for (; end > 0 && hex[end - 1] == 'F'; end--);
+    }
+
+    for (start = 0; start < end;) {
+        size_t stop = start + 1;
+
+        while (stop < end && hex[stop] == hex[start]) stop++;
+        czint_zpl_run(out, hex[start], stop - start);
+        start = stop;
+    }
+
+    if (end < length) {
+        czint_buffer_write(out, hex[end] == '0' ? "," : "!", 1);
+    }
+}
+
+static void czint_label_base64_write(
+    czint_buffer *out, const unsigned char *data, size_t size
+) {
+    char *target;
+    size_t i;
+
+    if (czint_buffer_reserve(out, (size + 2) / 3 * 4)) return;
+
+    target = &out->data[out->size];
+    for (i = 0; i + 2 < size; i += 3) {
+        uint32_t value = (uint32_t) data[i] << 16 |
+            (uint32_t) data[i + 1] << 8 | data[i + 2];
+
+        *target++ = czint_label_base64[value >> 18];
+        *target++ = czint_label_base64[(value >> 12) & 0x3F];
+        *target++ = czint_label_base64[(value >> 6) & 0x3F];
+        *target++ = czint_label_base64[value & 0x3F];
+    }
+
+    if (i < size) {
+        uint32_t value = (uint32_t) data[i] << 16;
+
+        if (i + 1 < size) value |= (uint32_t) data[i + 1] << 8;
+
+        *target++ = czint_label_base64[value >> 18];
+        *target++ = czint_label_base64[(value >> 12) & 0x3F];
+        *target++ = i + 1 < size ? czint_label_base64[(value >> 6) & 0x3F] : '=';
+        *target++ = '=';
+    }
+
+    out->size = target - out->data;
+}
+
+/* CRC-16/XMODEM (CCITT polynomial, zero init) of base64 text */
+static unsigned int czint_zpl_crc(const char *data, size_t size) {
+    unsigned int crc = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        crc ^= (unsigned int) (unsigned char) data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc & 0xFFFF;
+}
+
+static int czint_zpl_base64(
+    czint_buffer *out, const unsigned char *raw, size_t total, int compress
+) {
+    unsigned char *packed = NULL;
+    const unsigned char *data = raw;
+    size_t size = total, start;
+
+    if (compress) {
+        uLongf length = compressBound((uLong) total);
+
+        packed = malloc(length);
+        if (packed == NULL) return -1;
+
+        if (compress2(
+            packed, &length, raw, (uLong) total, Z_DEFAULT_COMPRESSION
+        ) != Z_OK) {
+            free(packed);
+            return -1;
+        }
+        data = packed;
+        size = length;
+    }
+
+    czint_buffer_puts(out, compress ? ":Z64:" : ":B64:");
+    start = out->size;
+    czint_label_base64_write(out, data, size);
+    free(packed);
+
+    if (out->failed) return -1;
+
+    czint_buffer_printf(
+        out, ":%04X", czint_zpl_crc(&out->data[start], out->size - start)
+    );
+    return 0;
+}
+
+int czint_zpl_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height,
+    const czint_zpl_options *options
+) {
+    size_t used = (width + 7) / 8, total = used * height;
+    unsigned char *raw, *line;
+    char *hex = NULL;
+    int res = 0;
+
+    /* Whole field for base64 forms, current and previous row otherwise */
+    raw = malloc(options->compression >= CZINT_ZPL_B64 ? total + 1 : used * 2 + 1);
+    if (raw == NULL) return -1;
+
+    if (options->compression == CZINT_ZPL_ACS) {
+        hex = malloc(used * 2 + 1);
+        if (hex == NULL) {
+            free(raw);
+            return -1;
+        }
+    }
+
+    if (options->label) czint_buffer_puts(out, "^XA^FO0,0");
+    czint_buffer_printf(out, "^GFA,%zu,%zu,%zu,", total, total, used);
+
+    for (unsigned int y = 0; y < height; y++) {
+        const unsigned char *src = rows + (ptrdiff_t) y * step;
+
+        switch (options->compression) {
+            case CZINT_ZPL_HEX:
+                czint_label_row(src, used, width, raw);
+                czint_zpl_hex(out, raw, used);
+                break;
+            case CZINT_ZPL_ACS:
+                line = &raw[(y % 2) * used];
+                czint_label_row(src, used, width, line);
+                czint_zpl_acs(
+                    out, line, y ? &raw[((y + 1) % 2) * used] : NULL, used, hex
+                );
+                break;
+            default:
+                czint_label_row(src, used, width, &raw[y * used]);
+                break;
+        }
+    }
+
+    if (options->compression >= CZINT_ZPL_B64) {
+        res = czint_zpl_base64(
+            out, raw, total, options->compression == CZINT_ZPL_Z64
+        );
+    }
+
+    czint_buffer_puts(out, "^FS");
+    if (options->label) czint_buffer_puts(out, "^XZ\n");
+
+    free(hex);
+    free(raw);
+    return res || out->failed ? -1 : 0;
+}
+
+int czint_escpos_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height
+) {
+    size_t used = (width + 7) / 8;
+
+    /* GS v 0 m xL xH yL yH, normal density */
+    for (unsigned int top = 0; top < height; top += CZINT_ESCPOS_BAND_MAX) {
+        unsigned int band = height - top;
+        unsigned char header[8] = {0x1D, 0x76, 0x30, 0x00};
+
+        if (band > CZINT_ESCPOS_BAND_MAX) band = CZINT_ESCPOS_BAND_MAX;
+
+        header[4] = (unsigned char) (used & 0xFF);
+        header[5] = (unsigned char) (used >> 8);
+        header[6] = (unsigned char) (band & 0xFF);
+        header[7] = (unsigned char) (band >> 8);
+        czint_buffer_write(out, (const char *) header, sizeof(header));
+
+        if (czint_buffer_reserve(out, used * band)) return -1;
+
+        for (unsigned int y = top; y < top + band; y++) {
+            czint_label_row(
+                rows + (ptrdiff_t) y * step, used, width,
+                (unsigned char *) &out->data[out->size]
+            );
+            out->size += used;
+        }
+    }
+
+    return out->failed ? -1 : 0;
+}
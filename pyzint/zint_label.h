@@ -0,0 +1,45 @@
+#ifndef _PYZINT_LABEL_H
+#define _PYZINT_LABEL_H
+
+#include <stddef.h>
+
+#include "zint_buffer.h"
+
+/* Data forms of ZPL ^GFA graphic field */
+#define CZINT_ZPL_HEX 0     /* plain ASCII hex */
+#define CZINT_ZPL_ACS 1     /* ASCII hex with ZPL run length compression */
+#define CZINT_ZPL_B64 2     /* :B64:base64:crc */
+#define CZINT_ZPL_Z64 3     /* :Z64:base64 of zlib stream:crc */
+
+/* ESC/POS GS v 0 takes at most this many rows, taller images are
+ * written as several commands */
+#define CZINT_ESCPOS_BAND_MAX 2303
+
+typedef struct {
+    int compression;    /* CZINT_ZPL_* */
+    int label;          /* wrap field into ^XA^FO0,0 ... ^XZ */
+} czint_zpl_options;
+
+void czint_zpl_options_init(czint_zpl_options *options);
+
+/* ZPL compression by name ("hex", "acs", "b64", "z64"), -1 if unknown */
+int czint_zpl_compression(const char *name);
+
+/* Printer graphics from packed rows laid out like czint_png_write
+ * takes them: most significant bit first, bit 0 is foreground and is
+ * printed, row i starts at rows + i * step, unused bits of last byte
+ * are zero. Return 0 on success, -1 when out of memory. */
+int czint_zpl_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height,
+    const czint_zpl_options *options
+);
+
+int czint_escpos_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height
+);
+
+#endif
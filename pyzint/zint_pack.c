@@ -0,0 +1,137 @@
+#include <stdint.h>
+
+#include "zint_pack.h"
+
+#ifdef CZINT_PACK_X86
+#include <immintrin.h>
+#endif
+
+
+/* Bit order reversal, kernels collect pixels LSB first */
+static const unsigned char czint_reverse_bits[256] = {
+#define R2(n) n, n + 2*64, n + 1*64, n + 3*64
+#define R4(n) R2(n), R2(n + 2*16), R2(n + 1*16), R2(n + 3*16)
+#define R6(n) R4(n), R4(n + 2*4 ), R4(n + 1*4 ), R4(n + 3*4 )
+    R6(0), R6(2), R6(1), R6(3)
+#undef R6
+#undef R4
+#undef R2
+};
+
+static inline void czint_pack_tail(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+) {
+    unsigned int x, i;
+    unsigned char value;
+
+    for (x = 0; x + 8 <= width; x += 8, rgb += 24) {
+        *out++ = (unsigned char)(
+            ((rgb[0] != 0) << 7) | ((rgb[3] != 0) << 6) |
+            ((rgb[6] != 0) << 5) | ((rgb[9] != 0) << 4) |
+            ((rgb[12] != 0) << 3) | ((rgb[15] != 0) << 2) |
+            ((rgb[18] != 0) << 1) | (rgb[21] != 0)
+        );
+    }
+
+    if (x < width) {
+        value = 0;
+        for (i = 0; x < width; x++, i++, rgb += 3) {
+            value |= (rgb[0] != 0) << (7 - i);
+        }
+        *out = value;
+    }
+}
+
+void czint_pack_row_scalar(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+) {
+    czint_pack_tail(rgb, width, out);
+}
+
+#ifdef CZINT_PACK_X86
+
+/* Gather bits 0, 3, 6, ... 45 of 48bit mask into low 16 bits */
+static inline uint32_t czint_compress3(uint64_t x) {
+    x &= 0x249249249249ULL;
+    x = (x | (x >> 2)) & 0x0C30C30C30C3ULL;
+    x = (x | (x >> 4)) & 0x00F00F00F00FULL;
+    x = (x | (x >> 8)) & 0x0000FF0000FFULL;
+    x = (x | (x >> 16)) & 0xFFFFULL;
+    return (uint32_t) x;
+}
+
+__attribute__((target("sse2")))
+void czint_pack_row_sse2(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+) {
+    const __m128i zero = _mm_setzero_si128();
+    unsigned int x = 0;
+    uint64_t mask;
+    uint32_t bits;
+
+    /* 16 pixels, 48 bytes per step */
+    for (; x + 16 <= width; x += 16, rgb += 48, out += 2) {
+        uint64_t a = ~_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *) rgb), zero
+        )) & 0xFFFF;
+        uint64_t b = ~_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *) (rgb + 16)), zero
+        )) & 0xFFFF;
+        uint64_t c = ~_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *) (rgb + 32)), zero
+        )) & 0xFFFF;
+
+        mask = a | (b << 16) | (c << 32);
+        bits = czint_compress3(mask);
+        out[0] = czint_reverse_bits[bits & 0xFF];
+        out[1] = czint_reverse_bits[bits >> 8];
+    }
+
+    czint_pack_tail(rgb, width - x, out);
+}
+
+__attribute__((target("avx2")))
+void czint_pack_row_avx2(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+) {
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned int x = 0;
+    uint32_t lo, hi;
+
+    /* 32 pixels, 96 bytes per step */
+    for (; x + 32 <= width; x += 32, rgb += 96, out += 4) {
+        uint64_t a = (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) rgb), zero
+        ));
+        uint64_t b = (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (rgb + 32)), zero
+        ));
+        uint64_t c = (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (rgb + 64)), zero
+        ));
+
+        lo = czint_compress3(a | ((b & 0xFFFF) << 32));
+        hi = czint_compress3((b >> 16) | (c << 16));
+        out[0] = czint_reverse_bits[lo & 0xFF];
+        out[1] = czint_reverse_bits[lo >> 8];
+        out[2] = czint_reverse_bits[hi & 0xFF];
+        out[3] = czint_reverse_bits[hi >> 8];
+    }
+
+    czint_pack_row_sse2(rgb, width - x, out);
+}
+
+czint_pack_fn czint_pack_select(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return czint_pack_row_avx2;
+    if (__builtin_cpu_supports("sse2")) return czint_pack_row_sse2;
+    return czint_pack_row_scalar;
+}
+
+#else
+
+czint_pack_fn czint_pack_select(void) {
+    return czint_pack_row_scalar;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef _PYZINT_PACK_H
+#define _PYZINT_PACK_H
+
+/* Pack one row of 24bit zint bitmap into 1bit pixels, most significant
+ * bit first. Pixel bit is set when its red channel is non zero. Reads
+ * exactly width * 3 bytes, writes (width + 7) / 8 bytes, unused bits of
+ * the last byte are cleared. */
+typedef void (*czint_pack_fn)(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+);
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define CZINT_PACK_X86 1
+#endif
+
+void czint_pack_row_scalar(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+);
+
+#ifdef CZINT_PACK_X86
+void czint_pack_row_sse2(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+);
+void czint_pack_row_avx2(
+    const unsigned char *rgb, unsigned int width, unsigned char *out
+);
+#endif
+
+/* Fastest kernel supported by running CPU */
+czint_pack_fn czint_pack_select(void);
+
+#endif
@@ -0,0 +1,130 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zint_phases.h"
+#include "zint_symbols.h"
+
+
+double czint_phases_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Keep output of the last run only */
+static void czint_phases_keep(czint_result *target, czint_result *result) {
+    free(target->data);
+    *target = *result;
+}
+
+static int czint_phases_once(
+    const struct zint_symbol *template,
+    const unsigned char *data, int length,
+    const czint_render_options *options, czint_phases *phases
+) {
+    struct zint_symbol *symbol, *raster = NULL, *vector = NULL, *failed;
+    czint_result bmp = {0}, svg = {0};
+    double started;
+    int res;
+
+    symbol = czint_symbol_acquire_copy(template);
+    if (symbol == NULL) {
+        czint_result_error(&phases->bmp_out, "Insufficient memory");
+        return ZINT_ERROR_MEMORY;
+    }
+    failed = symbol;
+
+    started = czint_phases_now();
+    res = ZBarcode_Encode(symbol, (unsigned char *) data, length);
+    phases->encode += czint_phases_now() - started;
+    if (res) goto exit;
+
+    raster = czint_symbol_acquire_copy(symbol);
+    vector = czint_symbol_acquire_copy(symbol);
+    if (raster == NULL || vector == NULL) {
+        res = czint_symbol_oom(symbol);
+        goto exit;
+    }
+
+    /* Direct drawing has no raster stage, all of it counts as pack */
+    started = czint_phases_now();
+    res = options->direct ? czint_make_bmp_direct(
+        raster, options->angle, options->fgcolor, options->bgcolor, &bmp
+    ) : 1;
+
+    if (res == 1) {
+        res = ZBarcode_Buffer(raster, options->angle);
+        phases->buffer += czint_phases_now() - started;
+        if (res) {
+            failed = raster;
+            goto exit;
+        }
+
+        started = czint_phases_now();
+        res = czint_make_bmp(raster, options->fgcolor, options->bgcolor, &bmp);
+    }
+    phases->pack += czint_phases_now() - started;
+    if (res) {
+        res = czint_symbol_oom(symbol);
+        goto exit;
+    }
+
+    memcpy(vector->fgcolour, options->fgcolour, sizeof(options->fgcolour));
+    memcpy(vector->bgcolour, options->bgcolour, sizeof(options->bgcolour));
+
+    started = czint_phases_now();
+    res = ZBarcode_Buffer_Vector(vector, options->angle);
+    phases->vector += czint_phases_now() - started;
+    if (res) {
+        failed = vector;
+        goto exit;
+    }
+
+    started = czint_phases_now();
+    if (czint_make_svg(vector, options->compact, &svg)) {
+        res = czint_symbol_oom(symbol);
+    }
+    phases->svg += czint_phases_now() - started;
+
+exit:
+    if (res) {
+        free(bmp.data);
+        free(svg.data);
+        czint_result_set(&phases->bmp_out, failed, res);
+    } else {
+        czint_phases_keep(&phases->bmp_out, &bmp);
+        czint_phases_keep(&phases->svg_out, &svg);
+    }
+
+    if (raster != NULL) czint_symbol_release(raster);
+    if (vector != NULL) czint_symbol_release(vector);
+    czint_symbol_release(symbol);
+    return res;
+}
+
+int czint_phases_run(
+    const struct zint_symbol *template,
+    const unsigned char *data, int length,
+    const czint_render_options *options, unsigned int number,
+    czint_phases *phases
+) {
+    int res;
+
+    memset(phases, 0, sizeof(*phases));
+
+    for (phases->runs = 0; phases->runs < number; phases->runs++) {
+        res = czint_phases_once(template, data, length, options, phases);
+        if (res) return res;
+    }
+
+    return 0;
+}
+
+void czint_phases_free(czint_phases *phases) {
+    free(phases->bmp_out.data);
+    free(phases->svg_out.data);
+    phases->bmp_out.data = NULL;
+    phases->svg_out.data = NULL;
+}
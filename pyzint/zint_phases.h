@@ -0,0 +1,34 @@
+#ifndef _PYZINT_PHASES_H
+#define _PYZINT_PHASES_H
+
+#include "zint_render.h"
+
+/* Seconds spent in every native render phase, summed over all runs */
+typedef struct {
+    double encode;      /* ZBarcode_Encode */
+    double buffer;      /* ZBarcode_Buffer, zero when drawn directly */
+    double pack;        /* 1bit bmp from raster or module matrix */
+    double vector;      /* ZBarcode_Buffer_Vector */
+    double svg;         /* svg serialization */
+    unsigned int runs;
+    czint_result bmp_out;   /* output of the last run */
+    czint_result svg_out;
+} czint_phases;
+
+/* Monotonic clock in seconds */
+double czint_phases_now(void);
+
+/* Encode data with settings of template and render it into bmp and svg
+ * `number` times, timing every phase separately. Template is not
+ * modified. Returns zint error code of the first failed phase, then
+ * bmp_out holds the error. Called without GIL. */
+int czint_phases_run(
+    const struct zint_symbol *template,
+    const unsigned char *data, int length,
+    const czint_render_options *options, unsigned int number,
+    czint_phases *phases
+);
+
+void czint_phases_free(czint_phases *phases);
+
+#endif
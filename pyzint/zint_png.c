@@ -0,0 +1,224 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "zint_png.h"
+
+
+static const unsigned char czint_png_signature[8] = {
+    0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'
+};
+
+void czint_png_options_init(czint_png_options *options) {
+    options->level = 6;
+    options->strategy = Z_DEFAULT_STRATEGY;
+    options->filter = CZINT_PNG_FILTER_NONE;
+}
+
+int czint_png_strategy(const char *name) {
+    static const struct { const char *name; int value; } strategies[] = {
+        {"default", Z_DEFAULT_STRATEGY},
+        {"filtered", Z_FILTERED},
+        {"huffman", Z_HUFFMAN_ONLY},
+        {"rle", Z_RLE},
+        {"fixed", Z_FIXED},
+    };
+
+    for (size_t i = 0; i < sizeof(strategies) / sizeof(strategies[0]); i++) {
+        if (strcmp(name, strategies[i].name) == 0) return strategies[i].value;
+    }
+    return -1;
+}
+
+int czint_png_filter_type(const char *name) {
+    static const char *filters[] = {"none", "sub", "up", "average", "paeth"};
+
+    for (size_t i = 0; i < sizeof(filters) / sizeof(filters[0]); i++) {
+        if (strcmp(name, filters[i]) == 0) return (int) i;
+    }
+    return -1;
+}
+
+static void czint_png_be32(unsigned char *target, uint32_t value) {
+    target[0] = (unsigned char) (value >> 24);
+    target[1] = (unsigned char) (value >> 16);
+    target[2] = (unsigned char) (value >> 8);
+    target[3] = (unsigned char) value;
+}
+
+/* Chunk with payload already written at out->data[start + 8 ...] */
+static void czint_png_chunk_end(czint_buffer *out, size_t start) {
+    unsigned char crc[4];
+    size_t length = out->size - start - 8;
+
+    if (out->failed) return;
+
+    czint_png_be32((unsigned char *) &out->data[start], (uint32_t) length);
+    czint_png_be32(crc, (uint32_t) crc32(
+        0, (const Bytef *) &out->data[start + 4], (uInt) (length + 4)
+    ));
+    czint_buffer_write(out, (const char *) crc, 4);
+}
+
+static size_t czint_png_chunk_begin(czint_buffer *out, const char *type) {
+    size_t start = out->size;
+
+    czint_buffer_write(out, "\0\0\0\0", 4);
+    czint_buffer_write(out, type, 4);
+    return start;
+}
+
+static unsigned char czint_png_paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc) return (unsigned char) a;
+    if (pb <= pc) return (unsigned char) b;
+    return (unsigned char) c;
+}
+
+/* Filter one row into target[1 ...], target[0] is filter type. Bit
+ * depth below 8 means previous pixel is previous byte. */
+static void czint_png_filter(
+    unsigned char *target, const unsigned char *row,
+    const unsigned char *prior, size_t length, int filter
+) {
+    size_t i;
+
+    target[0] = (unsigned char) filter;
+    target++;
+
+    switch (filter) {
+        case CZINT_PNG_FILTER_SUB:
+            target[0] = row[0];
+            for (i = 1; i < length; i++) target[i] = row[i] - row[i - 1];
+            break;
+        case CZINT_PNG_FILTER_UP:
+            for (i = 0; i < length; i++) target[i] = row[i] - prior[i];
+            break;
+        case CZINT_PNG_FILTER_AVERAGE:
+            target[0] = row[0] - (prior[0] >> 1);
+            for (i = 1; i < length; i++) {
+                target[i] = row[i] - ((row[i - 1] + prior[i]) >> 1);
+            }
+            break;
+        case CZINT_PNG_FILTER_PAETH:
+            target[0] = row[0] - czint_png_paeth(0, prior[0], 0);
+            for (i = 1; i < length; i++) {
+                target[i] = row[i] - czint_png_paeth(
+                    row[i - 1], prior[i], prior[i - 1]
+                );
+            }
+            break;
+        default:
+            memcpy(target, row, length);
+            break;
+    }
+}
+
+static int czint_png_deflate(
+    czint_buffer *out, z_stream *stream, int flush
+) {
+    int res;
+
+    do {
+        if (czint_buffer_reserve(out, 16384)) return -1;
+
+        stream->next_out = (Bytef *) &out->data[out->size];
+        stream->avail_out = (uInt) (out->capacity - out->size - 1);
+
+        res = deflate(stream, flush);
+        if (res == Z_STREAM_ERROR) return -1;
+
+        out->size = out->capacity - 1 - stream->avail_out;
+    } while (
+        stream->avail_out == 0 || (flush == Z_FINISH && res != Z_STREAM_END)
+    );
+
+    return 0;
+}
+
+int czint_png_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    const czint_png_options *options
+) {
+    const size_t length = (width + 7) / 8;
+    unsigned char header[13];
+    unsigned char palette[6];
+    unsigned char *line = NULL, *zero = NULL;
+    const unsigned char *prior;
+    z_stream stream;
+    size_t start;
+    int res = 0;
+
+    czint_buffer_write(out, (const char *) czint_png_signature, 8);
+
+    czint_png_be32(&header[0], width);
+    czint_png_be32(&header[4], height);
+    header[8] = 1;      /* bit depth */
+    header[9] = 3;      /* palette */
+    header[10] = 0;     /* deflate */
+    header[11] = 0;     /* adaptive filtering */
+    header[12] = 0;     /* no interlace */
+
+    start = czint_png_chunk_begin(out, "IHDR");
+    czint_buffer_write(out, (const char *) header, sizeof(header));
+    czint_png_chunk_end(out, start);
+
+    for (int i = 0; i < 3; i++) {
+        palette[i] = (unsigned char) fgcolor[i];
+        palette[3 + i] = (unsigned char) bgcolor[i];
+    }
+
+    start = czint_png_chunk_begin(out, "PLTE");
+    czint_buffer_write(out, (const char *) palette, sizeof(palette));
+    czint_png_chunk_end(out, start);
+
+    if (out->failed) return -1;
+
+    line = malloc(length + 1);
+    zero = calloc(length + 1, 1);
+    memset(&stream, 0, sizeof(stream));
+
+    if (line == NULL || zero == NULL || deflateInit2(
+        &stream, options->level, Z_DEFLATED, 15, 8, options->strategy
+    ) != Z_OK) {
+        free(line);
+        free(zero);
+        return -1;
+    }
+
+    start = czint_png_chunk_begin(out, "IDAT");
+
+    prior = zero;
+    for (unsigned int y = 0; y < height && res == 0; y++) {
+        const unsigned char *row = rows + (ptrdiff_t) y * step;
+
+        czint_png_filter(line, row, prior, length, options->filter);
+        prior = row;
+
+        stream.next_in = line;
+        stream.avail_in = (uInt) (length + 1);
+        res = czint_png_deflate(out, &stream, Z_NO_FLUSH);
+    }
+
+    if (res == 0) res = czint_png_deflate(out, &stream, Z_FINISH);
+
+    deflateEnd(&stream);
+    free(line);
+    free(zero);
+
+    if (res) return -1;
+
+    czint_png_chunk_end(out, start);
+
+    start = czint_png_chunk_begin(out, "IEND");
+    czint_png_chunk_end(out, start);
+
+    return out->failed ? -1 : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef _PYZINT_PNG_H
+#define _PYZINT_PNG_H
+
+#include <stddef.h>
+
+#include "zint_buffer.h"
+
+#define CZINT_PNG_FILTER_NONE 0
+#define CZINT_PNG_FILTER_SUB 1
+#define CZINT_PNG_FILTER_UP 2
+#define CZINT_PNG_FILTER_AVERAGE 3
+#define CZINT_PNG_FILTER_PAETH 4
+
+typedef struct {
+    int level;      /* zlib level, -1 default, 0..9 */
+    int strategy;   /* Z_DEFAULT_STRATEGY, Z_FILTERED, Z_RLE, ... */
+    int filter;     /* CZINT_PNG_FILTER_* applied to every row */
+} czint_png_options;
+
+void czint_png_options_init(czint_png_options *options);
+
+/* zlib strategy by name ("default", "filtered", "huffman", "rle",
+ * "fixed") and row filter by name ("none", "sub", "up", "average",
+ * "paeth"). Return -1 for unknown names. */
+int czint_png_strategy(const char *name);
+int czint_png_filter_type(const char *name);
+
+/* Write 1bit palette png of packed rows, most significant bit first,
+ * bit 0 is fgcolor and bit 1 is bgcolor. Row i starts at
+ * rows + i * step, so bottom up bmp rows may be passed with negative
+ * step. Unused bits of last byte in row must be zero.
+ * Returns 0 on success, -1 when out of memory. */
+int czint_png_write(
+    czint_buffer *out,
+    const unsigned char *rows, ptrdiff_t step,
+    unsigned int width, unsigned int height,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    const czint_png_options *options
+);
+
+#endif
@@ -0,0 +1,201 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "zint_pool.h"
+
+
+typedef struct czint_pool_job {
+    czint_pool_task task;
+    void *arg;
+    struct czint_pool_job *next;
+} czint_pool_job;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static czint_pool_job *pool_head = NULL;
+static czint_pool_job *pool_tail = NULL;
+static int pool_threads = 0;
+static int pool_idle = 0;
+static int pool_queued = 0;
+
+
+int czint_pool_default_threads(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    if (cpus > CZINT_POOL_MAX_THREADS) return CZINT_POOL_MAX_THREADS;
+    return (int) cpus;
+}
+
+static void *czint_pool_worker(void *unused) {
+    czint_pool_job *job;
+
+    for (;;) {
+        pthread_mutex_lock(&pool_lock);
+        while (pool_head == NULL) {
+            pool_idle++;
+            pthread_cond_wait(&pool_cond, &pool_lock);
+            pool_idle--;
+        }
+        job = pool_head;
+        pool_head = job->next;
+        if (pool_head == NULL) pool_tail = NULL;
+        pool_queued--;
+        pthread_mutex_unlock(&pool_lock);
+
+        job->task(job->arg);
+        free(job);
+    }
+    return NULL;
+}
+
+/* Worker threads do not survive fork(), forget about them in the child
+ * so pre-fork servers get a fresh pool in every worker process. */
+static void czint_pool_atfork_child(void) {
+    czint_pool_job *job;
+
+    pthread_mutex_init(&pool_lock, NULL);
+    pthread_cond_init(&pool_cond, NULL);
+
+    while (pool_head != NULL) {
+        job = pool_head;
+        pool_head = job->next;
+        free(job);
+    }
+    pool_tail = NULL;
+    pool_threads = 0;
+    pool_idle = 0;
+    pool_queued = 0;
+}
+
+static void czint_pool_init(void) {
+    pthread_atfork(NULL, NULL, czint_pool_atfork_child);
+}
+
+int czint_pool_submit(czint_pool_task task, void *arg, int threads) {
+    pthread_t thread;
+    pthread_attr_t attr;
+    czint_pool_job *job;
+
+    pthread_once(&pool_once, czint_pool_init);
+
+    if (threads < 1) threads = 1;
+    if (threads > CZINT_POOL_MAX_THREADS) threads = CZINT_POOL_MAX_THREADS;
+
+    job = malloc(sizeof(czint_pool_job));
+    if (job == NULL) return -1;
+
+    job->task = task;
+    job->arg = arg;
+    job->next = NULL;
+
+    pthread_mutex_lock(&pool_lock);
+
+    if (pool_queued >= pool_idle && pool_threads < threads) {
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&thread, &attr, czint_pool_worker, NULL) == 0) {
+            pool_threads++;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    if (pool_threads == 0) {
+        pthread_mutex_unlock(&pool_lock);
+        free(job);
+        return -1;
+    }
+
+    if (pool_tail == NULL) {
+        pool_head = job;
+    } else {
+        pool_tail->next = job;
+    }
+    pool_tail = job;
+    pool_queued++;
+
+    pthread_cond_signal(&pool_cond);
+    pthread_mutex_unlock(&pool_lock);
+    return 0;
+}
+
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    size_t next;
+    size_t count;
+    int running;
+    czint_pool_item fn;
+    void *ctx;
+} czint_pool_map_state;
+
+static void czint_pool_map_run(czint_pool_map_state *state) {
+    size_t index;
+
+    for (;;) {
+        pthread_mutex_lock(&state->lock);
+        index = state->next++;
+        pthread_mutex_unlock(&state->lock);
+
+        if (index >= state->count) return;
+        state->fn(state->ctx, index);
+    }
+}
+
+static void czint_pool_map_helper(void *arg) {
+    czint_pool_map_state *state = arg;
+
+    czint_pool_map_run(state);
+
+    pthread_mutex_lock(&state->lock);
+    if (--state->running == 0) pthread_cond_signal(&state->done);
+    pthread_mutex_unlock(&state->lock);
+}
+
+void czint_pool_map(size_t count, int threads, czint_pool_item fn, void *ctx) {
+    czint_pool_map_state state;
+    int helpers;
+
+    if (count == 0) return;
+
+    if (threads < 1) threads = czint_pool_default_threads();
+    if (threads > CZINT_POOL_MAX_THREADS) threads = CZINT_POOL_MAX_THREADS;
+    if ((size_t) threads > count) threads = (int) count;
+
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.done, NULL);
+    state.next = 0;
+    state.count = count;
+    state.running = 0;
+    state.fn = fn;
+    state.ctx = ctx;
+
+    /* Calling thread is a worker too, so only threads - 1 helpers */
+    for (helpers = 0; helpers < threads - 1; helpers++) {
+        pthread_mutex_lock(&state.lock);
+        state.running++;
+        pthread_mutex_unlock(&state.lock);
+
+        if (czint_pool_submit(czint_pool_map_helper, &state, threads - 1) != 0) {
+            pthread_mutex_lock(&state.lock);
+            state.running--;
+            pthread_mutex_unlock(&state.lock);
+            break;
+        }
+    }
+
+    czint_pool_map_run(&state);
+
+    pthread_mutex_lock(&state.lock);
+    while (state.running > 0) {
+        pthread_cond_wait(&state.done, &state.lock);
+    }
+    pthread_mutex_unlock(&state.lock);
+
+    pthread_cond_destroy(&state.done);
+    pthread_mutex_destroy(&state.lock);
+}
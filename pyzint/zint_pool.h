@@ -0,0 +1,23 @@
+#ifndef _PYZINT_POOL_H
+#define _PYZINT_POOL_H
+
+#include <stddef.h>
+
+#define CZINT_POOL_MAX_THREADS 256
+
+typedef void (*czint_pool_task)(void *arg);
+typedef void (*czint_pool_item)(void *ctx, size_t index);
+
+/* Number of online CPUs, used when caller asks for threads=0 */
+int czint_pool_default_threads(void);
+
+/* Queue task on the process wide worker pool. Pool will be grown
+ * lazily up to `threads` workers. Returns 0 on success. */
+int czint_pool_submit(czint_pool_task task, void *arg, int threads);
+
+/* Call fn(ctx, i) for every i in [0, count) using up to `threads`
+ * threads including the calling one. Blocks until all items are done.
+ * Must be called without the GIL held. */
+void czint_pool_map(size_t count, int threads, czint_pool_item fn, void *ctx);
+
+#endif
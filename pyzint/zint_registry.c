@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "zint_registry.h"
+
+
+#define LINEAR CZINT_SYMBOLOGY_LINEAR
+#define STACKED CZINT_SYMBOLOGY_STACKED
+#define MATRIX CZINT_SYMBOLOGY_MATRIX
+#define POSTAL CZINT_SYMBOLOGY_POSTAL
+#define COMPOSITE CZINT_SYMBOLOGY_COMPOSITE
+#define GS1 CZINT_SYMBOLOGY_GS1
+#define PRIMARY CZINT_SYMBOLOGY_PRIMARY
+#define DIRECT CZINT_SYMBOLOGY_DIRECT
+
+#define BYTES CZINT_CHARSET_BYTES, NULL
+#define ASCII CZINT_CHARSET_ASCII, NULL
+#define NUMERIC CZINT_CHARSET_NUMERIC, NULL
+#define SET(chars) CZINT_CHARSET_SET, chars
+
+/* Lowercase is accepted where zint uppercases input itself */
+#define CZINT_SET_EAN "0123456789+"
+#define CZINT_SET_ISBN "0123456789Xx+"
+#define CZINT_SET_CODE11 "0123456789-"
+#define CZINT_SET_TELEPEN_NUM "0123456789Xx"
+#define CZINT_SET_CODE39 \
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-. $/+%"
+#define CZINT_SET_PLESSEY "0123456789ABCDEFabcdef"
+
+/* Composite symbols carry 2D component in data and linear one in
+ * primary, their limits are left to encoder */
+#define CZINT_COMPOSITE(shape) (shape | COMPOSITE | GS1 | PRIMARY)
+
+/* Every symbology known to binding: id, name, flags, longest input in
+ * bytes and accepted characters. Lengths are zint 2.9 input limits,
+ * raised to the largest capacity where zint checks encoded size. */
+#define CZINT_SYMBOLOGIES(X) \
+    X(BARCODE_CODE11, "code11", LINEAR | DIRECT, 121, SET(CZINT_SET_CODE11)) \
+    X(BARCODE_C25MATRIX, "c25matrix", LINEAR | DIRECT, 112, NUMERIC) \
+    X(BARCODE_C25INTER, "c25inter", LINEAR | DIRECT, 125, NUMERIC) \
+    X(BARCODE_C25IATA, "c25iata", LINEAR | DIRECT, 80, NUMERIC) \
+    X(BARCODE_C25LOGIC, "c25logic", LINEAR | DIRECT, 113, NUMERIC) \
+    X(BARCODE_C25IND, "c25ind", LINEAR | DIRECT, 79, NUMERIC) \
+    X(BARCODE_CODE39, "code39", LINEAR | DIRECT, 85, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_EXCODE39, "excode39", LINEAR | DIRECT, 85, ASCII) \
+    X(BARCODE_EANX, "eanx", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_EANX_CHK, "eanx_chk", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_EAN128, "ean128", LINEAR | GS1 | DIRECT, 0, BYTES) \
+    X(BARCODE_CODABAR, "codabar", LINEAR | DIRECT, 103, BYTES) \
+    X(BARCODE_CODE128, "code128", LINEAR | DIRECT, 160, BYTES) \
+    X(BARCODE_DPLEIT, "dpleit", LINEAR | DIRECT, 14, NUMERIC) \
+    X(BARCODE_DPIDENT, "dpident", LINEAR | DIRECT, 12, NUMERIC) \
+    X(BARCODE_CODE16K, "code16k", STACKED | DIRECT, 157, BYTES) \
+    X(BARCODE_CODE49, "code49", STACKED | DIRECT, 81, ASCII) \
+    X(BARCODE_CODE93, "code93", LINEAR | DIRECT, 123, ASCII) \
+    X(BARCODE_FLAT, "flat", LINEAR | DIRECT, 128, NUMERIC) \
+    X(BARCODE_RSS14, "rss14", LINEAR | DIRECT, 14, NUMERIC) \
+    X(BARCODE_RSS_LTD, "rss_ltd", LINEAR | DIRECT, 14, NUMERIC) \
+    X(BARCODE_RSS_EXP, "rss_exp", LINEAR | GS1 | DIRECT, 0, BYTES) \
+    X(BARCODE_TELEPEN, "telepen", LINEAR | DIRECT, 69, ASCII) \
+    X(BARCODE_UPCA, "upca", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_UPCA_CHK, "upca_chk", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_UPCE, "upce", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_UPCE_CHK, "upce_chk", LINEAR, 19, SET(CZINT_SET_EAN)) \
+    X(BARCODE_POSTNET, "postnet", POSTAL | DIRECT, 38, NUMERIC) \
+    X(BARCODE_MSI_PLESSEY, "msi_plessey", LINEAR | DIRECT, 92, NUMERIC) \
+    X(BARCODE_FIM, "fim", LINEAR | DIRECT, 1, BYTES) \
+    X(BARCODE_LOGMARS, "logmars", LINEAR | DIRECT, 59, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_PHARMA, "pharma", LINEAR | DIRECT, 6, NUMERIC) \
+    X(BARCODE_PZN, "pzn", LINEAR | DIRECT, 7, NUMERIC) \
+    X(BARCODE_PHARMA_TWO, "pharma_two", POSTAL | DIRECT, 8, NUMERIC) \
+    X(BARCODE_PDF417, "pdf417", STACKED | DIRECT, 2710, BYTES) \
+    X(BARCODE_PDF417TRUNC, "pdf417trunc", STACKED | DIRECT, 2710, BYTES) \
+    X(BARCODE_MAXICODE, "maxicode", MATRIX, 138, BYTES) \
+    X(BARCODE_QRCODE, "qrcode", MATRIX | DIRECT, 7089, BYTES) \
+    X(BARCODE_CODE128B, "code128b", LINEAR | DIRECT, 160, BYTES) \
+    X(BARCODE_AUSPOST, "auspost", POSTAL | DIRECT, 23, BYTES) \
+    X(BARCODE_AUSREPLY, "ausreply", POSTAL | DIRECT, 8, NUMERIC) \
+    X(BARCODE_AUSROUTE, "ausroute", POSTAL | DIRECT, 8, NUMERIC) \
+    X(BARCODE_AUSREDIRECT, "ausredirect", POSTAL | DIRECT, 8, NUMERIC) \
+    X(BARCODE_ISBNX, "isbnx", LINEAR, 19, SET(CZINT_SET_ISBN)) \
+    X(BARCODE_RM4SCC, "rm4scc", POSTAL | DIRECT, 50, BYTES) \
+    X(BARCODE_DATAMATRIX, "datamatrix", MATRIX | DIRECT, 3116, BYTES) \
+    X(BARCODE_EAN14, "ean14", LINEAR | DIRECT, 14, NUMERIC) \
+    X(BARCODE_VIN, "vin", LINEAR | DIRECT, 17, BYTES) \
+    X(BARCODE_CODABLOCKF, "codablockf", STACKED, 0, BYTES) \
+    X(BARCODE_NVE18, "nve18", LINEAR | DIRECT, 18, NUMERIC) \
+    X(BARCODE_JAPANPOST, "japanpost", POSTAL | DIRECT, 20, BYTES) \
+    X(BARCODE_KOREAPOST, "koreapost", LINEAR | DIRECT, 6, NUMERIC) \
+    X(BARCODE_RSS14STACK, "rss14stack", STACKED | DIRECT, 14, NUMERIC) \
+    X(BARCODE_RSS14STACK_OMNI, "rss14stack_omni", STACKED | DIRECT, 14, NUMERIC) \
+    X(BARCODE_RSS_EXPSTACK, "rss_expstack", STACKED | GS1 | DIRECT, 0, BYTES) \
+    X(BARCODE_PLANET, "planet", POSTAL | DIRECT, 38, NUMERIC) \
+    X(BARCODE_MICROPDF417, "micropdf417", STACKED | DIRECT, 366, BYTES) \
+    X(BARCODE_ONECODE, "onecode", POSTAL | DIRECT, 32, SET(CZINT_SET_CODE11)) \
+    X(BARCODE_PLESSEY, "plessey", LINEAR | DIRECT, 67, SET(CZINT_SET_PLESSEY)) \
+    X(BARCODE_TELEPEN_NUM, "telepen_num", LINEAR | DIRECT, 136, SET(CZINT_SET_TELEPEN_NUM)) \
+    X(BARCODE_ITF14, "itf14", LINEAR | DIRECT, 14, NUMERIC) \
+    X(BARCODE_KIX, "kix", POSTAL | DIRECT, 18, BYTES) \
+    X(BARCODE_AZTEC, "aztec", MATRIX | DIRECT, 3832, BYTES) \
+    X(BARCODE_DAFT, "daft", POSTAL | DIRECT, 250, BYTES) \
+    X(BARCODE_MICROQR, "microqr", MATRIX | DIRECT, 35, BYTES) \
+    X(BARCODE_HIBC_128, "hibc_128", LINEAR | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_39, "hibc_39", LINEAR | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_DM, "hibc_dm", MATRIX | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_QR, "hibc_qr", MATRIX | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_PDF, "hibc_pdf", STACKED | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_MICPDF, "hibc_micpdf", STACKED | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_BLOCKF, "hibc_blockf", STACKED, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_HIBC_AZTEC, "hibc_aztec", MATRIX | DIRECT, 110, SET(CZINT_SET_CODE39)) \
+    X(BARCODE_DOTCODE, "dotcode", MATRIX, 0, BYTES) \
+    X(BARCODE_HANXIN, "hanxin", MATRIX | DIRECT, 7827, BYTES) \
+    X(BARCODE_MAILMARK, "mailmark", POSTAL | DIRECT, 26, BYTES) \
+    X(BARCODE_AZRUNE, "azrune", MATRIX | DIRECT, 3, NUMERIC) \
+    X(BARCODE_CODE32, "code32", LINEAR | DIRECT, 8, NUMERIC) \
+    X(BARCODE_EANX_CC, "eanx_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_EAN128_CC, "ean128_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_RSS14_CC, "rss14_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_RSS_LTD_CC, "rss_ltd_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_RSS_EXP_CC, "rss_exp_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_UPCA_CC, "upca_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_UPCE_CC, "upce_cc", CZINT_COMPOSITE(LINEAR), 0, BYTES) \
+    X(BARCODE_RSS14STACK_CC, "rss14stack_cc", CZINT_COMPOSITE(STACKED), 0, BYTES) \
+    X(BARCODE_RSS14_OMNI_CC, "rss14_omni_cc", CZINT_COMPOSITE(STACKED), 0, BYTES) \
+    X(BARCODE_RSS_EXPSTACK_CC, "rss_expstack_cc", CZINT_COMPOSITE(STACKED), 0, BYTES) \
+    X(BARCODE_CHANNEL, "channel", LINEAR | DIRECT, 7, NUMERIC) \
+    X(BARCODE_CODEONE, "codeone", MATRIX | DIRECT, 3550, BYTES) \
+    X(BARCODE_GRIDMATRIX, "gridmatrix", MATRIX | DIRECT, 2751, BYTES) \
+    X(BARCODE_UPNQR, "upnqr", MATRIX | DIRECT, 411, BYTES) \
+    X(BARCODE_RMQR, "rmqr", MATRIX | DIRECT, 361, BYTES)
+
+#define CZINT_SYMBOLOGY_ENTRY(id, name, flags, max_length, charset) \
+    [id] = {name, flags, max_length, charset},
+
+static const czint_symbology czint_symbologies[CZINT_SYMBOLOGY_LIMIT] = {
+    CZINT_SYMBOLOGIES(CZINT_SYMBOLOGY_ENTRY)
+};
+
+
+const czint_symbology *czint_symbology_get(int id) {
+    if (id < 0 || id >= CZINT_SYMBOLOGY_LIMIT) return NULL;
+    if (czint_symbologies[id].name == NULL) return NULL;
+    return &czint_symbologies[id];
+}
+
+static int czint_charset_accepts(const czint_symbology *info, unsigned char c) {
+    switch (info->charset) {
+        case CZINT_CHARSET_ASCII:
+            return c < 128;
+        case CZINT_CHARSET_NUMERIC:
+            return c >= '0' && c <= '9';
+        case CZINT_CHARSET_SET:
+            return c != '\0' && strchr(info->set, c) != NULL;
+        default:
+            return 1;
+    }
+}
+
+/* Called without GIL. */
+int czint_symbology_check(
+    struct zint_symbol *symbol, const unsigned char *data, size_t length
+) {
+    const czint_symbology *info = czint_symbology_get(symbol->symbology);
+
+    if (info == NULL) return 0;
+
+    if (length == 0) {
+        strcpy(symbol->errtxt, "No input data");
+        return ZINT_ERROR_INVALID_DATA;
+    }
+
+    if ((info->flags & CZINT_SYMBOLOGY_PRIMARY) && symbol->primary[0] == '\0') {
+        snprintf(
+            symbol->errtxt, sizeof(symbol->errtxt),
+            "No primary (linear) message in %s composite", info->name
+        );
+        return ZINT_ERROR_INVALID_OPTION;
+    }
+
+    if (info->max_length > 0 && length > info->max_length) {
+        snprintf(
+            symbol->errtxt, sizeof(symbol->errtxt),
+            "Input too long, %s takes at most %zu bytes got %zu",
+            info->name, info->max_length, length
+        );
+        return ZINT_ERROR_TOO_LONG;
+    }
+
+    if (info->charset == CZINT_CHARSET_BYTES) return 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (czint_charset_accepts(info, data[i])) continue;
+
+        snprintf(
+            symbol->errtxt, sizeof(symbol->errtxt),
+            "Invalid character 0x%02x at position %zu in %s data",
+            data[i], i, info->name
+        );
+        return ZINT_ERROR_INVALID_DATA;
+    }
+
+    return 0;
+}
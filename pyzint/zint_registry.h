@@ -0,0 +1,48 @@
+#ifndef _PYZINT_REGISTRY_H
+#define _PYZINT_REGISTRY_H
+
+#include <stddef.h>
+
+#include "src/zint/backend/zint.h"
+
+/* Symbology ids are below this */
+#define CZINT_SYMBOLOGY_LIMIT 256
+
+/* Shape and requirements of symbology */
+#define CZINT_SYMBOLOGY_LINEAR     (1 << 0)
+#define CZINT_SYMBOLOGY_STACKED    (1 << 1)
+#define CZINT_SYMBOLOGY_MATRIX     (1 << 2)
+#define CZINT_SYMBOLOGY_POSTAL     (1 << 3)    /* height modulated bars */
+#define CZINT_SYMBOLOGY_COMPOSITE  (1 << 4)
+#define CZINT_SYMBOLOGY_GS1        (1 << 5)    /* data is GS1 element string */
+#define CZINT_SYMBOLOGY_PRIMARY    (1 << 6)    /* primary is required */
+#define CZINT_SYMBOLOGY_DIRECT     (1 << 7)    /* may skip raster stage */
+
+/* Characters accepted in data */
+typedef enum {
+    CZINT_CHARSET_BYTES,
+    CZINT_CHARSET_ASCII,
+    CZINT_CHARSET_NUMERIC,
+    CZINT_CHARSET_SET,
+} czint_charset;
+
+typedef struct {
+    const char *name;
+    unsigned int flags;
+    size_t max_length;      /* bytes, 0 when only encoder knows */
+    czint_charset charset;
+    const char *set;        /* characters of CZINT_CHARSET_SET */
+} czint_symbology;
+
+/* Registry entry of symbology id, NULL for ids unknown to binding */
+const czint_symbology *czint_symbology_get(int id);
+
+/* Reject data zint would refuse for symbol setup, without encoding.
+ * Limits are never stricter than zint ones, anything passing may still
+ * fail in ZBarcode_Encode. Returns 0 or zint error code with errtxt of
+ * symbol set. */
+int czint_symbology_check(
+    struct zint_symbol *symbol, const unsigned char *data, size_t length
+);
+
+#endif
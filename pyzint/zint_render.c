@@ -0,0 +1,1114 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "endianness.h"
+#include "src/zint/backend/common.h"
+
+#include "zint_buffer.h"
+#include "zint_pack.h"
+#include "zint_registry.h"
+#include "zint_render.h"
+#include "zint_stats.h"
+
+extern void make_html_friendly(const unsigned char * string, char * html_version);
+
+
+/* Row packer is process wide, selected once for all interpreters */
+static czint_pack_fn czint_pack_row = czint_pack_row_scalar;
+static pthread_once_t czint_pack_once = PTHREAD_ONCE_INIT;
+
+static void czint_pack_init(void) {
+    czint_pack_row = czint_pack_select();
+}
+
+void czint_render_init(void) {
+    pthread_once(&czint_pack_once, czint_pack_init);
+}
+
+
+int czint_symbol_oom(struct zint_symbol *symbol) {
+    strcpy(symbol->errtxt, "Insufficient memory");
+    return ZINT_ERROR_MEMORY;
+}
+
+
+static const unsigned char czint_bmp_template[CZINT_BMP_HEADER_SIZE] = {
+    0x42, 0x4d,
+    0x00, 0x00, 0x00, 0x00, // size
+    0x00, 0x00, 0x00, 0x00, // padding (zero)
+    0x3e, 0x00, 0x00, 0x00, // 62
+    0x28, 0x00, 0x00, 0x00, // 40
+    0x00, 0x00, 0x00, 0x00, // width
+    0x00, 0x00, 0x00, 0x00, // height
+    0x01, 0x00, 0x01, 0x00, // planes and bpp
+    0x00, 0x00, 0x00, 0x00, // compression
+    0x00, 0x00, 0x00, 0x00, // size
+    0xc4, 0x0e, 0x00, 0x00, // x pxls per meter
+    0xc4, 0x0e, 0x00, 0x00, // y pxls per meter
+    0x02, 0x00, 0x00, 0x00, // colors in table
+    0x02, 0x00, 0x00, 0x00, // important color in table
+    0x00, 0x00, 0x00, 0x00, // red channel - fgcolor
+    0xff, 0xff, 0xff, 0xff  // green channel - bgcolor
+};
+
+/* Size of 1bit bmp file, rows are padded to 4 bytes */
+size_t czint_bmp_size(
+    unsigned int width, unsigned int height, size_t *stride
+) {
+    const size_t bmp_1bit_with_bytes = (width / 8 + (width % 8 == 0?0:1));
+    const size_t padding = (bmp_1bit_with_bytes * 3) % 4;
+
+    *stride = bmp_1bit_with_bytes + padding;
+    return CZINT_BMP_HEADER_SIZE + *stride * height;
+}
+
+/* Fill CZINT_BMP_HEADER_SIZE bytes of header and palette */
+static void czint_bmp_header(
+    char *bmp, size_t size, unsigned int width, unsigned int height,
+    const unsigned int *fgcolor, const unsigned int *bgcolor
+) {
+    memcpy(bmp, &czint_bmp_template, CZINT_BMP_HEADER_SIZE);
+
+    unsigned int be_value = hton32(size);
+    bmp[5] = (unsigned char)(be_value);
+    bmp[4] = (unsigned char)(be_value >> 8);
+    bmp[3] = (unsigned char)(be_value >> 16);
+    bmp[2] = (unsigned char)(be_value >> 24);
+
+    be_value = hton32(width);
+    bmp[21] = (unsigned char)(be_value);
+    bmp[20] = (unsigned char)(be_value >> 8);
+    bmp[19] = (unsigned char)(be_value >> 16);
+    bmp[18] = (unsigned char)(be_value >> 24);
+
+    be_value = hton32(height);
+    bmp[25] = (unsigned char)(be_value);
+    bmp[24] = (unsigned char)(be_value >> 8);
+    bmp[23] = (unsigned char)(be_value >> 16);
+    bmp[22] = (unsigned char)(be_value >> 24);
+
+    bmp[54] = (unsigned char)fgcolor[0];
+    bmp[55] = (unsigned char)fgcolor[1];
+    bmp[56] = (unsigned char)fgcolor[2];
+
+    bmp[58] = (unsigned char)bgcolor[0];
+    bmp[59] = (unsigned char)bgcolor[1];
+    bmp[60] = (unsigned char)bgcolor[2];
+}
+
+/* Called without GIL. */
+int czint_bmp_begin(
+    unsigned int width, unsigned int height,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result, unsigned char **pixels
+) {
+    static const unsigned int header_size = CZINT_BMP_HEADER_SIZE;
+
+    char *bmp = NULL;
+    size_t stride = 0;
+
+    const size_t bmp_1bit_size = czint_bmp_size(width, height, &stride);
+
+    result->size = bmp_1bit_size;
+    result->width = width;
+    result->height = height;
+    result->stride = stride;
+    result->offset = header_size;
+
+    if (result->data == NULL) {
+        bmp = malloc(bmp_1bit_size);
+        if (bmp == NULL) return -1;
+        result->data = bmp;
+    } else if (bmp_1bit_size > result->capacity) {
+        return 1;
+    } else {
+        bmp = result->data;
+    }
+
+    czint_bmp_header(bmp, bmp_1bit_size, width, height, fgcolor, bgcolor);
+
+    *pixels = (unsigned char *) &bmp[header_size];
+    return 0;
+}
+
+/* Pack buffered symbol->bitmap into 1bit bmp, see czint_bmp_begin.
+ * Called without GIL. */
+int czint_make_bmp(
+    struct zint_symbol *symbol,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result
+) {
+    unsigned char *pixels = NULL;
+
+    unsigned int width = symbol->bitmap_width;
+    unsigned int height = symbol->bitmap_height;
+
+    int res = czint_bmp_begin(width, height, fgcolor, bgcolor, result, &pixels);
+    if (res) return res < 0 ? -1 : 0;
+
+    const size_t stride = result->stride;
+    const size_t bmp_1bit_with_bytes = (width / 8 + (width % 8 == 0?0:1));
+
+    for(int y=height-1; y >= 0; y--) {
+        czint_pack_row(
+            (const unsigned char *) &symbol->bitmap[(size_t) y * width * 3],
+            width, pixels
+        );
+        memset(&pixels[bmp_1bit_with_bytes], 0, stride - bmp_1bit_with_bytes);
+        pixels += stride;
+    }
+
+    return 0;
+}
+
+
+/* Symbol height in modules as zint plotters take it, rows without
+ * preset height share what is left of symbol->height */
+static int czint_symbol_height(
+    const struct zint_symbol *symbol, float *large_bar_height
+) {
+    float preset_height = 0;
+    int large_bar_count = 0;
+    int height;
+
+    for (int i = 0; i < symbol->rows; i++) {
+        preset_height += symbol->row_height[i];
+        if (symbol->row_height[i] == 0) large_bar_count++;
+    }
+
+    height = symbol->height ? symbol->height : 50;
+    if (large_bar_count == 0) {
+        height = preset_height;
+        *large_bar_height = 10;
+    } else {
+        *large_bar_height = (height - preset_height) / large_bar_count;
+    }
+    return height;
+}
+
+/* Check whether ZBarcode_Buffer output for symbol is plain scaled module
+ * matrix and fill layout, mirroring zint raster plotter. Symbols with
+ * human readable text, dots, hexagons, UPC/EAN add-ons, composites,
+ * rotation or fractional module size need real raster stage and
+ * return -1. */
+int czint_direct_layout_init(
+    const struct zint_symbol *symbol, int angle, czint_direct_layout *layout
+) {
+    const czint_symbology *info;
+    int height;
+
+    if (angle != 0) return -1;
+    if (symbol->rows < 1 || symbol->width < 1) return -1;
+    if (symbol->show_hrt && symbol->text[0] != '\0') return -1;
+    if (symbol->output_options & BARCODE_DOTTY_MODE) return -1;
+
+    info = czint_symbology_get(symbol->symbology);
+    if (info == NULL || !(info->flags & CZINT_SYMBOLOGY_DIRECT)) return -1;
+
+    if (symbol->scale * 2 != (float) (int) (symbol->scale * 2)) return -1;
+    if (symbol->scale * 2 < 1 || symbol->scale * 2 > 2 * CZINT_SCALE_MAX) return -1;
+
+    height = czint_symbol_height(symbol, &layout->large_bar_height);
+
+    layout->k = (unsigned int) (symbol->scale * 2);
+    layout->box = (symbol->output_options & BARCODE_BOX) != 0;
+    layout->border = (
+        symbol->output_options & (BARCODE_BOX | BARCODE_BIND)
+    ) ? symbol->border_width : 0;
+    layout->bind_rows = (
+        (symbol->output_options & BARCODE_BIND) &&
+        symbol->rows > 1 && is_stackable(symbol->symbology)
+    );
+    layout->xoffset = symbol->whitespace_width + (
+        layout->box ? symbol->border_width : 0
+    );
+    layout->width = symbol->width + 2 * layout->xoffset;
+    layout->height = height + 2 * layout->border;
+
+    if (layout->width < 1 || layout->height < 1) return -1;
+    return 0;
+}
+
+/* Modules zint adds below symbol for human readable text in raster
+ * and vector output, and font size of vector one. Fonts and their
+ * spacing belong to zint version, so they are taken once from a
+ * reference CODE128 render; negative when it failed. */
+static struct {
+    float raster;
+    float vector;
+    int fontsize;
+} czint_text_offset = {-1, -1, 0};
+static pthread_once_t czint_text_once = PTHREAD_ONCE_INIT;
+
+static void czint_text_offset_init(void) {
+    struct zint_symbol *symbol = ZBarcode_Create();
+    float large_bar_height;
+    int height;
+
+    if (symbol == NULL) return;
+
+    symbol->symbology = BARCODE_CODE128;
+    czint_text_offset.fontsize = symbol->fontsize;
+
+    if (ZBarcode_Encode(symbol, (unsigned char *) "1", 1) == 0) {
+        height = czint_symbol_height(symbol, &large_bar_height);
+
+        if (ZBarcode_Buffer(symbol, 0) == 0) {
+            czint_text_offset.raster = symbol->bitmap_height / 2.0f - height;
+        }
+        if (ZBarcode_Buffer_Vector(symbol, 0) == 0) {
+            czint_text_offset.vector = symbol->vector->height / 2.0f - height;
+        }
+    }
+    ZBarcode_Delete(symbol);
+}
+
+/* Sizes mirror zint raster and vector plotters: module matrix with
+ * whitespace, border and text below, two pixels per module times
+ * scale. */
+int czint_measure_symbol(
+    const struct zint_symbol *symbol, int angle, czint_measure *measure
+) {
+    float scaler = symbol->scale < 0.5f ? 0.5f : symbol->scale;
+    float large_bar_height, raster_text = 0, vector_text = 0;
+    int xoffset, yoffset, width, height;
+
+    if (symbol->symbology == BARCODE_MAXICODE) return -1;
+    if (symbol->output_options & BARCODE_DOTTY_MODE) return -1;
+
+    if (symbol->show_hrt && symbol->text[0] != '\0') {
+        /* UPC/EAN text and add-ons widen and lengthen the symbol */
+        if (is_extendable(symbol->symbology)) return -1;
+
+        pthread_once(&czint_text_once, czint_text_offset_init);
+        raster_text = czint_text_offset.raster;
+        vector_text = czint_text_offset.vector;
+        if (raster_text < 0) return -1;
+        if (symbol->fontsize != czint_text_offset.fontsize) vector_text = -1;
+    }
+
+    xoffset = symbol->whitespace_width;
+    if (symbol->output_options & BARCODE_BOX) xoffset += symbol->border_width;
+    yoffset = (
+        symbol->output_options & (BARCODE_BOX | BARCODE_BIND)
+    ) ? symbol->border_width : 0;
+
+    width = symbol->width + 2 * xoffset;
+    height = czint_symbol_height(symbol, &large_bar_height) + 2 * yoffset;
+
+    measure->bitmap_width = (int) (2 * width * scaler);
+    measure->bitmap_height = (int) (2 * (height + raster_text) * scaler);
+    measure->vector_width = (int) ceilf(width * symbol->scale * 2);
+    measure->vector_height = (int) ceilf(
+        (height + vector_text) * symbol->scale * 2
+    );
+    if (vector_text < 0) measure->vector_width = measure->vector_height = -1;
+
+    if (angle == 90 || angle == 270) {
+        int bitmap_width = measure->bitmap_width;
+        int vector_width = measure->vector_width;
+
+        measure->bitmap_width = measure->bitmap_height;
+        measure->bitmap_height = bitmap_width;
+        measure->vector_width = measure->vector_height;
+        measure->vector_height = vector_width;
+    }
+    return 0;
+}
+
+/* Set bits [from, to) of packed row to 0 (foreground) */
+static void czint_bits_clear(unsigned char *row, size_t from, size_t to) {
+    size_t first = from / 8, last = to / 8;
+
+    if (from >= to) return;
+
+    if (first == last) {
+        row[first] &= ~((0xFF >> (from % 8)) & ~(0xFF >> (to % 8)));
+        return;
+    }
+
+    row[first] &= ~(0xFF >> (from % 8));
+    memset(&row[first + 1], 0, last - first - 1);
+    if (to % 8) row[last] &= 0xFF >> (to % 8);
+}
+
+/* First output pixel of half module position p, zint raster plots two
+ * pixels per module and scales by scale = k / 2. */
+static long czint_direct_pixel(long p, unsigned int k) {
+    return (p * (long) k + 1) / 2;
+}
+
+/* Lines of czint_direct_rows, one per symbol row follows */
+enum {
+    CZINT_LINE_BACKGROUND,
+    CZINT_LINE_BORDER,
+    CZINT_LINE_SEPARATOR,
+    CZINT_LINE_ROWS
+};
+
+/* Image drawn straight from module matrix, as few distinct packed
+ * lines and line index of every pixel row, counted from image top.
+ * Pixel rows of one symbol row share a line. */
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+    size_t stride;
+    unsigned char *lines;
+    unsigned int *index;
+} czint_direct_rows;
+
+static unsigned char *czint_direct_line(const czint_direct_rows *rows, unsigned int line) {
+    return &rows->lines[line * rows->stride];
+}
+
+static void czint_direct_rows_free(czint_direct_rows *rows) {
+    free(rows->lines);
+    free(rows->index);
+}
+
+/* Set index of pixel rows [top, bottom), border rows are kept when
+ * keep_border */
+static void czint_direct_mark(
+    czint_direct_rows *rows, long top, long bottom, unsigned int line,
+    int keep_border
+) {
+    if (top < 0) top = 0;
+    if (bottom > (long) rows->height) bottom = rows->height;
+
+    for (long y = top; y < bottom; y++) {
+        if (keep_border && rows->index[y] == CZINT_LINE_BORDER) continue;
+        rows->index[y] = line;
+    }
+}
+
+/* Returns 1 when symbol is not eligible, see czint_direct_layout_init,
+ * and -1 when out of memory. */
+static int czint_direct_rows_init(
+    struct zint_symbol *symbol, int angle, czint_direct_rows *rows
+) {
+    czint_direct_layout layout;
+    unsigned char *background, *line;
+    unsigned int width, height, k;
+    size_t used;
+    float row_posn = 0, row_height = 0;
+    int next_yposn;
+
+    if (czint_direct_layout_init(symbol, angle, &layout)) return 1;
+
+    k = layout.k;
+    width = rows->width = layout.width * k;
+    height = rows->height = layout.height * k;
+    czint_bmp_size(width, height, &rows->stride);
+    used = (width + 7) / 8;
+
+    /* Border line stays all foreground, padding stays zero */
+    rows->lines = calloc(CZINT_LINE_ROWS + symbol->rows, rows->stride);
+    rows->index = malloc(height * sizeof(unsigned int));
+    if (rows->lines == NULL || rows->index == NULL) {
+        czint_direct_rows_free(rows);
+        return -1;
+    }
+
+    /* Background line, box sides included */
+    background = czint_direct_line(rows, CZINT_LINE_BACKGROUND);
+    memset(background, 0xFF, used);
+    if (width % 8) background[used - 1] &= ~(0xFF >> (width % 8));
+    if (layout.box) {
+        czint_bits_clear(background, 0, (size_t) layout.border * k);
+        czint_bits_clear(
+            background, (size_t) (layout.width - layout.border) * k, width
+        );
+    }
+
+    line = czint_direct_line(rows, CZINT_LINE_SEPARATOR);
+    memcpy(line, background, rows->stride);
+    czint_bits_clear(
+        line, (size_t) layout.xoffset * k,
+        (size_t) (layout.xoffset + symbol->width) * k
+    );
+
+    czint_direct_mark(rows, 0, height, CZINT_LINE_BACKGROUND, 0);
+
+    /* Rows are placed from image bottom like zint raster plotter does */
+    row_posn = layout.border;
+    next_yposn = layout.border;
+
+    for (int r = 0; r < symbol->rows; r++) {
+        int this_row = symbol->rows - r - 1;
+        int plot_yposn = next_yposn;
+        long top, bottom;
+        int i = 0;
+
+        row_posn += row_height;
+        row_height = symbol->row_height[this_row] == 0
+            ? layout.large_bar_height : symbol->row_height[this_row];
+        next_yposn = (int) (row_posn + row_height);
+
+        top = (long) (layout.height - next_yposn) * k;
+        bottom = (long) (layout.height - plot_yposn) * k;
+        if (top < 0) top = 0;
+        if (bottom > (long) height) bottom = height;
+        if (top >= bottom) continue;
+
+        line = czint_direct_line(rows, CZINT_LINE_ROWS + this_row);
+        memcpy(line, background, rows->stride);
+
+        while (i < symbol->width) {
+            int latch = module_is_set(symbol, this_row, i);
+            int block_width = 1;
+
+            while (
+                i + block_width < symbol->width &&
+                module_is_set(symbol, this_row, i + block_width) == latch
+            ) block_width++;
+
+            if (latch) czint_bits_clear(
+                line,
+                (size_t) (i + layout.xoffset) * k,
+                (size_t) (i + layout.xoffset + block_width) * k
+            );
+            i += block_width;
+        }
+
+        czint_direct_mark(rows, top, bottom, CZINT_LINE_ROWS + this_row, 0);
+    }
+
+    if (layout.border > 0) {
+        czint_direct_mark(
+            rows, 0, (long) layout.border * k, CZINT_LINE_BORDER, 0
+        );
+        czint_direct_mark(
+            rows, (long) (layout.height - layout.border) * k, height,
+            CZINT_LINE_BORDER, 0
+        );
+    }
+
+    if (layout.bind_rows) {
+        /* Separators between stacked rows, half module positions */
+        long image_height = 2 * layout.height;
+
+        for (int r = 1; r < symbol->rows; r++) {
+            long ypos = (int) ((r * row_height + layout.border - 1) * 2);
+
+            czint_direct_mark(
+                rows,
+                czint_direct_pixel(image_height - ypos - 2, k),
+                czint_direct_pixel(image_height - ypos, k),
+                CZINT_LINE_SEPARATOR, 1
+            );
+        }
+    }
+
+    return 0;
+}
+
+/* Draw 1bit bmp straight from encoded module matrix, without 24bit
+ * raster stage. Returns 1 when symbol is not eligible, see
+ * czint_direct_layout_init. Otherwise like czint_make_bmp. Called
+ * without GIL. */
+int czint_make_bmp_direct(
+    struct zint_symbol *symbol, int angle,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result
+) {
+    czint_direct_rows rows;
+    unsigned char *pixels = NULL;
+    int res;
+
+    res = czint_direct_rows_init(symbol, angle, &rows);
+    if (res) return res;
+
+    res = czint_bmp_begin(rows.width, rows.height, fgcolor, bgcolor, result, &pixels);
+    if (res == 0) {
+        for (unsigned int y = 0; y < rows.height; y++) {
+            memcpy(
+                &pixels[(size_t) (rows.height - 1 - y) * rows.stride],
+                czint_direct_line(&rows, rows.index[y]), rows.stride
+            );
+        }
+    }
+
+    czint_direct_rows_free(&rows);
+    return res < 0 ? -1 : 0;
+}
+
+/* Vector coordinate in hundredths, rounded like "%.2f" does */
+static long long czint_centi(float value) {
+    return (long long) nearbyint((double) value * 100);
+}
+
+/* Write rectangles as single path, horizontally adjacent rectangles of
+ * one row are merged into runs. Subpaths are moved relative to previous
+ * one in whole hundredths, so positions do not drift. */
+static void czint_svg_compact_rects(
+    czint_buffer *svg, struct zint_vector_rect *rect
+) {
+    long long x0, y0, x1, y1;
+    long long px = 0, py = 0;
+    int first = 1;
+
+    if (rect == NULL) return;
+
+    czint_buffer_puts(svg, "<path d=\"");
+
+    while (rect) {
+        x0 = czint_centi(rect->x);
+        y0 = czint_centi(rect->y);
+        x1 = czint_centi(rect->x + rect->width);
+        y1 = czint_centi(rect->y + rect->height);
+
+        while (
+            rect->next != NULL &&
+            czint_centi(rect->next->x) == x1 &&
+            czint_centi(rect->next->y) == y0 &&
+            czint_centi(rect->next->y + rect->next->height) == y1
+        ) {
+            rect = rect->next;
+            x1 = czint_centi(rect->x + rect->width);
+        }
+        rect = rect->next;
+
+        if (x1 <= x0 || y1 <= y0) continue;
+
+        czint_buffer_write(svg, first ? "M" : "m", 1);
+        czint_buffer_centi(svg, x0 - px);
+        if (y0 - py >= 0) czint_buffer_write(svg, " ", 1);
+        czint_buffer_centi(svg, y0 - py);
+        czint_buffer_write(svg, "h", 1);
+        czint_buffer_centi(svg, x1 - x0);
+        czint_buffer_write(svg, "v", 1);
+        czint_buffer_centi(svg, y1 - y0);
+        czint_buffer_write(svg, "h", 1);
+        czint_buffer_centi(svg, x0 - x1);
+        czint_buffer_write(svg, "z", 1);
+
+        px = x0;
+        py = y0;
+        first = 0;
+    }
+
+    czint_buffer_puts(svg, "\"/>\n");
+}
+
+/* Write buffered symbol->vector as svg, returns -1 when out of memory */
+static int czint_svg_write(
+    struct zint_symbol *symbol, int compact, czint_buffer *svg
+) {
+    struct zint_vector_rect *rect;
+    struct zint_vector_hexagon *hex;
+    struct zint_vector_circle *circle;
+    struct zint_vector_string *string;
+    float ax, ay, bx, by, cx, cy, dx, dy, ex, ey, fx, fy;
+    float radius;
+
+    int html_len = strlen((char *)symbol->text) + 1;
+
+    {
+        unsigned int text_length = strlen((char *)symbol->text);
+        for(unsigned int i = 0; i < text_length; i++) {
+            switch(symbol->text[i]) {
+                case '>':
+                case '<':
+                case '"':
+                case '&':
+                case '\'':
+                    html_len += 6;
+                    break;
+            }
+        }
+    }
+    char *html_string = calloc(sizeof(char), html_len);
+    if (html_string == NULL) return -1;
+
+    /* Start writing the header */
+    czint_buffer_puts(svg, "<?xml version=\"1.0\" standalone=\"no\"?>\n");
+
+    czint_buffer_puts(svg, "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\" \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n");
+    czint_buffer_printf(svg, "<svg width=\"%d\" height=\"%d\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\">\n", (int) ceil(symbol->vector->width), (int) ceil(symbol->vector->height));
+    czint_buffer_puts(svg, "<desc>Zint Generated Symbol via pyzint</desc>\n");
+    czint_buffer_printf(svg, "<g id=\"barcode\" fill=\"#%s\">\n", symbol->fgcolour);
+    czint_buffer_printf(svg, "<rect x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" fill=\"#%s\" />\n", (int) ceil(symbol->vector->width), (int) ceil(symbol->vector->height), symbol->bgcolour);
+    rect = symbol->vector->rectangles;
+    if (compact) {
+        czint_svg_compact_rects(svg, rect);
+        rect = NULL;
+    }
+    while (rect) {
+        czint_buffer_printf_fast(svg, "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" />\n", rect->x, rect->y, rect->width, rect->height);
+        rect = rect->next;
+    }
+
+    hex = symbol->vector->hexagons;
+    while (hex) {
+        radius = hex->diameter / 2.0;
+        ay = hex->y + (1.0 * radius);
+        by = hex->y + (0.5 * radius);
+        cy = hex->y - (0.5 * radius);
+        dy = hex->y - (1.0 * radius);
+        ey = hex->y - (0.5 * radius);
+        fy = hex->y + (0.5 * radius);
+        ax = hex->x;
+        bx = hex->x + (0.86 * radius);
+        cx = hex->x + (0.86 * radius);
+        dx = hex->x;
+        ex = hex->x - (0.86 * radius);
+        fx = hex->x - (0.86 * radius);
+        czint_buffer_printf_fast(svg, "<path d=\"M %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f L %.2f %.2f Z\" \n/>", ax, ay, bx, by, cx, cy, dx, dy, ex, ey, fx, fy);
+        hex = hex->next;
+    }
+
+    circle = symbol->vector->circles;
+    while (circle) {
+        if (circle->colour) {
+            czint_buffer_printf_fast(svg, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"#%s\" \n/>", circle->x, circle->y, circle->diameter / 2.0, symbol->bgcolour);
+        } else {
+            czint_buffer_printf_fast(svg, "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"#%s\" \n/>", circle->x, circle->y, circle->diameter / 2.0, symbol->fgcolour);
+        }
+        circle = circle->next;
+    }
+
+    string = symbol->vector->strings;
+    while (string) {
+        czint_buffer_printf_fast(svg, "<text x=\"%.2f\" y=\"%.2f\" text-anchor=\"middle\" ", string->x, string->y);
+        czint_buffer_printf(svg, "font-family=\"Helvetica\" font-size=\"%.1f\" fill=\"#%s\">", string->fsize, symbol->fgcolour);
+        make_html_friendly(string->text, html_string);
+        czint_buffer_printf(svg, " %s ", html_string);
+        czint_buffer_puts(svg, "</text>");
+        string = string->next;
+    }
+
+    czint_buffer_puts(svg, "</g>");
+    czint_buffer_puts(svg, "</svg>");
+
+    free(html_string);
+    return 0;
+}
+
+/* Serialize buffered symbol->vector into svg, with compact rectangles
+ * are written as one path. Called without GIL. */
+int czint_make_svg(
+    struct zint_symbol *symbol, int compact, czint_result *result
+) {
+    czint_buffer svg;
+
+    czint_buffer_init(&svg);
+
+    if (czint_svg_write(symbol, compact, &svg) || svg.failed) {
+        czint_buffer_free(&svg);
+        return -1;
+    }
+
+    result->data = svg.data;
+    result->size = svg.size;
+    return 0;
+}
+
+
+void czint_render_options_init(czint_render_options *options) {
+    options->angle = 0;
+    options->fgcolor[0] = options->fgcolor[1] = options->fgcolor[2] = 0;
+    options->bgcolor[0] = options->bgcolor[1] = options->bgcolor[2] = 255;
+    memcpy(options->fgcolour, "000000", 6);
+    memcpy(options->bgcolour, "FFFFFF", 6);
+    options->direct = 0;
+    options->compact = 0;
+    czint_png_options_init(&options->png);
+    czint_zpl_options_init(&options->zpl);
+}
+
+void czint_result_set(
+    czint_result *result, struct zint_symbol *symbol, int res
+) {
+    result->res = res;
+    result->symbology = symbol->symbology;
+    if (res > 0) {
+        memcpy(result->errtxt, symbol->errtxt, sizeof(result->errtxt));
+        result->errtxt[sizeof(result->errtxt) - 1] = '\0';
+    }
+}
+
+void czint_result_error(czint_result *result, const char *errtxt) {
+    result->res = ZINT_ERROR_MEMORY;
+    strncpy(result->errtxt, errtxt, sizeof(result->errtxt) - 1);
+}
+
+/* Bit reversed 7 bit values, encoded_data keeps module x of a row in
+ * bit x % 7 of byte x / 7 (see module_is_set), output wants the first
+ * module in the most significant bit. */
+static unsigned char czint_matrix_reversed[128];
+static pthread_once_t czint_matrix_once = PTHREAD_ONCE_INIT;
+
+static void czint_matrix_init(void) {
+    for (int value = 0; value < 128; value++) {
+        unsigned char reversed = 0;
+        for (int bit = 0; bit < 7; bit++) {
+            if (value & (1 << bit)) reversed |= 0x40 >> bit;
+        }
+        czint_matrix_reversed[value] = reversed;
+    }
+}
+
+int czint_make_matrix(const struct zint_symbol *symbol, czint_result *result) {
+    unsigned int width = symbol->width, height = symbol->rows;
+    size_t stride = (width + 7) / 8;
+    unsigned char *data, *out;
+    uint64_t started = czint_stats_start();
+
+    pthread_once(&czint_matrix_once, czint_matrix_init);
+
+    data = malloc(stride * height > 0 ? stride * height : 1);
+    if (data == NULL) return -1;
+
+    for (unsigned int y = 0; y < height; y++) {
+        const unsigned char *row = symbol->encoded_data[y];
+        unsigned char *end;
+        unsigned int acc = 0, bits = 0;
+
+        out = &data[y * stride];
+        end = out + stride;
+
+        /* Last 7 module group may run past width and stride */
+        for (unsigned int x = 0; x < width; x += 7) {
+            acc = (acc << 7) | czint_matrix_reversed[*row++ & 0x7F];
+            bits += 7;
+            if (bits >= 8) {
+                bits -= 8;
+                if (out < end) *out++ = (unsigned char) (acc >> bits);
+            }
+        }
+        if (bits > 0 && out < end) *out = (unsigned char) (acc << (8 - bits));
+        if (width % 8) end[-1] &= 0xFF << (8 - width % 8);
+    }
+
+    result->data = (char *) data;
+    result->size = stride * height;
+    result->width = width;
+    result->height = height;
+    result->stride = stride;
+    result->offset = 0;
+
+    czint_stats_add(symbol->symbology, CZINT_STATS_MATRIX, started, result->size);
+    return 0;
+}
+
+/* Render 1bit bmp, straight from module matrix when asked and possible.
+ * Called without GIL. */
+int czint_render_bmp_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_result *result
+) {
+    uint64_t started = czint_stats_start();
+    int res;
+
+    if (options->direct) {
+        res = czint_make_bmp_direct(
+            symbol, options->angle,
+            options->fgcolor, options->bgcolor, result
+        );
+        if (res < 0) return czint_symbol_oom(symbol);
+        if (res == 0) {
+            czint_stats_add(symbol->symbology, CZINT_STATS_BMP, started, result->size);
+            return 0;
+        }
+        started = czint_stats_start();
+    }
+
+    res = ZBarcode_Buffer(symbol, options->angle);
+    czint_stats_add(
+        symbol->symbology, CZINT_STATS_RASTER, started,
+        res ? 0 : (uint64_t) symbol->bitmap_width * symbol->bitmap_height * 3
+    );
+    if (res) return res;
+
+    started = czint_stats_start();
+    if (czint_make_bmp(
+        symbol, options->fgcolor, options->bgcolor, result
+    )) return czint_symbol_oom(symbol);
+    czint_stats_add(symbol->symbology, CZINT_STATS_BMP, started, result->size);
+    return 0;
+}
+
+/* Compress rows of rendered 1bit bmp into png. Called without GIL. */
+int czint_make_png(
+    const czint_result *bmp, const czint_render_options *options,
+    czint_result *result
+) {
+    czint_buffer png;
+    const unsigned char *top = (const unsigned char *) bmp->data +
+        bmp->offset + (bmp->height ? bmp->height - 1 : 0) * bmp->stride;
+
+    czint_buffer_init(&png);
+
+    if (czint_png_write(
+        &png, top, -(ptrdiff_t) bmp->stride, bmp->width, bmp->height,
+        options->fgcolor, options->bgcolor, &options->png
+    )) {
+        czint_buffer_free(&png);
+        return -1;
+    }
+
+    result->data = png.data;
+    result->size = png.size;
+    result->width = bmp->width;
+    result->height = bmp->height;
+    return 0;
+}
+
+/* Convert rows of rendered 1bit bmp into printer graphics. Called
+ * without GIL. */
+int czint_make_label(
+    const czint_result *bmp, int format,
+    const czint_render_options *options, czint_result *result
+) {
+    czint_buffer label;
+    const unsigned char *top = (const unsigned char *) bmp->data +
+        bmp->offset + (bmp->height ? bmp->height - 1 : 0) * bmp->stride;
+    int res;
+
+    czint_buffer_init(&label);
+
+    if (format == CZINT_FORMAT_ZPL) {
+        res = czint_zpl_write(
+            &label, top, -(ptrdiff_t) bmp->stride, bmp->width, bmp->height,
+            &options->zpl
+        );
+    } else {
+        res = czint_escpos_write(
+            &label, top, -(ptrdiff_t) bmp->stride, bmp->width, bmp->height
+        );
+    }
+
+    if (res) {
+        czint_buffer_free(&label);
+        return -1;
+    }
+
+    result->data = label.data;
+    result->size = label.size;
+    result->width = bmp->width;
+    result->height = bmp->height;
+    return 0;
+}
+
+/* Vector stage in colors of options */
+static int czint_vector_symbol(
+    struct zint_symbol *symbol, const czint_render_options *options
+) {
+    uint64_t started;
+    int res;
+
+    memcpy(symbol->fgcolour, options->fgcolour, sizeof(options->fgcolour));
+    memcpy(symbol->bgcolour, options->bgcolour, sizeof(options->bgcolour));
+
+    started = czint_stats_start();
+    res = ZBarcode_Buffer_Vector(symbol, options->angle);
+    czint_stats_add(symbol->symbology, CZINT_STATS_VECTOR, started, 0);
+    return res;
+}
+
+/* Run raster or vector stage on an encoded symbol and serialize it.
+ * Called without GIL. */
+void czint_render_symbol(
+    struct zint_symbol *symbol, int format,
+    const czint_render_options *options, czint_result *result
+) {
+    czint_result bmp = {0};
+    uint64_t started;
+    int res;
+
+    switch (format) {
+        case CZINT_FORMAT_BMP:
+            res = czint_render_bmp_symbol(symbol, options, result);
+            break;
+        case CZINT_FORMAT_PNG:
+            res = czint_render_bmp_symbol(symbol, options, &bmp);
+            if (res == 0) {
+                started = czint_stats_start();
+                if (czint_make_png(&bmp, options, result)) {
+                    res = czint_symbol_oom(symbol);
+                } else {
+                    czint_stats_add(symbol->symbology, CZINT_STATS_PNG, started, result->size);
+                }
+            }
+            free(bmp.data);
+            break;
+        case CZINT_FORMAT_ZPL:
+        case CZINT_FORMAT_ESCPOS:
+            res = czint_render_bmp_symbol(symbol, options, &bmp);
+            if (res == 0) {
+                started = czint_stats_start();
+                if (czint_make_label(&bmp, format, options, result)) {
+                    res = czint_symbol_oom(symbol);
+                } else {
+                    czint_stats_add(
+                        symbol->symbology,
+                        format == CZINT_FORMAT_ZPL ? CZINT_STATS_ZPL : CZINT_STATS_ESCPOS,
+                        started, result->size
+                    );
+                }
+            }
+            free(bmp.data);
+            break;
+        default:
+            res = czint_vector_symbol(symbol, options);
+            if (res) break;
+
+            started = czint_stats_start();
+            if (czint_make_svg(symbol, options->compact, result)) {
+                res = czint_symbol_oom(symbol);
+                break;
+            }
+            czint_stats_add(symbol->symbology, CZINT_STATS_SVG, started, result->size);
+            break;
+    }
+
+    czint_result_set(result, symbol, res);
+}
+
+
+/* Error of failed sink write, reported through symbol like zint does */
+static int czint_sink_status(struct zint_symbol *symbol, const czint_sink *sink) {
+    if (!sink->failed) return 0;
+
+    strcpy(symbol->errtxt, "Write failed");
+    return ZINT_ERROR_FILE_ACCESS;
+}
+
+/* Stream direct image, every pixel row is a pointer to one of shared
+ * lines. Returns like czint_make_bmp_direct. */
+static int czint_stream_bmp_direct(
+    struct zint_symbol *symbol, const czint_render_options *options,
+    czint_sink *sink
+) {
+    char header[CZINT_BMP_HEADER_SIZE];
+    czint_direct_rows rows;
+    czint_stream stream;
+    int res;
+
+    res = czint_direct_rows_init(symbol, options->angle, &rows);
+    if (res) return res;
+
+    czint_bmp_header(
+        header, CZINT_BMP_HEADER_SIZE + rows.stride * rows.height,
+        rows.width, rows.height, options->fgcolor, options->bgcolor
+    );
+
+    czint_stream_init(&stream, sink);
+    czint_stream_add(&stream, header, sizeof(header));
+    for (unsigned int y = rows.height; y-- > 0;) {
+        if (czint_stream_add(
+            &stream, czint_direct_line(&rows, rows.index[y]), rows.stride
+        )) break;
+    }
+    czint_stream_flush(&stream);
+
+    czint_direct_rows_free(&rows);
+    return 0;
+}
+
+/* Pack buffered symbol->bitmap into chunks of rows, returns -1 when
+ * out of memory */
+static int czint_stream_bmp_raster(
+    struct zint_symbol *symbol, const czint_render_options *options,
+    czint_sink *sink
+) {
+    char header[CZINT_BMP_HEADER_SIZE];
+    czint_stream stream;
+    unsigned char *chunk;
+    unsigned int width = symbol->bitmap_width;
+    unsigned int height = symbol->bitmap_height;
+    size_t stride, capacity, used, position = 0;
+    size_t size = czint_bmp_size(width, height, &stride);
+
+    used = (width + 7) / 8;
+    capacity = stride > CZINT_STREAM_CHUNK ? stride : CZINT_STREAM_CHUNK;
+    chunk = malloc(capacity);
+    if (chunk == NULL) return -1;
+
+    czint_bmp_header(
+        header, size, width, height, options->fgcolor, options->bgcolor
+    );
+
+    czint_stream_init(&stream, sink);
+    czint_stream_add(&stream, header, sizeof(header));
+
+    for (int y = height - 1; y >= 0; y--) {
+        if (position + stride > capacity) {
+            if (czint_stream_flush(&stream)) break;
+            position = 0;
+        }
+
+        czint_pack_row(
+            (const unsigned char *) &symbol->bitmap[(size_t) y * width * 3],
+            width, &chunk[position]
+        );
+        memset(&chunk[position + used], 0, stride - used);
+
+        if (czint_stream_add(&stream, &chunk[position], stride)) break;
+        position += stride;
+    }
+    czint_stream_flush(&stream);
+
+    free(chunk);
+    return 0;
+}
+
+/* Called without GIL. */
+int czint_stream_bmp_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_sink *sink
+) {
+    uint64_t started = czint_stats_start();
+    int res;
+
+    if (options->direct) {
+        res = czint_stream_bmp_direct(symbol, options, sink);
+        if (res < 0) return czint_symbol_oom(symbol);
+        if (res == 0) {
+            czint_stats_add(symbol->symbology, CZINT_STATS_BMP, started, sink->size);
+            return czint_sink_status(symbol, sink);
+        }
+        started = czint_stats_start();
+    }
+
+    res = ZBarcode_Buffer(symbol, options->angle);
+    czint_stats_add(
+        symbol->symbology, CZINT_STATS_RASTER, started,
+        res ? 0 : (uint64_t) symbol->bitmap_width * symbol->bitmap_height * 3
+    );
+    if (res) return res;
+
+    started = czint_stats_start();
+    if (czint_stream_bmp_raster(symbol, options, sink)) return czint_symbol_oom(symbol);
+    czint_stats_add(symbol->symbology, CZINT_STATS_BMP, started, sink->size);
+    return czint_sink_status(symbol, sink);
+}
+
+/* Called without GIL. */
+int czint_stream_svg_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_sink *sink
+) {
+    czint_buffer svg;
+    uint64_t started;
+    int res;
+
+    res = czint_vector_symbol(symbol, options);
+    if (res) return res;
+
+    started = czint_stats_start();
+    czint_buffer_init_sink(&svg, sink);
+
+    res = czint_svg_write(symbol, options->compact, &svg);
+    if (res == 0) czint_buffer_flush(&svg);
+    if (svg.failed) res = -1;
+    czint_buffer_free(&svg);
+
+    if (sink->failed) return czint_sink_status(symbol, sink);
+    if (res) return czint_symbol_oom(symbol);
+
+    czint_stats_add(symbol->symbology, CZINT_STATS_SVG, started, sink->size);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef _PYZINT_RENDER_H
+#define _PYZINT_RENDER_H
+
+#include <stddef.h>
+
+#include "src/zint/backend/zint.h"
+
+#include "zint_label.h"
+#include "zint_png.h"
+#include "zint_stream.h"
+
+#define CZINT_FORMAT_BMP 0
+#define CZINT_FORMAT_SVG 1
+#define CZINT_FORMAT_PNG 2
+#define CZINT_FORMAT_ZPL 3
+#define CZINT_FORMAT_ESCPOS 4
+
+#define CZINT_SCALE_MAX 10
+
+#define CZINT_BMP_HEADER_SIZE 62
+
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    unsigned int width;
+    unsigned int height;
+    size_t stride;
+    size_t offset;
+    int symbology;      /* of rendered symbol, for stats */
+    int res;
+    char errtxt[sizeof(((struct zint_symbol *) 0)->errtxt)];
+} czint_result;
+
+typedef struct {
+    int angle;
+    unsigned int fgcolor[3];
+    unsigned int bgcolor[3];
+    char fgcolour[6];
+    char bgcolour[6];
+    int direct;
+    int compact;
+    czint_png_options png;
+    czint_zpl_options zpl;
+} czint_render_options;
+
+/* Geometry of symbol drawn straight from encoded module matrix. Units
+ * are modules, k is pixels per module. */
+typedef struct {
+    unsigned int k;
+    int width;
+    int height;
+    int xoffset;
+    int border;
+    int box;
+    int bind_rows;
+    float large_bar_height;
+} czint_direct_layout;
+
+/* Output sizes of encoded symbol in pixels, vector ones as written
+ * into svg header, -1 when unknown */
+typedef struct {
+    int bitmap_width;
+    int bitmap_height;
+    int vector_width;
+    int vector_height;
+} czint_measure;
+
+/* Select row packer for the running CPU, safe to call many times */
+void czint_render_init(void);
+
+/* Default options: angle 0, black on white, png level 6, zpl z64 */
+void czint_render_options_init(czint_render_options *options);
+
+void czint_result_set(czint_result *result, struct zint_symbol *symbol, int res);
+void czint_result_error(czint_result *result, const char *errtxt);
+
+/* Set "Insufficient memory" error on symbol, returns ZINT_ERROR_MEMORY */
+int czint_symbol_oom(struct zint_symbol *symbol);
+
+/* Size of 1bit bmp file, rows are padded to 4 bytes */
+size_t czint_bmp_size(unsigned int width, unsigned int height, size_t *stride);
+
+/* Allocate bmp for width x height image and write header and palette,
+ * pixels is set to the bottom row. When result->data is preset bmp is
+ * written there if it fits into result->capacity bytes, otherwise only
+ * result sizes are filled and 1 is returned. Returns -1 when out of
+ * memory. */
+int czint_bmp_begin(
+    unsigned int width, unsigned int height,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result, unsigned char **pixels
+);
+
+/* Whether symbol may be drawn straight from module matrix, 0 if so */
+int czint_direct_layout_init(
+    const struct zint_symbol *symbol, int angle, czint_direct_layout *layout
+);
+
+/* Sizes raster and vector stages would give encoded symbol rotated by
+ * angle, computed without running them. Returns -1 for symbols zint
+ * draws with its own plotters (MaxiCode, dotty mode) and UPC/EAN with
+ * text. */
+int czint_measure_symbol(
+    const struct zint_symbol *symbol, int angle, czint_measure *measure
+);
+
+/* Serializers of buffered or encoded symbol. They return 0 on success
+ * and -1 when out of memory, czint_make_bmp_direct also returns 1 for
+ * symbols which need raster stage. */
+int czint_make_bmp(
+    struct zint_symbol *symbol,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result
+);
+int czint_make_bmp_direct(
+    struct zint_symbol *symbol, int angle,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *result
+);
+int czint_make_svg(struct zint_symbol *symbol, int compact, czint_result *result);
+
+/* Module matrix of encoded symbol, rows x width bits, most significant
+ * bit first, set bit is a dark module. Rows are (width + 7) / 8 bytes
+ * without padding. */
+int czint_make_matrix(const struct zint_symbol *symbol, czint_result *result);
+int czint_make_png(
+    const czint_result *bmp, const czint_render_options *options,
+    czint_result *result
+);
+
+/* Printer graphics of rendered bmp, CZINT_FORMAT_ZPL or
+ * CZINT_FORMAT_ESCPOS. Foreground is printed whatever the colors. */
+int czint_make_label(
+    const czint_result *bmp, int format,
+    const czint_render_options *options, czint_result *result
+);
+
+/* Raster stage and bmp, direct when asked and possible. Returns zint
+ * error code. */
+int czint_render_bmp_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_result *result
+);
+
+/* Run raster or vector stage on an encoded symbol and serialize it in
+ * format, errors are reported through result. */
+void czint_render_symbol(
+    struct zint_symbol *symbol, int format,
+    const czint_render_options *options, czint_result *result
+);
+
+/* Raster or vector stage on an encoded symbol, serialized straight
+ * into sink in CZINT_STREAM_CHUNK pieces instead of whole image.
+ * Returns zint error code, ZINT_ERROR_FILE_ACCESS when sink failed. */
+int czint_stream_bmp_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_sink *sink
+);
+int czint_stream_svg_symbol(
+    struct zint_symbol *symbol,
+    const czint_render_options *options, czint_sink *sink
+);
+
+#endif
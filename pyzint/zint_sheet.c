@@ -0,0 +1,229 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "zint_pool.h"
+#include "zint_sheet.h"
+
+
+typedef struct {
+    long y;
+    size_t index;
+} czint_sheet_order;
+
+typedef struct {
+    size_t index;
+    czint_result bmp;
+} czint_sheet_tile;
+
+typedef struct {
+    const czint_sheet *sheet;
+    unsigned char *pixels;      /* bottom row of page */
+    size_t stride;
+    czint_sheet_tile **live;    /* rendered tiles crossing current band */
+    size_t nlive;
+    size_t first_new;
+    long band_start;
+    long band_end;
+} czint_sheet_state;
+
+
+static int czint_sheet_order_compare(const void *a, const void *b) {
+    const czint_sheet_order *left = a, *right = b;
+
+    if (left->y != right->y) return left->y < right->y ? -1 : 1;
+    if (left->index != right->index) return left->index < right->index ? -1 : 1;
+    return 0;
+}
+
+/* AND count bits of src into dst starting at bit offset, bits 0 of
+ * src are foreground and win */
+static void czint_sheet_bits_and(
+    unsigned char *dst, size_t offset, const unsigned char *src, size_t count
+) {
+    unsigned int shift = offset % 8, rest = count % 8;
+    size_t full = count / 8, i;
+    unsigned char value;
+
+    dst += offset / 8;
+
+    if (shift == 0) {
+        for (i = 0; i < full; i++) dst[i] &= src[i];
+        if (rest) dst[full] &= src[full] | (0xFF >> rest);
+        return;
+    }
+
+    for (i = 0; i < full; i++) {
+        dst[i] &= (src[i] >> shift) | (0xFF << (8 - shift));
+        dst[i + 1] &= (src[i] << (8 - shift)) | (0xFF >> shift);
+    }
+
+    if (rest) {
+        value = src[full] | (0xFF >> rest);
+        dst[full] &= (value >> shift) | (0xFF << (8 - shift));
+        if (shift + rest > 8) {
+            dst[full + 1] &= (value << (8 - shift)) | (0xFF >> shift);
+        }
+    }
+}
+
+static void czint_sheet_render_job(void *ctx, size_t index) {
+    czint_sheet_state *state = ctx;
+    czint_sheet_tile *tile = state->live[state->first_new + index];
+
+    state->sheet->render(state->sheet->ctx, tile->index, &tile->bmp);
+}
+
+/* Blit rows [start, end) of every live tile, jobs own disjoint rows */
+static void czint_sheet_blit_job(void *ctx, size_t index) {
+    czint_sheet_state *state = ctx;
+    const czint_sheet *sheet = state->sheet;
+    long start = state->band_start + (long) index * CZINT_SHEET_CHUNK;
+    long end = start + CZINT_SHEET_CHUNK;
+
+    if (end > state->band_end) end = state->band_end;
+
+    for (size_t t = 0; t < state->nlive; t++) {
+        const czint_sheet_tile *tile = state->live[t];
+        const czint_sheet_box *box = &sheet->boxes[tile->index];
+        const czint_result *bmp = &tile->bmp;
+        long width = bmp->width, height = bmp->height, from, to;
+
+        if (width > box->width) width = box->width;
+        if (width > (long) sheet->width - box->x) width = sheet->width - box->x;
+        if (height > box->height) height = box->height;
+
+        from = box->y > start ? box->y : start;
+        to = box->y + height < end ? box->y + height : end;
+
+        for (long y = from; y < to; y++) {
+            long row = y - box->y;
+
+            czint_sheet_bits_and(
+                &state->pixels[(sheet->height - 1 - y) * state->stride],
+                (size_t) box->x,
+                (const unsigned char *) bmp->data + bmp->offset +
+                    (bmp->height - 1 - row) * bmp->stride,
+                (size_t) width
+            );
+        }
+    }
+}
+
+static long czint_sheet_bottom(const czint_sheet *sheet, const czint_sheet_tile *tile) {
+    const czint_sheet_box *box = &sheet->boxes[tile->index];
+    long height = tile->bmp.height;
+
+    return box->y + (height < box->height ? height : box->height);
+}
+
+int czint_sheet_compose(
+    const czint_sheet *sheet,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *page, size_t *failed
+) {
+    czint_sheet_state state;
+    czint_sheet_order *order = NULL;
+    czint_sheet_tile *tiles = NULL;
+    size_t next = 0, used, i;
+    int res = -1;
+
+    memset(&state, 0, sizeof(state));
+    state.sheet = sheet;
+
+    order = malloc((sheet->count ? sheet->count : 1) * sizeof(czint_sheet_order));
+    tiles = calloc(sheet->count ? sheet->count : 1, sizeof(czint_sheet_tile));
+    state.live = malloc((sheet->count ? sheet->count : 1) * sizeof(czint_sheet_tile *));
+    if (order == NULL || tiles == NULL || state.live == NULL) goto exit;
+
+    if (czint_bmp_begin(
+        sheet->width, sheet->height, fgcolor, bgcolor, page, &state.pixels
+    )) goto exit;
+    state.stride = page->stride;
+
+    /* Background with cleared row padding, like czint_make_bmp */
+    used = (sheet->width + 7) / 8;
+    for (unsigned int y = 0; y < sheet->height; y++) {
+        unsigned char *row = &state.pixels[y * state.stride];
+
+        memset(row, 0xFF, used);
+        memset(&row[used], 0, state.stride - used);
+        if (sheet->width % 8) row[used - 1] &= 0xFF << (8 - sheet->width % 8);
+    }
+
+    for (i = 0; i < sheet->count; i++) {
+        order[i].y = sheet->boxes[i].y;
+        order[i].index = i;
+        tiles[i].index = i;
+    }
+    qsort(order, sheet->count, sizeof(czint_sheet_order), czint_sheet_order_compare);
+
+    for (
+        state.band_start = 0;
+        state.band_start < (long) sheet->height;
+        state.band_start += CZINT_SHEET_BAND
+    ) {
+        size_t kept = 0;
+
+        state.band_end = state.band_start + CZINT_SHEET_BAND;
+        if (state.band_end > (long) sheet->height) state.band_end = sheet->height;
+
+        state.first_new = state.nlive;
+        while (next < sheet->count && order[next].y < state.band_end) {
+            czint_sheet_tile *tile = &tiles[order[next++].index];
+
+            if (sheet->boxes[tile->index].x >= (long) sheet->width) continue;
+            state.live[state.nlive++] = tile;
+        }
+
+        czint_pool_map(
+            state.nlive - state.first_new, sheet->threads,
+            czint_sheet_render_job, &state
+        );
+
+        for (i = state.first_new; i < state.nlive; i++) {
+            czint_sheet_tile *tile = state.live[i];
+
+            if (tile->bmp.res > 0) {
+                page->res = tile->bmp.res;
+                memcpy(page->errtxt, tile->bmp.errtxt, sizeof(page->errtxt));
+                *failed = tile->index;
+                res = 1;
+                goto exit;
+            }
+        }
+
+        czint_pool_map(
+            (size_t) (state.band_end - state.band_start + CZINT_SHEET_CHUNK - 1) /
+                CZINT_SHEET_CHUNK,
+            sheet->threads, czint_sheet_blit_job, &state
+        );
+
+        /* Keep only tiles reaching into the next band */
+        for (i = 0; i < state.nlive; i++) {
+            czint_sheet_tile *tile = state.live[i];
+
+            if (czint_sheet_bottom(sheet, tile) > state.band_end) {
+                state.live[kept++] = tile;
+            } else {
+                free(tile->bmp.data);
+                tile->bmp.data = NULL;
+            }
+        }
+        state.nlive = kept;
+    }
+
+    res = 0;
+
+exit:
+    if (tiles != NULL) {
+        for (i = 0; i < sheet->count; i++) free(tiles[i].bmp.data);
+    }
+    if (res) {
+        free(page->data);
+        page->data = NULL;
+    }
+    free(state.live);
+    free(tiles);
+    free(order);
+    return res;
+}
@@ -0,0 +1,51 @@
+#ifndef _PYZINT_SHEET_H
+#define _PYZINT_SHEET_H
+
+#include <stddef.h>
+
+#include "zint_render.h"
+
+/* Page rows composed per pass, tiles are rendered when the band they
+ * start in is reached and freed after the band they end in */
+#define CZINT_SHEET_BAND 256
+
+/* Largest page side in pixels, keeps bmp size within 32 bits */
+#define CZINT_SHEET_MAX_SIZE 65535
+
+/* Page rows blitted per pool job */
+#define CZINT_SHEET_CHUNK 16
+
+/* Where a tile goes, it is clipped to width x height and to the page */
+typedef struct {
+    long x;
+    long y;
+    long width;
+    long height;
+} czint_sheet_box;
+
+/* Render tile into 1bit bmp, errors are reported through bmp->res.
+ * Called without GIL from pool threads. */
+typedef void (*czint_sheet_render_fn)(void *ctx, size_t index, czint_result *bmp);
+
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+    const czint_sheet_box *boxes;
+    size_t count;
+    czint_sheet_render_fn render;
+    void *ctx;
+    int threads;
+} czint_sheet;
+
+/* Compose tiles into 1bit bmp page, foreground of every tile is drawn
+ * over the page background. Returns 0 on success, -1 when out of
+ * memory and 1 when a tile failed to render, then page->res and
+ * page->errtxt hold its error and *failed its index. Called without
+ * GIL. */
+int czint_sheet_compose(
+    const czint_sheet *sheet,
+    const unsigned int *fgcolor, const unsigned int *bgcolor,
+    czint_result *page, size_t *failed
+);
+
+#endif
@@ -0,0 +1,475 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "zint_shm.h"
+
+
+#define CZINT_SHM_MAGIC 0x70797a696e74ULL      /* "pyzint" */
+#define CZINT_SHM_VERSION 1
+
+#define CZINT_SHM_EMPTY 0
+#define CZINT_SHM_FORMATTING 1
+#define CZINT_SHM_READY 2
+
+#define CZINT_SHM_WAYS 8
+/* Part of segment given to index, the rest holds records */
+#define CZINT_SHM_INDEX_SHARE 16
+/* Torn slot reads before giving up on a slot */
+#define CZINT_SHM_RETRIES 64
+/* Yields before giving up on writer lock or formatting segment */
+#define CZINT_SHM_SPINS 1024
+
+/* Start of segment. Counters are updated by every process. */
+struct czint_shm_header {
+    uint32_t state;
+    uint32_t version;
+    uint64_t magic;
+    uint64_t size;
+    uint64_t bucket_count;      /* power of two */
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint32_t writer;            /* pid holding writer lock, 0 if free */
+    uint32_t reserved;
+    uint64_t head;              /* ring position of next record, only grows */
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+};
+
+#define CZINT_SHM_HEADER_SIZE ((sizeof(czint_shm_header) + 63) & ~(size_t) 63)
+
+/* Index slot, seq is odd while a writer changes it */
+typedef struct {
+    uint32_t seq;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t reserved;
+    uint64_t hash;
+    uint64_t pos;
+} czint_shm_slot;
+
+/* Record in ring, key and value follow it */
+typedef struct {
+    uint64_t pos;
+    uint64_t hash;
+    uint32_t key_size;
+    uint32_t value_size;
+} czint_shm_record;
+
+
+static size_t czint_shm_record_size(size_t key_size, size_t value_size) {
+    return (sizeof(czint_shm_record) + key_size + value_size + 7) & ~(size_t) 7;
+}
+
+static czint_shm_slot *czint_shm_bucket(czint_shm_header *header, uint64_t hash) {
+    czint_shm_slot *slots = (czint_shm_slot *) (
+        (unsigned char *) header + CZINT_SHM_HEADER_SIZE
+    );
+    return &slots[(hash & (header->bucket_count - 1)) * CZINT_SHM_WAYS];
+}
+
+/* Record slot points to while head is where it is, NULL when it was
+ * overwritten already or slot holds garbage */
+static czint_shm_record *czint_shm_record_at(
+    czint_shm_header *header, const czint_shm_slot *slot, uint64_t head
+) {
+    size_t length = czint_shm_record_size(slot->key_size, slot->value_size);
+    uint64_t offset = slot->pos % header->data_size;
+
+    if (slot->key_size == 0) return NULL;
+    if (slot->pos >= head || head - slot->pos > header->data_size) return NULL;
+    if (length > header->data_size - offset) return NULL;
+
+    return (czint_shm_record *) (
+        (unsigned char *) header + header->data_offset + offset
+    );
+}
+
+/* Consistent copy of slot, -1 while writers keep changing it */
+static int czint_shm_slot_read(czint_shm_slot *slot, czint_shm_slot *copy) {
+    for (int i = 0; i < CZINT_SHM_RETRIES; i++) {
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+        if (seq & 1) continue;
+
+        copy->key_size = __atomic_load_n(&slot->key_size, __ATOMIC_RELAXED);
+        copy->value_size = __atomic_load_n(&slot->value_size, __ATOMIC_RELAXED);
+        copy->hash = __atomic_load_n(&slot->hash, __ATOMIC_RELAXED);
+        copy->pos = __atomic_load_n(&slot->pos, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) return 0;
+    }
+    return -1;
+}
+
+static void czint_shm_slot_write(czint_shm_slot *slot, const czint_shm_slot *value) {
+    /* Odd already when previous writer died half way */
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) | 1;
+
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&slot->key_size, value->key_size, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->value_size, value->value_size, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->hash, value->hash, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->pos, value->pos, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+static int czint_shm_lock(czint_shm_header *header) {
+    uint32_t self = (uint32_t) getpid();
+    int saved = errno;
+
+    for (int i = 0; i < CZINT_SHM_SPINS; i++) {
+        uint32_t owner = 0;
+
+        if (__atomic_compare_exchange_n(
+            &header->writer, &owner, self, 0,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+        )) {
+            errno = saved;
+            return 0;
+        }
+
+        /* Lock of a process killed while storing is taken over */
+        if (owner != self && kill((pid_t) owner, 0) == -1 && errno == ESRCH) {
+            __atomic_compare_exchange_n(
+                &header->writer, &owner, 0, 0,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED
+            );
+            continue;
+        }
+        sched_yield();
+    }
+
+    errno = saved;
+    return -1;
+}
+
+static void czint_shm_unlock(czint_shm_header *header) {
+    __atomic_store_n(&header->writer, 0, __ATOMIC_RELEASE);
+}
+
+static void czint_shm_format(czint_shm_header *header, size_t size) {
+    size_t bucket_size = CZINT_SHM_WAYS * sizeof(czint_shm_slot);
+    size_t index = size / CZINT_SHM_INDEX_SHARE;
+    uint64_t buckets = 1;
+
+    while (buckets * 2 * bucket_size <= index) buckets *= 2;
+
+    header->version = CZINT_SHM_VERSION;
+    header->magic = CZINT_SHM_MAGIC;
+    header->size = size;
+    header->bucket_count = buckets;
+    header->data_offset = CZINT_SHM_HEADER_SIZE + buckets * bucket_size;
+    header->data_size = (size - header->data_offset) & ~(uint64_t) 7;
+
+    memset(
+        (unsigned char *) header + CZINT_SHM_HEADER_SIZE, 0,
+        buckets * bucket_size
+    );
+}
+
+/* Format fresh segment or wait for process formatting it, then check
+ * layout so garbage can't send readers out of the mapping */
+static int czint_shm_attach(czint_shm *shm) {
+    czint_shm_header *header = shm->header;
+    uint32_t state = CZINT_SHM_EMPTY;
+    uint64_t index;
+
+    if (__atomic_compare_exchange_n(
+        &header->state, &state, CZINT_SHM_FORMATTING, 0,
+        __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE
+    )) {
+        czint_shm_format(header, shm->size);
+        __atomic_store_n(&header->state, CZINT_SHM_READY, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+    for (int i = 0; state == CZINT_SHM_FORMATTING && i < CZINT_SHM_SPINS; i++) {
+        sched_yield();
+        state = __atomic_load_n(&header->state, __ATOMIC_ACQUIRE);
+    }
+
+    if (state == CZINT_SHM_FORMATTING) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    if (
+        state != CZINT_SHM_READY ||
+        header->magic != CZINT_SHM_MAGIC ||
+        header->version != CZINT_SHM_VERSION ||
+        header->size < CZINT_SHM_SIZE_MIN || header->size > shm->size ||
+        header->bucket_count == 0 ||
+        (header->bucket_count & (header->bucket_count - 1)) != 0
+    ) return -2;
+
+    index = header->bucket_count * CZINT_SHM_WAYS * sizeof(czint_shm_slot);
+    if (
+        index / CZINT_SHM_WAYS / sizeof(czint_shm_slot) != header->bucket_count ||
+        header->data_offset < CZINT_SHM_HEADER_SIZE + index ||
+        header->data_offset > header->size ||
+        header->data_size == 0 ||
+        header->data_size > header->size - header->data_offset
+    ) return -2;
+
+    return 0;
+}
+
+int czint_shm_open(czint_shm *shm, const char *path, size_t size) {
+    int flags = MAP_SHARED;
+    int fd = -1;
+    void *map;
+    int res;
+
+    memset(shm, 0, sizeof(czint_shm));
+
+    if (path != NULL) {
+        struct stat st;
+
+        fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) return -1;
+
+        /* Another process may grow it at the same time, size of the
+         * file wins over ours */
+        if (
+            fstat(fd, &st) ||
+            (st.st_size == 0 && ftruncate(fd, (off_t) size)) ||
+            fstat(fd, &st)
+        ) {
+            res = errno;
+            close(fd);
+            errno = res;
+            return -1;
+        }
+
+        size = (size_t) st.st_size;
+        if (size < CZINT_SHM_SIZE_MIN) {
+            close(fd);
+            return -2;
+        }
+    } else {
+        flags |= MAP_ANONYMOUS;
+    }
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    res = errno;
+    if (fd >= 0) close(fd);
+    if (map == MAP_FAILED) {
+        errno = res;
+        return -1;
+    }
+
+    shm->header = map;
+    shm->size = size;
+
+    res = czint_shm_attach(shm);
+    if (res) czint_shm_close(shm);
+    return res;
+}
+
+void czint_shm_close(czint_shm *shm) {
+    int saved = errno;
+
+    if (shm->header != NULL) munmap(shm->header, shm->size);
+    shm->header = NULL;
+    shm->size = 0;
+    errno = saved;
+}
+
+int czint_shm_get(
+    czint_shm *shm, const void *key, size_t key_size, uint64_t hash,
+    char **value, size_t *size
+) {
+    czint_shm_header *header = shm->header;
+    czint_shm_slot *slots = czint_shm_bucket(header, hash);
+
+    for (int i = 0; i < CZINT_SHM_WAYS; i++) {
+        czint_shm_record *record;
+        czint_shm_slot slot;
+        char *buffer;
+
+        if (czint_shm_slot_read(&slots[i], &slot)) continue;
+        if (slot.hash != hash || slot.key_size != key_size) continue;
+
+        record = czint_shm_record_at(
+            header, &slot, __atomic_load_n(&header->head, __ATOMIC_ACQUIRE)
+        );
+        if (record == NULL) continue;
+
+        if (
+            record->pos != slot.pos || record->hash != hash ||
+            memcmp(record + 1, key, key_size) != 0
+        ) continue;
+
+        buffer = malloc(slot.value_size ? slot.value_size : 1);
+        if (buffer == NULL) return -1;
+        memcpy(buffer, (unsigned char *) (record + 1) + key_size, slot.value_size);
+
+        /* Writers move head before overwriting, record still alive
+         * after copying was copied whole */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (czint_shm_record_at(
+            header, &slot, __atomic_load_n(&header->head, __ATOMIC_RELAXED)
+        ) == NULL) {
+            free(buffer);
+            continue;
+        }
+
+        __atomic_fetch_add(&header->hits, 1, __ATOMIC_RELAXED);
+        *value = buffer;
+        *size = slot.value_size;
+        return 1;
+    }
+
+    __atomic_fetch_add(&header->misses, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/* Slot to store key in: one holding key, empty or dead one, otherwise
+ * the oldest. Called under writer lock. */
+static czint_shm_slot *czint_shm_victim(
+    czint_shm_header *header, const void *key, size_t key_size,
+    uint64_t hash, uint64_t head, int *evicted
+) {
+    czint_shm_slot *slots = czint_shm_bucket(header, hash);
+    czint_shm_slot *free_slot = NULL, *oldest = NULL;
+
+    for (int i = 0; i < CZINT_SHM_WAYS; i++) {
+        czint_shm_slot *slot = &slots[i];
+        czint_shm_record *record;
+
+        if (slot->seq & 1) {
+            if (free_slot == NULL) free_slot = slot;
+            continue;
+        }
+
+        record = czint_shm_record_at(header, slot, head);
+        if (record == NULL) {
+            if (free_slot == NULL) free_slot = slot;
+            continue;
+        }
+
+        if (
+            slot->hash == hash && slot->key_size == key_size &&
+            memcmp(record + 1, key, key_size) == 0
+        ) {
+            *evicted = 0;
+            return slot;
+        }
+
+        if (oldest == NULL || slot->pos < oldest->pos) oldest = slot;
+    }
+
+    if (free_slot != NULL) {
+        *evicted = 0;
+        return free_slot;
+    }
+
+    *evicted = 1;
+    return oldest;
+}
+
+int czint_shm_put(
+    czint_shm *shm, const void *key, size_t key_size, uint64_t hash,
+    const void *value, size_t size
+) {
+    czint_shm_header *header = shm->header;
+    size_t length = czint_shm_record_size(key_size, size);
+    czint_shm_record *record;
+    czint_shm_slot *slot, update;
+    uint64_t pos, offset;
+    int evicted;
+
+    /* A single record may not flush more than a quarter of the ring */
+    if (
+        key_size == 0 || key_size > UINT32_MAX || size > UINT32_MAX ||
+        length > header->data_size / 4
+    ) return 1;
+
+    if (czint_shm_lock(header)) return 1;
+
+    pos = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+    offset = pos % header->data_size;
+    if (length > header->data_size - offset) pos += header->data_size - offset;
+
+    /* Readers of records about to be overwritten see head moved */
+    __atomic_store_n(&header->head, pos + length, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record = (czint_shm_record *) (
+        (unsigned char *) header + header->data_offset + pos % header->data_size
+    );
+    record->pos = pos;
+    record->hash = hash;
+    record->key_size = (uint32_t) key_size;
+    record->value_size = (uint32_t) size;
+    memcpy(record + 1, key, key_size);
+    memcpy((unsigned char *) (record + 1) + key_size, value, size);
+
+    slot = czint_shm_victim(
+        header, key, key_size, hash, pos + length, &evicted
+    );
+
+    memset(&update, 0, sizeof(update));
+    update.key_size = (uint32_t) key_size;
+    update.value_size = (uint32_t) size;
+    update.hash = hash;
+    update.pos = pos;
+    czint_shm_slot_write(slot, &update);
+
+    czint_shm_unlock(header);
+
+    __atomic_fetch_add(&header->insertions, 1, __ATOMIC_RELAXED);
+    if (evicted) __atomic_fetch_add(&header->evictions, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int czint_shm_clear(czint_shm *shm) {
+    czint_shm_header *header = shm->header;
+    uint64_t head;
+
+    if (czint_shm_lock(header)) return -1;
+
+    /* Every record is a whole ring behind from now on */
+    head = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->head, head + header->data_size, __ATOMIC_RELEASE);
+
+    czint_shm_unlock(header);
+    return 0;
+}
+
+void czint_shm_stats_get(czint_shm *shm, czint_shm_stats *stats) {
+    czint_shm_header *header = shm->header;
+    uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    size_t slot_count = header->bucket_count * CZINT_SHM_WAYS;
+    czint_shm_slot *slots = czint_shm_bucket(header, 0);
+
+    memset(stats, 0, sizeof(czint_shm_stats));
+    stats->hits = __atomic_load_n(&header->hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&header->misses, __ATOMIC_RELAXED);
+    stats->insertions = __atomic_load_n(&header->insertions, __ATOMIC_RELAXED);
+    stats->evictions = __atomic_load_n(&header->evictions, __ATOMIC_RELAXED);
+    stats->slots = slot_count;
+    stats->capacity = header->data_size;
+    stats->size = header->size;
+
+    for (size_t i = 0; i < slot_count; i++) {
+        czint_shm_slot slot;
+
+        if (czint_shm_slot_read(&slots[i], &slot)) continue;
+        if (czint_shm_record_at(header, &slot, head) != NULL) stats->entries++;
+    }
+}
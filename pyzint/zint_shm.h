@@ -0,0 +1,61 @@
+#ifndef _PYZINT_SHM_H
+#define _PYZINT_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CZINT_SHM_SIZE_MIN (64 * 1024)
+#define CZINT_SHM_SIZE_DEFAULT (64 * 1024 * 1024)
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long insertions;
+    unsigned long long evictions;
+    size_t entries;
+    size_t slots;
+    size_t capacity;    /* bytes of record ring */
+    size_t size;        /* bytes of whole segment */
+} czint_shm_stats;
+
+typedef struct czint_shm_header czint_shm_header;
+
+/* Render cache kept in a memory segment mapped by many processes.
+ * Records are appended to a ring, oldest are overwritten first, and
+ * found through a set associative index of slots guarded by seqlocks.
+ * Readers never lock and retry or miss on torn reads, writers of all
+ * processes take turns on a spinlock in the segment and skip storing
+ * when it is busy for too long. */
+typedef struct {
+    czint_shm_header *header;
+    size_t size;
+} czint_shm;
+
+/* Map file at path, creating it with size bytes when empty, or an
+ * anonymous segment shared with forked children when path is NULL.
+ * Existing segments keep their own size. Returns -1 with errno set on
+ * system errors, -2 when the file holds something else. */
+int czint_shm_open(czint_shm *shm, const char *path, size_t size);
+void czint_shm_close(czint_shm *shm);
+
+/* Copy value stored under key into malloc'ed *value. Returns 1 on hit,
+ * 0 on miss and -1 when out of memory. */
+int czint_shm_get(
+    czint_shm *shm, const void *key, size_t key_size, uint64_t hash,
+    char **value, size_t *size
+);
+
+/* Store value under key, replacing older one. Returns 0 when stored,
+ * 1 when it is too big for the segment or writers stay busy. */
+int czint_shm_put(
+    czint_shm *shm, const void *key, size_t key_size, uint64_t hash,
+    const void *value, size_t size
+);
+
+/* Drop every record, for every process mapping the segment. Returns
+ * -1 when writers stay busy. */
+int czint_shm_clear(czint_shm *shm);
+
+void czint_shm_stats_get(czint_shm *shm, czint_shm_stats *stats);
+
+#endif
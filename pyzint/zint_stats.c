@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200112L
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zint_stats.h"
+
+
+/* Counters of one thread. Only the owner writes them, readers sum
+ * them under stats_lock with relaxed loads, so rendering threads never
+ * contend. Reset bumps stats_generation and every thread zeroes its
+ * counters lazily on next add, counters of a stale generation are
+ * skipped by readers. */
+typedef struct czint_stats_thread {
+    czint_stats_symbology *symbologies[CZINT_STATS_SYMBOLOGIES];
+    unsigned long generation;
+    struct czint_stats_thread *next;
+} czint_stats_thread;
+
+const char *const czint_stats_phase_names[CZINT_STATS_PHASES] = {
+    "encode", "raster", "vector", "bmp", "svg", "png", "matrix",
+    "zpl", "escpos", "copy"
+};
+
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static czint_stats_thread *stats_threads = NULL;
+static czint_stats_symbology *stats_retired[CZINT_STATS_SYMBOLOGIES];
+static unsigned long stats_generation = 0;
+static int stats_enabled = 0;
+
+#define CZINT_STATS_LOAD(value) __atomic_load_n(&(value), __ATOMIC_RELAXED)
+#define CZINT_STATS_BUMP(value, by) \
+    __atomic_store_n(&(value), CZINT_STATS_LOAD(value) + (by), __ATOMIC_RELAXED)
+
+
+static void czint_stats_merge(
+    czint_stats_symbology *target, const czint_stats_symbology *source
+) {
+    int phase, i;
+
+    for (phase = 0; phase < CZINT_STATS_PHASES; phase++) {
+        czint_stats_counter *to = &target->phases[phase];
+        const czint_stats_counter *from = &source->phases[phase];
+
+        to->count += CZINT_STATS_LOAD(from->count);
+        to->bytes += CZINT_STATS_LOAD(from->bytes);
+        to->ns += CZINT_STATS_LOAD(from->ns);
+        for (i = 0; i < CZINT_STATS_BUCKETS; i++) {
+            to->histogram[i] += CZINT_STATS_LOAD(from->histogram[i]);
+        }
+    }
+}
+
+/* Keep counts of exited thread. Called with stats_lock held. */
+static void czint_stats_retire(czint_stats_thread *thread) {
+    czint_stats_symbology *block;
+    int i;
+
+    for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+        block = thread->symbologies[i];
+        if (block == NULL) continue;
+
+        if (thread->generation == stats_generation) {
+            if (stats_retired[i] == NULL) {
+                stats_retired[i] = block;
+                continue;
+            }
+            czint_stats_merge(stats_retired[i], block);
+        }
+        free(block);
+    }
+}
+
+static void czint_stats_thread_free(void *arg) {
+    czint_stats_thread *thread = arg, **link;
+
+    pthread_mutex_lock(&stats_lock);
+    for (link = &stats_threads; *link != NULL; link = &(*link)->next) {
+        if (*link == thread) {
+            *link = thread->next;
+            break;
+        }
+    }
+    czint_stats_retire(thread);
+    pthread_mutex_unlock(&stats_lock);
+
+    free(thread);
+}
+
+/* Other threads are gone in the child, their counts stay readable */
+static void czint_stats_atfork_child(void) {
+    pthread_mutex_init(&stats_lock, NULL);
+}
+
+static void czint_stats_once(void) {
+    const char *value = getenv("PYZINT_STATS");
+
+    pthread_key_create(&stats_key, czint_stats_thread_free);
+    pthread_atfork(NULL, NULL, czint_stats_atfork_child);
+
+    if (value != NULL && value[0] != '\0' && strcmp(value, "0") != 0) {
+        __atomic_store_n(&stats_enabled, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void czint_stats_init(void) {
+    pthread_once(&stats_once, czint_stats_once);
+}
+
+int czint_stats_enabled(void) {
+    return __atomic_load_n(&stats_enabled, __ATOMIC_RELAXED);
+}
+
+void czint_stats_set_enabled(int enabled) {
+    czint_stats_init();
+    __atomic_store_n(&stats_enabled, enabled != 0, __ATOMIC_RELAXED);
+}
+
+static uint64_t czint_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+uint64_t czint_stats_start(void) {
+    if (!czint_stats_enabled()) return 0;
+    return czint_stats_now();
+}
+
+static czint_stats_thread *czint_stats_thread_get(void) {
+    czint_stats_thread *thread;
+
+    czint_stats_init();
+
+    thread = pthread_getspecific(stats_key);
+    if (thread != NULL) return thread;
+
+    thread = calloc(1, sizeof(czint_stats_thread));
+    if (thread == NULL) return NULL;
+
+    if (pthread_setspecific(stats_key, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&stats_lock);
+    thread->generation = stats_generation;
+    thread->next = stats_threads;
+    stats_threads = thread;
+    pthread_mutex_unlock(&stats_lock);
+
+    return thread;
+}
+
+static int czint_stats_bucket(uint64_t ns) {
+    int bucket;
+
+    if (ns == 0) return 0;
+
+    bucket = 63 - __builtin_clzll(ns);
+    return bucket < CZINT_STATS_BUCKETS ? bucket : CZINT_STATS_BUCKETS - 1;
+}
+
+void czint_stats_add(
+    int symbology, czint_stats_phase phase, uint64_t started, uint64_t bytes
+) {
+    czint_stats_thread *thread;
+    czint_stats_symbology *block;
+    czint_stats_counter *counter;
+    unsigned long generation;
+    uint64_t elapsed;
+    int i;
+
+    if (started == 0) return;
+    if (symbology < 0 || symbology >= CZINT_STATS_SYMBOLOGIES) return;
+
+    elapsed = czint_stats_now() - started;
+
+    thread = czint_stats_thread_get();
+    if (thread == NULL) return;
+
+    /* Readers skip this thread until its generation is current, so
+     * zeroing here can't be observed half done */
+    generation = __atomic_load_n(&stats_generation, __ATOMIC_ACQUIRE);
+    if (CZINT_STATS_LOAD(thread->generation) != generation) {
+        for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+            if (thread->symbologies[i] != NULL) {
+                memset(thread->symbologies[i], 0, sizeof(czint_stats_symbology));
+            }
+        }
+        __atomic_store_n(&thread->generation, generation, __ATOMIC_RELEASE);
+    }
+
+    block = thread->symbologies[symbology];
+    if (block == NULL) {
+        block = calloc(1, sizeof(czint_stats_symbology));
+        if (block == NULL) return;
+        __atomic_store_n(&thread->symbologies[symbology], block, __ATOMIC_RELEASE);
+    }
+
+    counter = &block->phases[phase];
+    CZINT_STATS_BUMP(counter->count, 1);
+    CZINT_STATS_BUMP(counter->bytes, bytes);
+    CZINT_STATS_BUMP(counter->ns, elapsed);
+    CZINT_STATS_BUMP(counter->histogram[czint_stats_bucket(elapsed)], 1);
+}
+
+void czint_stats_collect(czint_stats_symbology *symbologies) {
+    czint_stats_thread *thread;
+    czint_stats_symbology *block;
+    int i;
+
+    pthread_mutex_lock(&stats_lock);
+
+    for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+        if (stats_retired[i] != NULL) {
+            czint_stats_merge(&symbologies[i], stats_retired[i]);
+        }
+    }
+
+    for (thread = stats_threads; thread != NULL; thread = thread->next) {
+        if (__atomic_load_n(
+            &thread->generation, __ATOMIC_ACQUIRE
+        ) != stats_generation) continue;
+
+        for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+            block = __atomic_load_n(&thread->symbologies[i], __ATOMIC_ACQUIRE);
+            if (block != NULL) czint_stats_merge(&symbologies[i], block);
+        }
+    }
+
+    pthread_mutex_unlock(&stats_lock);
+}
+
+void czint_stats_reset(void) {
+    int i;
+
+    pthread_mutex_lock(&stats_lock);
+
+    __atomic_store_n(&stats_generation, stats_generation + 1, __ATOMIC_RELEASE);
+
+    for (i = 0; i < CZINT_STATS_SYMBOLOGIES; i++) {
+        free(stats_retired[i]);
+        stats_retired[i] = NULL;
+    }
+
+    pthread_mutex_unlock(&stats_lock);
+}
@@ -0,0 +1,63 @@
+#ifndef _PYZINT_STATS_H
+#define _PYZINT_STATS_H
+
+#include <stdint.h>
+
+/* Histogram bucket i counts durations in [2^i, 2^(i+1)) ns, the last
+ * one everything longer */
+#define CZINT_STATS_BUCKETS 32
+
+/* Symbologies are indexed by number, zint ones are all below 256 */
+#define CZINT_STATS_SYMBOLOGIES 256
+
+typedef enum {
+    CZINT_STATS_ENCODE,     /* ZBarcode_Encode, bytes of payload */
+    CZINT_STATS_RASTER,     /* ZBarcode_Buffer, bytes of rgb bitmap */
+    CZINT_STATS_VECTOR,     /* ZBarcode_Buffer_Vector */
+    CZINT_STATS_BMP,        /* bmp packing, direct one includes drawing */
+    CZINT_STATS_SVG,
+    CZINT_STATS_PNG,
+    CZINT_STATS_MATRIX,     /* module matrix packing */
+    CZINT_STATS_ZPL,
+    CZINT_STATS_ESCPOS,
+    CZINT_STATS_COPY,       /* rendered data into bytes object */
+    CZINT_STATS_PHASES
+} czint_stats_phase;
+
+typedef struct {
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t ns;
+    uint64_t histogram[CZINT_STATS_BUCKETS];
+} czint_stats_counter;
+
+typedef struct {
+    czint_stats_counter phases[CZINT_STATS_PHASES];
+} czint_stats_symbology;
+
+extern const char *const czint_stats_phase_names[CZINT_STATS_PHASES];
+
+/* Turn stats on when PYZINT_STATS environment variable is set to
+ * anything but "" or "0". Only the first call looks at it. */
+void czint_stats_init(void);
+
+/* Process wide switch */
+int czint_stats_enabled(void);
+void czint_stats_set_enabled(int enabled);
+
+/* Start of a timed phase, 0 when stats are off */
+uint64_t czint_stats_start(void);
+
+/* Count phase started at `started` into calling thread counters, no-op
+ * when started is 0. Never blocks other threads. */
+void czint_stats_add(
+    int symbology, czint_stats_phase phase, uint64_t started, uint64_t bytes
+);
+
+/* Sum counters of all threads. Symbology counters are stored into
+ * symbologies[CZINT_STATS_SYMBOLOGIES], which must be zeroed. */
+void czint_stats_collect(czint_stats_symbology *symbologies);
+
+void czint_stats_reset(void);
+
+#endif
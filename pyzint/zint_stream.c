@@ -0,0 +1,90 @@
+#include <errno.h>
+#include <unistd.h>
+
+#include "zint_stream.h"
+
+
+void czint_sink_init(
+    czint_sink *sink, int (*write)(void *, struct iovec *, int), void *ctx
+) {
+    sink->write = write;
+    sink->ctx = ctx;
+    sink->size = 0;
+    sink->failed = 0;
+    sink->error = 0;
+}
+
+/* Called without GIL. */
+int czint_sink_fd(void *ctx, struct iovec *iov, int count) {
+    int fd = *(const int *) ctx;
+    ssize_t written;
+
+    while (count > 0) {
+        written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+void czint_stream_init(czint_stream *stream, czint_sink *sink) {
+    stream->sink = sink;
+    stream->count = 0;
+    stream->pending = 0;
+}
+
+int czint_stream_flush(czint_stream *stream) {
+    czint_sink *sink = stream->sink;
+    size_t pending = stream->pending;
+    int count = stream->count;
+
+    if (sink->failed) return -1;
+
+    stream->count = 0;
+    stream->pending = 0;
+    if (count == 0) return 0;
+
+    if (sink->write(sink->ctx, stream->iov, count)) {
+        sink->error = errno;
+        sink->failed = 1;
+        return -1;
+    }
+
+    sink->size += pending;
+    return 0;
+}
+
+int czint_stream_add(czint_stream *stream, const void *data, size_t length) {
+    struct iovec *last = stream->count > 0 ? &stream->iov[stream->count - 1] : NULL;
+
+    if (stream->sink->failed) return -1;
+    if (length == 0) return 0;
+
+    if (last != NULL && (const char *) last->iov_base + last->iov_len == data) {
+        last->iov_len += length;
+    } else {
+        if (stream->count == CZINT_STREAM_IOV && czint_stream_flush(stream)) return -1;
+
+        stream->iov[stream->count].iov_base = (void *) data;
+        stream->iov[stream->count].iov_len = length;
+        stream->count++;
+    }
+
+    stream->pending += length;
+    if (stream->pending >= CZINT_STREAM_CHUNK) return czint_stream_flush(stream);
+    return 0;
+}
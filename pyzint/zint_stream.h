@@ -0,0 +1,50 @@
+#ifndef _PYZINT_STREAM_H
+#define _PYZINT_STREAM_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/* Bytes queued before a stream is flushed into its sink */
+#define CZINT_STREAM_CHUNK 65536
+
+/* Pieces queued before a stream is flushed, writev takes up to IOV_MAX */
+#define CZINT_STREAM_IOV 256
+
+/* Destination of streamed output. write gets every queued piece and may
+ * modify iov while consuming it. It returns 0 when all bytes were
+ * written and -1 on failure, with errno set or Python exception pending
+ * as the sink defines. After a failure nothing more is written. */
+typedef struct {
+    int (*write)(void *ctx, struct iovec *iov, int count);
+    void *ctx;
+    size_t size;    /* bytes written so far */
+    int failed;
+    int error;      /* errno right after failed write */
+} czint_sink;
+
+/* Output queued as pointers into caller memory, which must stay
+ * unchanged until czint_stream_flush. Adjacent pieces are merged. */
+typedef struct {
+    czint_sink *sink;
+    struct iovec iov[CZINT_STREAM_IOV];
+    int count;
+    size_t pending;
+} czint_stream;
+
+void czint_sink_init(
+    czint_sink *sink, int (*write)(void *, struct iovec *, int), void *ctx
+);
+
+/* write of sink to file descriptor pointed by ctx, sets errno. Short
+ * writes are continued and EINTR retried, fd should be blocking. */
+int czint_sink_fd(void *ctx, struct iovec *iov, int count);
+
+void czint_stream_init(czint_stream *stream, czint_sink *sink);
+
+/* Queue length bytes at data, flushing when queue is full. Returns 0
+ * or -1 when sink failed. */
+int czint_stream_add(czint_stream *stream, const void *data, size_t length);
+
+int czint_stream_flush(czint_stream *stream);
+
+#endif
@@ -0,0 +1,125 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zint_symbols.h"
+
+
+typedef struct {
+    int count;
+    struct zint_symbol *items[CZINT_SYMBOL_POOL_MAX];
+} czint_symbol_list;
+
+static pthread_once_t symbols_once = PTHREAD_ONCE_INIT;
+static pthread_key_t symbols_key;
+static struct zint_symbol *symbols_pristine = NULL;
+static int symbols_limit = CZINT_SYMBOL_POOL_DEFAULT;
+
+static czint_symbol_pool_stats symbols_stats;
+
+#define CZINT_STAT_INC(field) \
+    __atomic_add_fetch(&symbols_stats.field, 1, __ATOMIC_RELAXED)
+
+
+static void czint_symbol_list_free(void *arg) {
+    czint_symbol_list *list = arg;
+
+    while (list->count > 0) {
+        ZBarcode_Delete(list->items[--list->count]);
+    }
+    free(list);
+}
+
+static void czint_symbols_init(void) {
+    pthread_key_create(&symbols_key, czint_symbol_list_free);
+    symbols_pristine = ZBarcode_Create();
+}
+
+static czint_symbol_list *czint_symbol_list_get(int create) {
+    czint_symbol_list *list;
+
+    pthread_once(&symbols_once, czint_symbols_init);
+
+    list = pthread_getspecific(symbols_key);
+    if (list == NULL && create) {
+        list = calloc(1, sizeof(czint_symbol_list));
+        if (list != NULL && pthread_setspecific(symbols_key, list) != 0) {
+            free(list);
+            list = NULL;
+        }
+    }
+    return list;
+}
+
+static struct zint_symbol *czint_symbol_pop(void) {
+    czint_symbol_list *list = czint_symbol_list_get(0);
+
+    if (list != NULL && list->count > 0) {
+        CZINT_STAT_INC(reused);
+        return list->items[--list->count];
+    }
+
+    CZINT_STAT_INC(created);
+    return malloc(sizeof(struct zint_symbol));
+}
+
+struct zint_symbol *czint_symbol_acquire(void) {
+    struct zint_symbol *symbol;
+
+    pthread_once(&symbols_once, czint_symbols_init);
+    if (symbols_pristine == NULL) return NULL;
+
+    symbol = czint_symbol_pop();
+    if (symbol == NULL) return NULL;
+
+    memcpy(symbol, symbols_pristine, sizeof(struct zint_symbol));
+    return symbol;
+}
+
+struct zint_symbol *czint_symbol_acquire_copy(const struct zint_symbol *source) {
+    struct zint_symbol *symbol = czint_symbol_pop();
+
+    if (symbol == NULL) return NULL;
+
+    memcpy(symbol, source, sizeof(struct zint_symbol));
+    symbol->bitmap = NULL;
+    symbol->alphamap = NULL;
+    symbol->vector = NULL;
+    return symbol;
+}
+
+void czint_symbol_release(struct zint_symbol *symbol) {
+    czint_symbol_list *list;
+    int limit = __atomic_load_n(&symbols_limit, __ATOMIC_RELAXED);
+
+    if (symbol == NULL) return;
+
+    list = limit > 0 ? czint_symbol_list_get(1) : NULL;
+
+    if (list == NULL || list->count >= limit) {
+        CZINT_STAT_INC(discarded);
+        ZBarcode_Delete(symbol);
+        return;
+    }
+
+    ZBarcode_Clear(symbol);
+    list->items[list->count++] = symbol;
+    CZINT_STAT_INC(pooled);
+}
+
+int czint_symbol_pool_limit(void) {
+    return __atomic_load_n(&symbols_limit, __ATOMIC_RELAXED);
+}
+
+void czint_symbol_pool_set_limit(int limit) {
+    if (limit < 0) limit = 0;
+    if (limit > CZINT_SYMBOL_POOL_MAX) limit = CZINT_SYMBOL_POOL_MAX;
+    __atomic_store_n(&symbols_limit, limit, __ATOMIC_RELAXED);
+}
+
+void czint_symbol_pool_stats_get(czint_symbol_pool_stats *stats) {
+    stats->created = __atomic_load_n(&symbols_stats.created, __ATOMIC_RELAXED);
+    stats->reused = __atomic_load_n(&symbols_stats.reused, __ATOMIC_RELAXED);
+    stats->pooled = __atomic_load_n(&symbols_stats.pooled, __ATOMIC_RELAXED);
+    stats->discarded = __atomic_load_n(&symbols_stats.discarded, __ATOMIC_RELAXED);
+}
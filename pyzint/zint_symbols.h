@@ -0,0 +1,34 @@
+#ifndef _PYZINT_SYMBOLS_H
+#define _PYZINT_SYMBOLS_H
+
+#include "src/zint/backend/zint.h"
+
+#define CZINT_SYMBOL_POOL_DEFAULT 4
+#define CZINT_SYMBOL_POOL_MAX 64
+
+typedef struct {
+    unsigned long long created;
+    unsigned long long reused;
+    unsigned long long pooled;
+    unsigned long long discarded;
+} czint_symbol_pool_stats;
+
+/* Borrow symbol reset to ZBarcode_Create() defaults from per thread
+ * free list. Returns NULL when out of memory. */
+struct zint_symbol *czint_symbol_acquire(void);
+
+/* Borrow symbol holding copy of encoded source without its rendered
+ * output, so several threads may buffer same encoded symbol at once. */
+struct zint_symbol *czint_symbol_acquire_copy(const struct zint_symbol *source);
+
+/* Free rendered output and put symbol back on calling thread free list,
+ * or delete it when list is full. */
+void czint_symbol_release(struct zint_symbol *symbol);
+
+/* Free list length per thread, 0 disables pooling */
+int czint_symbol_pool_limit(void);
+void czint_symbol_pool_set_limit(int limit);
+
+void czint_symbol_pool_stats_get(czint_symbol_pool_stats *stats);
+
+#endif
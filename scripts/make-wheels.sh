@@ -8,11 +8,11 @@ function build_wheel() {
 }
 
 
+build_wheel cp313-cp313
+build_wheel cp312-cp312
+build_wheel cp311-cp311
+build_wheel cp310-cp310
 build_wheel cp39-cp39
-build_wheel cp38-cp38
-build_wheel cp37-cp37m
-build_wheel cp36-cp36m
-build_wheel cp35-cp35m
 
 
 cd ${DST}
@@ -6,6 +6,7 @@ setup(
     description="Python ZINT bindings",
     long_description=open("README.rst").read(),
     packages=["pyzint"],
+    python_requires=">=3.9",
     package_data={"pyzint": ["zint.pyi"], },
     ext_modules=[
         Extension(
@@ -13,6 +14,21 @@ setup(
             [
                 "pyzint/zint.c",
                 "pyzint/zint_misc.c",
+                "pyzint/zint_args.c",
+                "pyzint/zint_buffer.c",
+                "pyzint/zint_cache.c",
+                "pyzint/zint_label.c",
+                "pyzint/zint_pack.c",
+                "pyzint/zint_png.c",
+                "pyzint/zint_pool.c",
+                "pyzint/zint_phases.c",
+                "pyzint/zint_registry.c",
+                "pyzint/zint_render.c",
+                "pyzint/zint_sheet.c",
+                "pyzint/zint_shm.c",
+                "pyzint/zint_stats.c",
+                "pyzint/zint_stream.c",
+                "pyzint/zint_symbols.c",
                 "pyzint/src/zint/backend/mailmark.c",
                 "pyzint/src/zint/backend/hanxin.c",
                 "pyzint/src/zint/backend/common.c",
@@ -65,6 +81,7 @@ setup(
             extra_compile_args=["-g", "-std=c99"],
             include_dirs=["pyzint/src"],
             define_macros=[("NO_PNG", "1")],
+            libraries=["z"],
         ),
     ],
     project_urls={"Source": "https://github.com/Pavkazzz/pyzint"},
@@ -79,11 +96,11 @@ setup(
         "Operating System :: POSIX",
         "Programming Language :: Python",
         "Programming Language :: Python :: 3",
-        "Programming Language :: Python :: 3.5",
-        "Programming Language :: Python :: 3.6",
-        "Programming Language :: Python :: 3.7",
-        "Programming Language :: Python :: 3.8",
         "Programming Language :: Python :: 3.9",
+        "Programming Language :: Python :: 3.10",
+        "Programming Language :: Python :: 3.11",
+        "Programming Language :: Python :: 3.12",
+        "Programming Language :: Python :: 3.13",
         "Programming Language :: Python :: Implementation :: CPython",
     ],
 )
@@ -0,0 +1,80 @@
+import pytest
+
+from pyzint.zint import BARCODE_CODE128, BARCODE_QRCODE, Zint
+
+
+def test_positional_and_keywords():
+    a = Zint("Barcode", BARCODE_QRCODE, 1, 2)
+    b = Zint(data="Barcode", kind=BARCODE_QRCODE, option_1=1, option_2=2)
+    c = Zint(**dict(data="Barcode", kind=BARCODE_QRCODE, option_1=1, option_2=2))
+
+    assert a.render_bmp() == b.render_bmp() == c.render_bmp()
+    assert a.option_1 == b.option_1 == c.option_1 == 1
+
+
+def test_init_again():
+    z = Zint("Barcode", BARCODE_QRCODE)
+    z.__init__("12345", BARCODE_CODE128, scale=2.0, show_text=False)
+
+    assert z.data == "12345"
+    assert z.symbology == BARCODE_CODE128
+    assert z.render_bmp() == Zint(
+        "12345", BARCODE_CODE128, scale=2.0, show_text=False,
+    ).render_bmp()
+
+
+def test_buffer_arguments():
+    z = Zint(b"Barcode", BARCODE_QRCODE, primary=bytearray(b"1"), text=b"t")
+    assert z.render_svg()
+
+
+@pytest.mark.parametrize("args,kwargs,exc", [
+    ((), {}, TypeError),
+    (("data",), {}, TypeError),
+    (("data", BARCODE_QRCODE, 1, 2, 3, 2.0), {}, TypeError),
+    (("data", BARCODE_QRCODE), {"unknown": 1}, TypeError),
+    (("data", BARCODE_QRCODE), {"kind": 1}, TypeError),
+    (("data", BARCODE_QRCODE), {"option_1": 1.5}, TypeError),
+    (("data", BARCODE_QRCODE), {"option_1": "1"}, TypeError),
+    (("data", BARCODE_QRCODE), {"option_1": 2 ** 40}, OverflowError),
+    (("data", 256), {}, OverflowError),
+    (("data", -1), {}, OverflowError),
+    (("data", BARCODE_QRCODE), {"scale": "1"}, TypeError),
+    (("data", BARCODE_QRCODE), {"primary": 1}, TypeError),
+    (("data", BARCODE_QRCODE), {"text": None}, TypeError),
+])
+def test_init_errors(args, kwargs, exc):
+    with pytest.raises(exc):
+        Zint(*args, **kwargs)
+
+
+@pytest.mark.parametrize("method,args,kwargs,exc", [
+    ("render_bmp", (0, "#000000", "#FFFFFF", True, False, 1), {}, TypeError),
+    ("render_bmp", (), {"color": "#000000"}, TypeError),
+    ("render_bmp", (90,), {"angle": 0}, TypeError),
+    ("render_bmp", (), {"fgcolor": None}, TypeError),
+    ("render_bmp", (), {"fgcolor": "#000\0000"}, ValueError),
+    ("render_svg", (), {"angle": 0.5}, TypeError),
+    ("render_png", (), {"level": "9"}, TypeError),
+    ("render_bmp_into", (), {}, TypeError),
+    ("render_bmp_into", (b"readonly",), {}, TypeError),
+    ("bmp_size", (0, True, 1), {}, TypeError),
+    ("render", (), {"formats": ("bmp",), "filter": 1}, TypeError),
+])
+def test_render_errors(method, args, kwargs, exc):
+    z = Zint("Barcode", BARCODE_QRCODE)
+    with pytest.raises(exc):
+        getattr(z, method)(*args, **kwargs)
+
+
+def test_render_keywords():
+    z = Zint("Barcode", BARCODE_QRCODE)
+    options = dict(angle=90, fgcolor="#102030", bgcolor="#F0E0D0")
+
+    assert z.render_bmp(**options) == z.render_bmp(90, "#102030", "#F0E0D0")
+    assert z.render_svg(**options) == z.render_svg(90, "#102030", "#F0E0D0")
+    assert z.bmp_size(angle=90) == z.bmp_size(90)
+
+    buffer = bytearray(z.bmp_size(90) + 4)
+    size = z.render_bmp_into(buffer, offset=4, **options)
+    assert bytes(buffer[4:4 + size]) == z.render_bmp(**options)
@@ -0,0 +1,68 @@
+import asyncio
+
+import pytest
+
+from pyzint.zint import BARCODE_CODE128, BARCODE_QRCODE, Zint
+
+
+def run(coro):
+    loop = asyncio.new_event_loop()
+    try:
+        asyncio.set_event_loop(loop)
+        return loop.run_until_complete(coro)
+    finally:
+        asyncio.set_event_loop(None)
+        loop.close()
+
+
+@pytest.mark.parametrize("method,options", [
+    ("render_bmp", dict()),
+    ("render_bmp", dict(angle=90, fgcolor="#102030", direct=True)),
+    ("render_svg", dict()),
+    ("render_svg", dict(compact=True)),
+])
+def test_render_async(method, options):
+    symbols = [
+        Zint("Barcode %d" % i, BARCODE_QRCODE)
+        for i in range(64)
+    ]
+
+    async def main():
+        return await asyncio.gather(*[
+            getattr(z, method + "_async")(**options) for z in symbols
+        ])
+
+    result = run(main())
+    assert result == [getattr(z, method)(**options) for z in symbols]
+
+
+def test_render_async_error():
+    async def main():
+        return await Zint("1" * 1024, BARCODE_CODE128).render_bmp_async()
+
+    with pytest.raises(RuntimeError):
+        run(main())
+
+
+def test_render_async_bad_options():
+    async def main():
+        return Zint("1", BARCODE_QRCODE).render_svg_async(fgcolor="red")
+
+    with pytest.raises(ValueError):
+        run(main())
+
+
+def test_render_async_cancelled():
+    async def main():
+        future = Zint("1", BARCODE_QRCODE).render_bmp_async()
+        future.cancel()
+        await asyncio.sleep(0.1)
+        return await Zint("2", BARCODE_QRCODE).render_bmp_async()
+
+    assert run(main()) == Zint("2", BARCODE_QRCODE).render_bmp()
+
+
+@pytest.mark.parametrize("method", ["render_bmp_async", "render_svg_async"])
+def test_render_async_without_running_loop(method):
+    with pytest.raises(RuntimeError):
+        getattr(Zint("1", BARCODE_QRCODE), method)()
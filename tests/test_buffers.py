@@ -0,0 +1,174 @@
+from io import BytesIO
+
+import pytest
+from PIL import Image
+
+from pyzint.zint import (
+    BARCODE_CODE16K, BARCODE_CODE128, BARCODE_DATAMATRIX, BARCODE_ITF14,
+    BARCODE_MAXICODE, BARCODE_PDF417, BARCODE_QRCODE, BARCODE_RSS_EXP,
+    Matrix, Raster, Zint,
+)
+
+
+def test_render_bmp_buffer():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+    raster = z.render_bmp_buffer()
+
+    assert isinstance(raster, Raster)
+    assert raster.width == 366
+    assert raster.height == 84
+    assert raster.stride == 48
+    assert raster.offset == 62
+    assert len(raster) == raster.offset + raster.stride * raster.height
+
+    view = memoryview(raster)
+    assert view.readonly
+    assert view.nbytes == len(raster)
+    assert bytes(view[:2]) == b"BM"
+
+    with BytesIO(raster) as fp:
+        img = Image.open(fp)
+
+        assert img.verify() is None
+        assert img.size == (raster.width, raster.height)
+
+
+def test_render_bmp_buffer_pixels():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    raster = z.render_bmp_buffer()
+    view = memoryview(raster)
+
+    with BytesIO(z.render_bmp()) as fp:
+        img = Image.open(fp).convert("1")
+
+    for y in range(raster.height):
+        row = raster.offset + (raster.height - 1 - y) * raster.stride
+        for x in range(raster.width):
+            bit = (view[row + x // 8] >> (7 - x % 8)) & 1
+            assert bool(bit) == bool(img.getpixel((x, y)))
+
+
+
+def test_render_bmp_padding():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    raster = z.render_bmp_buffer()
+    view = memoryview(raster)
+    used = (raster.width + 7) // 8
+    tail = 0xFF >> (raster.width % 8) if raster.width % 8 else 0
+
+    assert raster.width % 8
+    for y in range(raster.height):
+        row = raster.offset + y * raster.stride
+        assert view[row + used - 1] & tail == 0
+        assert not any(view[row + used:row + raster.stride])
+
+    assert z.render_bmp() == z.render_bmp()
+
+
+def test_render_bmp_into():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+    size = z.bmp_size()
+    buffer = bytearray(size * 2 + 1)
+
+    assert z.render_bmp_into(buffer, 1) == size
+    assert z.render_bmp_into(buffer, offset=size + 1, angle=90) == size
+    assert buffer[0] == 0
+
+    for offset in (1, size + 1):
+        with BytesIO(buffer[offset:offset + size]) as fp:
+            img = Image.open(fp)
+
+            assert img.verify() is None
+            assert sorted(img.size) == [84, 366]
+
+
+def test_render_bmp_into_errors():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+
+    with pytest.raises(ValueError):
+        z.render_bmp_into(bytearray(z.bmp_size() - 1))
+
+    with pytest.raises(ValueError):
+        z.render_bmp_into(bytearray(10), 11)
+
+    with pytest.raises(TypeError):
+        z.render_bmp_into(b"read only")
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Barcode QRCode"),
+    (BARCODE_DATAMATRIX, "Barcode DataMatrix"),
+    (BARCODE_PDF417, "Barcode PDF417"),
+    (BARCODE_CODE128, "Barcode Code128"),
+    (BARCODE_CODE16K, "Barcode Code16K"),
+    (BARCODE_ITF14, "9212320967145"),
+    (BARCODE_MAXICODE, "Barcode Maxicode"),
+])
+@pytest.mark.parametrize("options", [
+    dict(show_text=False),
+    dict(show_text=False, scale=0.5),
+    dict(show_text=False, scale=1.5, whitespace_width=3),
+    dict(show_text=False, scale=3, border_width=2),
+    dict(show_text=True, scale=2),
+])
+def test_render_bmp_direct(kind, data, options):
+    z = Zint(data, kind, **options)
+    expected = z.render_bmp()
+
+    assert z.render_bmp(direct=True) == expected
+    assert z.render_bmp(direct=True, angle=90) == z.render_bmp(angle=90)
+    assert z.bmp_size(direct=True) == len(expected)
+
+
+def test_render_matrix():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    matrix = z.render_matrix()
+
+    assert isinstance(matrix, Matrix)
+    assert matrix.rows == matrix.columns
+    assert matrix.rows >= 21
+    assert matrix.stride == (matrix.columns + 7) // 8
+    assert len(matrix) == matrix.rows * matrix.stride
+
+    view = memoryview(matrix)
+    assert view.readonly
+    assert view.format == "B"
+    assert view.shape == (matrix.rows, matrix.stride)
+    assert view.strides == (matrix.stride, 1)
+    assert view.c_contiguous
+
+    with pytest.raises(TypeError):
+        view[0, 0] = 1
+
+    with pytest.raises(TypeError):
+        z.render_bmp_into(matrix)
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Barcode QRCode"),
+    (BARCODE_DATAMATRIX, "Barcode DataMatrix"),
+    (BARCODE_PDF417, "Barcode PDF417"),
+    (BARCODE_CODE128, "Barcode Code128"),
+])
+def test_render_matrix_modules(kind, data):
+    # at scale 0.5 without text and quiet zones bmp pixel is one module
+    z = Zint(data, kind, show_text=False, scale=0.5)
+    matrix = z.render_matrix()
+    raster = z.render_bmp_buffer()
+    rows = memoryview(matrix).tobytes()
+    pixels = memoryview(raster)
+
+    assert raster.width == matrix.columns
+    tail = 0xFF >> (matrix.columns % 8) if matrix.columns % 8 else 0
+
+    for y in range(matrix.rows):
+        row = rows[y * matrix.stride:(y + 1) * matrix.stride]
+        assert row[-1] & tail == 0
+
+        # stacked rows may be taller than one pixel, check top one
+        top = raster.height * y // matrix.rows
+        line = raster.offset + (raster.height - 1 - top) * raster.stride
+        for x in range(matrix.columns):
+            module = (row[x // 8] >> (7 - x % 8)) & 1
+            pixel = (pixels[line + x // 8] >> (7 - x % 8)) & 1
+            assert module != pixel
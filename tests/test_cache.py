@@ -0,0 +1,162 @@
+import threading
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, Zint, clear_render_cache,
+    render_cache_stats, render_many, set_render_cache_limit,
+)
+
+
+@pytest.fixture
+def cache():
+    set_render_cache_limit(1 << 20)
+    yield render_cache_stats
+    set_render_cache_limit(0)
+
+
+def test_render_cache_off_by_default():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    before = render_cache_stats()
+
+    assert z.render_bmp() is not z.render_bmp()
+    assert render_cache_stats() == before
+    assert before["limit"] == 0
+    assert before["entries"] == 0
+
+
+def test_render_cache_hit(cache):
+    first = Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    before = cache()
+
+    second = Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    after = cache()
+
+    assert second is first
+    assert after["hits"] == before["hits"] + 1
+    assert after["misses"] == before["misses"]
+    assert after["entries"] == 1
+    assert after["bytes"] > len(first)
+
+
+@pytest.mark.parametrize("method,options", [
+    ("render_bmp", {}),
+    ("render_svg", {"compact": True}),
+    ("render_png", {"level": 1}),
+    ("render_zpl", {"compression": "hex"}),
+    ("render_escpos", {}),
+])
+def test_render_cache_formats(cache, method, options):
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    first = getattr(z, method)(**options)
+
+    assert getattr(z, method)(**options) is first
+    assert first == getattr(Zint("Barcode QRCode", BARCODE_QRCODE), method)(
+        **options
+    )
+
+
+@pytest.mark.parametrize("kwargs,options", [
+    ({"scale": 2}, {}),
+    ({"height": 20}, {}),
+    ({"option_1": 4}, {}),
+    ({"whitespace_width": 3}, {}),
+    ({"primary": "1"}, {}),
+    ({}, {"angle": 90}),
+    ({}, {"fgcolor": "#102030"}),
+    ({}, {"bgcolor": "#F0E0D0"}),
+    ({}, {"direct": True}),
+])
+def test_render_cache_key(cache, kwargs, options):
+    plain = Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    changed = Zint("Barcode QRCode", BARCODE_QRCODE, **kwargs).render_bmp(
+        **options
+    )
+
+    assert changed is not plain
+    assert Zint("Barcode QRCode!", BARCODE_QRCODE).render_bmp() is not plain
+    assert Zint("Barcode QRCode", BARCODE_CODE128).render_bmp() is not plain
+    assert Zint("Barcode QRCode", BARCODE_QRCODE).render_svg() is not plain
+    assert cache()["entries"] == 5
+
+
+def test_render_cache_lru(cache):
+    clear_render_cache()
+    Zint("lru 0", BARCODE_QRCODE).render_bmp()
+    charge = cache()["bytes"]
+    clear_render_cache()
+    set_render_cache_limit(3 * charge + charge // 2)
+
+    rendered = [Zint("lru %d" % i, BARCODE_QRCODE).render_bmp() for i in range(3)]
+    assert Zint("lru 0", BARCODE_QRCODE).render_bmp() is rendered[0]
+    before = cache()
+
+    Zint("lru 3", BARCODE_QRCODE).render_bmp()
+    stats = cache()
+
+    assert stats["evictions"] == before["evictions"] + 1
+    assert stats["bytes"] <= stats["limit"]
+    assert Zint("lru 0", BARCODE_QRCODE).render_bmp() is rendered[0]
+    assert Zint("lru 1", BARCODE_QRCODE).render_bmp() is not rendered[1]
+
+
+def test_render_cache_limit(cache):
+    Zint("limit", BARCODE_QRCODE).render_bmp()
+    assert cache()["entries"] == 1
+
+    set_render_cache_limit(16)
+    assert cache()["entries"] == 0
+
+    Zint("limit", BARCODE_QRCODE).render_bmp()
+    stats = cache()
+    assert stats["entries"] == 0
+    assert stats["bytes"] == 0
+
+    with pytest.raises(ValueError):
+        set_render_cache_limit(-1)
+
+
+def test_render_cache_errors_not_cached(cache):
+    for _ in range(2):
+        with pytest.raises(RuntimeError):
+            Zint("x" * 1001, BARCODE_CODE128).render_bmp()
+
+    assert cache()["entries"] == 0
+
+
+def test_render_cache_clear(cache):
+    first = Zint("clear", BARCODE_QRCODE).render_svg()
+    clear_render_cache()
+
+    assert cache()["entries"] == 0
+    assert Zint("clear", BARCODE_QRCODE).render_svg() is not first
+
+
+def test_render_many_cache(cache):
+    first = render_many(BARCODE_QRCODE, ["a", "b", "a", "x" * 8000])
+    second = render_many(BARCODE_QRCODE, ["b", "a"], threads=2)
+
+    assert second[0] is first[1]
+    assert second[1] is first[0] or second[1] is first[2]
+    assert isinstance(first[3], RuntimeError)
+    assert Zint("a", BARCODE_QRCODE).render_bmp() is second[1]
+
+
+def test_render_cache_threads(cache):
+    payloads = ["thread %d" % (i % 8) for i in range(64)]
+    expected = {p: Zint(p, BARCODE_QRCODE).render_bmp() for p in payloads}
+    errors = []
+
+    def worker():
+        for payload in payloads:
+            if Zint(payload, BARCODE_QRCODE).render_bmp() is not expected[payload]:
+                errors.append(payload)
+        render_many(BARCODE_QRCODE, payloads, threads=4)
+
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert errors == []
@@ -0,0 +1,152 @@
+import base64
+import binascii
+import re
+import zlib
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_DATAMATRIX, BARCODE_QRCODE, Zint, render_many,
+)
+
+
+def printed_rows(z, **options):
+    """Rows of dots a printer should print, taken from bmp raster"""
+    raster = z.render_bmp_buffer(**options)
+    view = memoryview(raster)
+    used = (raster.width + 7) // 8
+    tail = (0xFF << (8 - raster.width % 8)) & 0xFF if raster.width % 8 else 0xFF
+
+    rows = []
+    for y in range(raster.height):
+        start = raster.offset + (raster.height - 1 - y) * raster.stride
+        row = bytearray(~x & 0xFF for x in view[start:start + used])
+        row[-1] &= tail
+        rows.append(bytes(row))
+    return raster.width, rows
+
+
+def decode_acs(data, used):
+    counts = {chr(ord("G") + i): i + 1 for i in range(19)}
+    counts.update({chr(ord("g") + i): (i + 1) * 20 for i in range(20)})
+
+    rows, row, count = [], "", 0
+    for char in data:
+        if char in counts:
+            count += counts[char]
+            continue
+        if char == ":":
+            row = rows[-1]
+        elif char == ",":
+            row = row.ljust(used * 2, "0")
+        elif char == "!":
+            row = row.ljust(used * 2, "F")
+        else:
+            row += char * (count or 1)
+        count = 0
+        if len(row) == used * 2:
+            rows.append(row)
+            row = ""
+
+    assert row == ""
+    return bytes.fromhex("".join(rows))
+
+
+def decode_zpl(zpl):
+    match = re.fullmatch(r"\^GFA,(\d+),(\d+),(\d+),(.*)\^FS", zpl.decode())
+    assert match
+    total, count, used, data = match.groups()
+    total, used = int(total), int(used)
+    assert count == str(total)
+
+    if data.startswith((":Z64:", ":B64:")):
+        kind, encoded, crc = data[1:4], *data[5:].split(":")
+        assert int(crc, 16) == binascii.crc_hqx(encoded.encode(), 0)
+        raw = base64.b64decode(encoded)
+        if kind == "Z64":
+            raw = zlib.decompress(raw)
+    elif re.fullmatch(r"[0-9A-F]*", data):
+        raw = bytes.fromhex(data)
+    else:
+        raw = decode_acs(data, used)
+
+    assert len(raw) == total
+    return [raw[i:i + used] for i in range(0, total, used)]
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Barcode QRCode"),
+    (BARCODE_DATAMATRIX, "Barcode DataMatrix"),
+    (BARCODE_CODE128, "Barcode Code128"),
+])
+@pytest.mark.parametrize("compression", ["hex", "acs", "b64", "z64"])
+def test_render_zpl(kind, data, compression):
+    z = Zint(data, kind, scale=1.5)
+    zpl = z.render_zpl(compression=compression)
+
+    width, rows = printed_rows(z)
+    assert decode_zpl(zpl) == rows
+
+    label = z.render_zpl(compression=compression, label=True)
+    assert label == b"^XA^FO0,0" + zpl + b"^XZ\n"
+
+    assert z.render_zpl(compression=compression, angle=90) != zpl
+
+
+def test_render_zpl_compression():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE, scale=4)
+    sizes = {
+        compression: len(z.render_zpl(compression=compression))
+        for compression in ("hex", "acs", "b64", "z64")
+    }
+
+    assert sizes["acs"] < sizes["hex"]
+    assert sizes["z64"] < sizes["b64"] < sizes["hex"]
+    assert z.render_zpl() == z.render_zpl(compression="z64")
+
+    with pytest.raises(ValueError):
+        z.render_zpl(compression="lzw")
+
+
+def test_render_escpos():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE, scale=2)
+    escpos = z.render_escpos()
+    width, rows = printed_rows(z)
+    used = (width + 7) // 8
+
+    assert escpos[:4] == b"\x1dv0\x00"
+    assert int.from_bytes(escpos[4:6], "little") == used
+    assert int.from_bytes(escpos[6:8], "little") == len(rows)
+    assert escpos[8:] == b"".join(rows)
+
+    assert z.render_escpos(direct=True) == escpos
+
+
+def test_render_escpos_bands():
+    # version 32, 145 modules of 20 dots
+    z = Zint("x" * 900, BARCODE_QRCODE, option_1=4, scale=10)
+    escpos = z.render_escpos()
+    width, rows = printed_rows(z)
+    used = (width + 7) // 8
+
+    decoded = []
+    while escpos:
+        assert escpos[:4] == b"\x1dv0\x00"
+        assert int.from_bytes(escpos[4:6], "little") == used
+        band = int.from_bytes(escpos[6:8], "little")
+        assert 0 < band <= 2303
+        data, escpos = escpos[8:8 + used * band], escpos[8 + used * band:]
+        decoded += [data[i:i + used] for i in range(0, len(data), used)]
+
+    assert len(rows) > 2303
+    assert decoded == rows
+
+
+def test_render_many_label_formats():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    zpl, = render_many(BARCODE_QRCODE, ["Barcode QRCode"], format="zpl")
+    escpos, = render_many(BARCODE_QRCODE, ["Barcode QRCode"], format="escpos")
+
+    assert zpl == z.render_zpl()
+    assert escpos == z.render_escpos()
+    assert z.render(formats=("zpl", "escpos")) == (zpl, escpos)
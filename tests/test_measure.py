@@ -0,0 +1,128 @@
+import struct
+import xml.etree.ElementTree as ET
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE16K, BARCODE_CODE128, BARCODE_DATAMATRIX, BARCODE_EANX,
+    BARCODE_ITF14, BARCODE_MAXICODE, BARCODE_PDF417, BARCODE_QRCODE,
+    BARCODE_RSS_EXP, Zint,
+)
+
+
+def bmp_dimensions(data):
+    width, height = struct.unpack_from("<ii", data, 18)
+    return width, height
+
+
+def svg_dimensions(data):
+    xml = ET.fromstring(data.decode())
+    return int(xml.get("width")), int(xml.get("height"))
+
+
+def test_measure_rss_exp():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+    matrix = z.render_matrix()
+
+    assert z.measure() == {
+        "rows": matrix.rows,
+        "columns": matrix.columns,
+        "bitmap_width": 366,
+        "bitmap_height": 84,
+        "vector_width": 366,
+        "vector_height": 87,
+        "warning": None,
+    }
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Barcode QRCode"),
+    (BARCODE_DATAMATRIX, "Barcode DataMatrix"),
+    (BARCODE_PDF417, "Barcode PDF417"),
+    (BARCODE_CODE128, "Barcode Code128"),
+    (BARCODE_CODE16K, "Barcode Code16K"),
+    (BARCODE_ITF14, "9212320967145"),
+])
+@pytest.mark.parametrize("options", [
+    dict(show_text=False),
+    dict(show_text=False, scale=0.5),
+    dict(show_text=False, scale=1.5, whitespace_width=3),
+    dict(show_text=False, scale=3, border_width=2),
+    dict(show_text=True, scale=2),
+    dict(show_text=True, scale=2.3, height=20),
+])
+@pytest.mark.parametrize("angle", [0, 90, 180, 270])
+def test_measure_matches_render(kind, data, options, angle):
+    z = Zint(data, kind, **options)
+    size = z.measure(angle=angle)
+
+    assert (size["bitmap_width"], size["bitmap_height"]) == bmp_dimensions(
+        z.render_bmp(angle=angle)
+    )
+    assert (size["vector_width"], size["vector_height"]) == svg_dimensions(
+        z.render_svg(angle=angle)
+    )
+
+
+def test_measure_options():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE, 3, 4)
+    size = z.measure()
+
+    assert size["rows"] == size["columns"] == 33
+    assert size["bitmap_width"] == size["bitmap_height"] == 66
+
+
+def test_measure_rotated():
+    z = Zint("Barcode Code128", BARCODE_CODE128)
+    size, rotated = z.measure(), z.measure(angle=90)
+
+    assert rotated["bitmap_width"] == size["bitmap_height"]
+    assert rotated["bitmap_height"] == size["bitmap_width"]
+    assert rotated["vector_width"] == size["vector_height"]
+    assert rotated["vector_height"] == size["vector_width"]
+    assert z.measure(angle=180) == size
+
+
+@pytest.mark.parametrize("kind,data,options", [
+    (BARCODE_MAXICODE, "Barcode Maxicode", {}),
+    (BARCODE_EANX, "123456789012", {}),
+])
+def test_measure_unknown_sizes(kind, data, options):
+    size = Zint(data, kind, **options).measure()
+
+    assert size["rows"] > 0 and size["columns"] > 0
+    assert size["bitmap_width"] is None
+    assert size["bitmap_height"] is None
+    assert size["vector_width"] is None
+    assert size["vector_height"] is None
+
+
+def test_measure_font_size():
+    z = Zint("Barcode Code128", BARCODE_CODE128, fontsize=20)
+    size = z.measure()
+
+    assert (size["bitmap_width"], size["bitmap_height"]) == bmp_dimensions(
+        z.render_bmp()
+    )
+    assert size["vector_width"] is None
+
+
+def test_measure_then_render():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    size = z.measure()
+
+    assert bmp_dimensions(z.render_bmp()) == (
+        size["bitmap_width"], size["bitmap_height"],
+    )
+    assert z.measure() == size
+
+
+def test_measure_errors():
+    with pytest.raises(RuntimeError):
+        Zint("x" * 1001, BARCODE_CODE128).measure()
+
+    with pytest.raises(RuntimeError):
+        Zint("1", BARCODE_CODE128).measure(angle=45)
+
+    with pytest.raises(TypeError):
+        Zint("1", BARCODE_CODE128).measure(angle="90")
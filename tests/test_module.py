@@ -0,0 +1,125 @@
+import importlib.util
+import textwrap
+import threading
+
+import pytest
+
+import pyzint.zint
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, BARCODE_RSS_EXP, Zint, render_many,
+)
+
+
+def load_copy():
+    spec = importlib.util.find_spec("pyzint.zint")
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def test_module_state_is_per_module():
+    module = load_copy()
+
+    assert module.Zint is not pyzint.zint.Zint
+    assert module.Raster is not pyzint.zint.Raster
+
+    z = module.Zint("Barcode QRCode", BARCODE_QRCODE)
+    raster = z.render_bmp_buffer()
+
+    assert isinstance(raster, module.Raster)
+    assert not isinstance(raster, pyzint.zint.Raster)
+    assert bytes(raster) == pyzint.zint.Zint(
+        "Barcode QRCode", BARCODE_QRCODE
+    ).render_bmp()
+
+
+def test_types_qualname():
+    assert pyzint.zint.Zint.__module__ == "pyzint.zint"
+    assert pyzint.zint.Raster.__module__ == "pyzint.zint"
+
+
+def subinterpreters():
+    for name in ("_interpreters", "_xxsubinterpreters"):
+        try:
+            return importlib.import_module(name)
+        except ImportError:
+            pass
+    return None
+
+
+@pytest.mark.skipif(
+    subinterpreters() is None, reason="no subinterpreters support",
+)
+def test_subinterpreter():
+    interpreters = subinterpreters()
+    code = textwrap.dedent("""
+        import asyncio
+        from pyzint.zint import Zint, BARCODE_QRCODE
+
+        async def main():
+            return await Zint("Barcode", BARCODE_QRCODE).render_bmp_async()
+
+        assert asyncio.run(main()) == Zint("Barcode", BARCODE_QRCODE).render_bmp()
+    """)
+
+    interp = interpreters.create()
+    try:
+        assert interpreters.run_string(interp, code) is None
+    finally:
+        interpreters.destroy(interp)
+
+
+def test_reinit_while_rendering():
+    variants = [
+        ("Barcode QRCode", BARCODE_QRCODE, {}),
+        ("[255]11111111111222", BARCODE_RSS_EXP, {"scale": 2}),
+        ("Barcode", BARCODE_CODE128, {"primary": "1", "text": "label"}),
+    ]
+    expected = {
+        Zint(data, kind, **kwargs).render_bmp()
+        for data, kind, kwargs in variants
+    }
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    stop = threading.Event()
+    errors = []
+
+    def worker():
+        while not stop.is_set():
+            if z.render_bmp() not in expected:
+                errors.append("mixed render")
+            z.measure()
+            z.render_matrix()
+            render_many(BARCODE_QRCODE, ["a", "b"], threads=2)
+
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    try:
+        for i in range(500):
+            data, kind, kwargs = variants[i % len(variants)]
+            z.__init__(data, kind, **kwargs)
+    finally:
+        stop.set()
+        for thread in threads:
+            thread.join()
+
+    assert errors == []
+
+
+def test_phases():
+    z = pyzint.zint.Zint("Barcode QRCode", BARCODE_QRCODE)
+    phases = pyzint.zint._phases(z, 3)
+
+    assert set(phases) == {
+        "encode", "buffer", "pack", "vector", "svg", "copy",
+        "bmp_size", "svg_size",
+    }
+    assert phases["bmp_size"] == len(z.render_bmp())
+    assert phases["svg_size"] == len(z.render_svg())
+    assert all(phases[x] >= 0 for x in ("encode", "pack", "vector", "svg"))
+
+    with pytest.raises(ValueError):
+        pyzint.zint._phases(z, 0)
+
+    with pytest.raises(TypeError):
+        pyzint.zint._phases("Barcode QRCode")
@@ -0,0 +1,71 @@
+from io import BytesIO
+
+import pytest
+from PIL import Image
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_PDF417, BARCODE_QRCODE, BARCODE_RSS_EXP, Zint,
+    render_many,
+)
+
+
+def load(data):
+    with BytesIO(data) as fp:
+        img = Image.open(fp)
+        img.load()
+        return img
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Barcode QRCode"),
+    (BARCODE_CODE128, "Barcode Code128"),
+    (BARCODE_PDF417, "Barcode PDF417"),
+    (BARCODE_RSS_EXP, "[255]11111111111222"),
+])
+@pytest.mark.parametrize("options", [
+    dict(),
+    dict(level=0),
+    dict(level=9, strategy="rle", filter="up"),
+    dict(level=1, strategy="huffman", filter="paeth"),
+    dict(strategy="filtered", filter="sub"),
+    dict(strategy="fixed", filter="average"),
+])
+def test_render_png(kind, data, options):
+    z = Zint(data, kind)
+    colors = dict(fgcolor="#102030", bgcolor="#F0E0D0")
+
+    png = load(z.render_png(**colors, **options))
+    bmp = load(z.render_bmp(**colors))
+
+    assert png.format == "PNG"
+    assert png.mode == "P"
+    assert png.size == bmp.size
+    assert png.convert("RGB").tobytes() == bmp.convert("RGB").tobytes()
+
+
+def test_render_png_smaller_than_bmp():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE, scale=4)
+
+    assert len(z.render_png()) * 5 < len(z.render_bmp())
+    assert len(z.render_png(level=9)) <= len(z.render_png(level=0))
+
+
+def test_render_png_formats():
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    png, = z.render(["png"], level=9)
+
+    assert png == z.render_png(level=9)
+    assert render_many(BARCODE_QRCODE, ["Barcode QRCode"], format="png") == [
+        z.render_png()
+    ]
+
+
+@pytest.mark.parametrize("options", [
+    dict(level=10),
+    dict(level=-2),
+    dict(strategy="best"),
+    dict(filter="adaptive"),
+])
+def test_render_png_bad_options(options):
+    with pytest.raises(ValueError):
+        Zint("Barcode QRCode", BARCODE_QRCODE).render_png(**options)
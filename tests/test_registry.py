@@ -0,0 +1,85 @@
+import pytest
+
+from pyzint.zint import (
+    BARCODE_C25INTER, BARCODE_CODE128, BARCODE_CODE39, BARCODE_EANX,
+    BARCODE_EANX_CC, BARCODE_MAXICODE, BARCODE_QRCODE, BARCODE_RSS_EXP,
+    Zint, render_many, symbology_info,
+)
+
+
+def test_symbology_info_linear():
+    assert symbology_info(BARCODE_CODE128) == {
+        "id": BARCODE_CODE128,
+        "name": "code128",
+        "linear": True,
+        "stacked": False,
+        "matrix": False,
+        "postal": False,
+        "composite": False,
+        "gs1": False,
+        "primary": False,
+        "direct": True,
+        "max_length": 160,
+        "charset": "bytes",
+    }
+
+
+def test_symbology_info_flags():
+    qr = symbology_info(BARCODE_QRCODE)
+    assert qr["matrix"] and qr["direct"] and not qr["linear"]
+    assert qr["max_length"] == 7089
+
+    composite = symbology_info(BARCODE_EANX_CC)
+    assert composite["composite"] and composite["primary"] and composite["gs1"]
+    assert not composite["direct"]
+    assert composite["max_length"] is None
+
+    assert symbology_info(BARCODE_RSS_EXP)["gs1"]
+    assert not symbology_info(BARCODE_MAXICODE)["direct"]
+    assert not symbology_info(BARCODE_EANX)["direct"]
+
+
+def test_symbology_info_charset():
+    assert symbology_info(BARCODE_C25INTER)["charset"] == "numeric"
+    assert symbology_info(BARCODE_EANX)["charset"] == "0123456789+"
+    assert "-. $/+%" in symbology_info(BARCODE_CODE39)["charset"]
+
+
+@pytest.mark.parametrize("kind", [-1, 0, 144, 255, 256, 1 << 40])
+def test_symbology_info_unknown(kind):
+    with pytest.raises(ValueError):
+        symbology_info(kind)
+
+
+def test_symbology_info_names_match_repr():
+    for kind in (BARCODE_CODE128, BARCODE_QRCODE, BARCODE_EANX_CC):
+        name = symbology_info(kind)["name"]
+        assert name in repr(Zint("1", kind))
+
+
+@pytest.mark.parametrize(
+    "kind,data,code,message",
+    [
+        (BARCODE_C25INTER, "12a4", 6, "position 2"),
+        (BARCODE_EANX, "hello", 6, "position 0"),
+        (BARCODE_CODE39, "a*b", 6, "position 1"),
+        (BARCODE_CODE128, "x" * 161, 5, "at most 160"),
+        (BARCODE_QRCODE, "", 6, "No input data"),
+        (BARCODE_EANX_CC, "[21]A12345678", 8, "No primary"),
+    ],
+)
+def test_rejected_before_encoding(kind, data, code, message):
+    with pytest.raises(RuntimeError) as e:
+        Zint(data, kind).render_bmp()
+
+    assert e.value.args[0] == code
+    assert message in e.value.args[1]
+
+
+def test_render_many_rejected_items():
+    result = render_many(BARCODE_C25INTER, ["1234", "12x4", "5678"])
+
+    assert isinstance(result[0], bytes)
+    assert isinstance(result[1], RuntimeError)
+    assert "position 2" in str(result[1])
+    assert isinstance(result[2], bytes)
@@ -0,0 +1,78 @@
+import xml.etree.ElementTree as ET
+from io import BytesIO
+
+import pytest
+from PIL import Image
+
+from pyzint.zint import (
+    BARCODE_EAN14,
+    BARCODE_QRCODE,
+    BARCODE_RSS_EXP,
+    Zint,
+    render_many,
+)
+
+
+def test_render_many_bmp():
+    payloads = ["Barcode QRCode {}".format(i) for i in range(32)]
+    barcodes = render_many(BARCODE_QRCODE, payloads, threads=4)
+
+    assert len(barcodes) == len(payloads)
+
+    for payload, barcode in zip(payloads, barcodes):
+        with BytesIO(Zint(payload, BARCODE_QRCODE).render_bmp()) as fp:
+            size = Image.open(fp).size
+
+        with BytesIO(barcode) as fp:
+            img = Image.open(fp)
+
+            assert img.verify() is None
+            assert img.size == size
+
+
+def test_render_many_svg():
+    barcodes = render_many(
+        BARCODE_RSS_EXP, ["[255]11111111111222", b"[255]11111111111222"],
+        format="svg",
+    )
+
+    expected = Zint("[255]11111111111222", BARCODE_RSS_EXP).render_svg()
+    assert barcodes == [expected, expected]
+
+    xml = ET.fromstring(barcodes[0].decode())
+    assert int(xml.get("width")) == 366
+    assert int(xml.get("height")) == 87
+
+
+def test_render_many_options():
+    barcodes = render_many(
+        BARCODE_QRCODE, ["Barcode QRCode"], option_1=3, option_2=4,
+    )
+
+    with BytesIO(barcodes[0]) as fp:
+        img = Image.open(fp)
+        assert img.height == 66
+        assert img.width == 66
+
+
+def test_render_many_errors():
+    barcodes = render_many(
+        BARCODE_EAN14, ["97802013796251111111", "9780201379625"],
+    )
+
+    assert isinstance(barcodes[0], RuntimeError)
+    assert barcodes[0].args[0] > 0
+    assert isinstance(barcodes[1], bytes)
+
+
+def test_render_many_bad_arguments():
+    with pytest.raises(ValueError):
+        render_many(BARCODE_QRCODE, ["data"], format="gif")
+
+    with pytest.raises(ValueError):
+        render_many(BARCODE_QRCODE, ["data"], threads=-1)
+
+    with pytest.raises(ValueError):
+        render_many(BARCODE_QRCODE, ["data", 1])
+
+    assert render_many(BARCODE_QRCODE, []) == []
@@ -0,0 +1,146 @@
+import io
+import operator
+import os
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_C25INTER, BARCODE_CODE128, BARCODE_QRCODE, render_many,
+    render_range,
+)
+
+
+@pytest.mark.parametrize("format", ["bmp", "svg", "png", "zpl", "escpos"])
+def test_render_range_matches_render_many(format):
+    result = list(render_range(
+        BARCODE_CODE128, "LOT-%06d", 1, 21, format=format, chunk=8,
+    ))
+    expected = render_many(
+        BARCODE_CODE128, ["LOT-%06d" % i for i in range(1, 21)], format=format,
+    )
+
+    assert result == expected
+
+
+@pytest.mark.parametrize("template,start,stop,step,payloads", [
+    ("%d", 0, 3, 1, ["0", "1", "2"]),
+    ("%4d", 7, 8, 1, ["   7"]),
+    ("A%03dB", 98, 101, 1, ["A098B", "A099B", "A100B"]),
+    ("100%% %d", 5, 0, -2, ["100% 5", "100% 3", "100% 1"]),
+    (b"SN-%02d", 8, 12, 3, ["SN-08", "SN-11"]),
+    ("%d", 2 ** 63 - 2, 2 ** 63 - 1, 1, [str(2 ** 63 - 2)]),
+    ("%d", -2 ** 63, -2 ** 63 + 5, 3, [str(-2 ** 63), str(-2 ** 63 + 3)]),
+])
+def test_render_range_payloads(template, start, stop, step, payloads):
+    result = list(render_range(
+        BARCODE_CODE128, template, start, stop, step, scale=2,
+    ))
+
+    assert result == render_many(BARCODE_CODE128, payloads, scale=2)
+
+
+@pytest.mark.parametrize("start,stop,step", [(0, 0, 1), (5, 1, 1), (1, 5, -1)])
+def test_render_range_empty(start, stop, step):
+    assert list(render_range(BARCODE_QRCODE, "%d", start, stop, step)) == []
+
+
+def test_render_range_lazy():
+    renders = render_range(BARCODE_QRCODE, "Q%d", 0, 10, chunk=4)
+    assert operator.length_hint(renders) == 10
+    assert iter(renders) is renders
+
+    first = next(renders)
+    assert operator.length_hint(renders) == 9
+    assert first == render_many(BARCODE_QRCODE, ["Q0"])[0]
+
+    assert len(list(renders)) == 9
+    assert operator.length_hint(renders) == 0
+    with pytest.raises(StopIteration):
+        next(renders)
+
+
+def test_render_range_errors_as_items():
+    result = list(render_range(BARCODE_C25INTER, "%d", -2, 2, threads=2))
+
+    assert isinstance(result[0], RuntimeError)
+    assert isinstance(result[1], RuntimeError)
+    assert result[2:] == render_many(BARCODE_C25INTER, ["0", "1"])
+
+
+def test_render_range_file():
+    file = io.BytesIO()
+    written = render_range(
+        BARCODE_QRCODE, "Q%d", 0, 10, format="zpl", chunk=3, file=file,
+    )
+
+    expected = b"".join(
+        render_many(BARCODE_QRCODE, ["Q%d" % i for i in range(10)], format="zpl")
+    )
+    assert written == len(expected)
+    assert file.getvalue() == expected
+
+
+def test_render_range_fd(tmp_path):
+    path = tmp_path / "labels.bmp"
+    fd = os.open(str(path), os.O_WRONLY | os.O_CREAT)
+    try:
+        written = render_range(BARCODE_QRCODE, "Q%d", 0, 5, file=fd)
+    finally:
+        os.close(fd)
+
+    expected = b"".join(
+        render_many(BARCODE_QRCODE, ["Q%d" % i for i in range(5)])
+    )
+    assert written == len(expected)
+    assert path.read_bytes() == expected
+
+
+def test_render_range_file_stops_on_error():
+    file = io.BytesIO()
+
+    with pytest.raises(RuntimeError):
+        render_range(BARCODE_C25INTER, "%d", 3, -3, -1, chunk=2, file=file)
+
+    assert file.getvalue() == b"".join(
+        render_many(BARCODE_C25INTER, ["3", "2", "1", "0"])
+    )
+
+
+def test_render_range_file_write_error():
+    class Broken:
+        def write(self, data):
+            raise IOError("broken")
+
+    with pytest.raises(IOError):
+        render_range(BARCODE_QRCODE, "%d", 0, 3, file=Broken())
+
+    with pytest.raises(TypeError):
+        render_range(BARCODE_QRCODE, "%d", 0, 3, file=object())
+
+
+@pytest.mark.parametrize("template", [
+    "LOT", "%d-%d", "%x", "%-5d", "%65d", "%", "100%",
+])
+def test_render_range_bad_template(template):
+    with pytest.raises(ValueError):
+        render_range(BARCODE_CODE128, template, 0, 1)
+
+
+def test_render_range_bad_arguments():
+    with pytest.raises(TypeError):
+        render_range(BARCODE_CODE128, 1, 0, 1)
+
+    with pytest.raises(ValueError):
+        render_range(BARCODE_CODE128, "%d", 0, 1, 0)
+
+    with pytest.raises(ValueError):
+        render_range(BARCODE_CODE128, "%d", 0, 1, chunk=0)
+
+    with pytest.raises(ValueError):
+        render_range(BARCODE_CODE128, "%d", 0, 1, format="gif")
+
+    with pytest.raises(OverflowError):
+        render_range(BARCODE_CODE128, "%d", 0, 2 ** 63)
+
+    with pytest.raises(TypeError):
+        render_range(BARCODE_CODE128, "%d", 0, 1, no_such_option=1)
@@ -0,0 +1,216 @@
+import os
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, SharedCache, Zint, render_many,
+    set_render_cache_limit, set_shared_render_cache,
+)
+
+
+@pytest.fixture
+def shared(tmp_path):
+    cache = SharedCache(str(tmp_path / "renders"), size=1 << 20)
+    set_shared_render_cache(cache)
+    yield cache
+    set_shared_render_cache(None)
+
+
+def fork(func):
+    pid = os.fork()
+    if pid == 0:
+        try:
+            func()
+        except BaseException:
+            os._exit(1)
+        os._exit(0)
+    return pid
+
+
+def join(pid):
+    _, status = os.waitpid(pid, 0)
+    assert os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+
+
+def run_in_child(func):
+    join(fork(func))
+
+
+def test_shared_cache_hit(shared):
+    first = Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    stats = shared.stats()
+
+    assert stats["insertions"] == 1
+    assert stats["misses"] == 1
+    assert stats["entries"] == 1
+
+    second = Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+
+    assert second == first
+    assert second is not first
+    assert shared.stats()["hits"] == 1
+    assert shared.stats()["insertions"] == 1
+
+
+def test_shared_cache_key(shared):
+    plain = Zint("Barcode QRCode", BARCODE_QRCODE).render_svg()
+
+    assert Zint("Barcode QRCode", BARCODE_QRCODE, scale=2).render_svg() != plain
+    Zint("Barcode QRCode", BARCODE_QRCODE).render_svg(fgcolor="#102030")
+    Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+
+    assert shared.stats()["entries"] == 4
+    assert shared.stats()["hits"] == 0
+
+
+def test_shared_cache_between_processes(tmp_path):
+    path = str(tmp_path / "renders")
+    cache = SharedCache(path, size=1 << 20)
+
+    def child():
+        other = SharedCache(path)
+        set_shared_render_cache(other)
+        Zint("shared", BARCODE_QRCODE).render_svg()
+
+    run_in_child(child)
+
+    assert cache.stats()["insertions"] == 1
+
+    set_shared_render_cache(cache)
+    try:
+        shared = Zint("shared", BARCODE_QRCODE).render_svg()
+    finally:
+        set_shared_render_cache(None)
+
+    assert shared == Zint("shared", BARCODE_QRCODE).render_svg()
+    assert cache.stats()["hits"] == 1
+
+
+def test_shared_cache_anonymous():
+    cache = SharedCache(size=1 << 20)
+    assert cache.path is None
+
+    set_shared_render_cache(cache)
+    try:
+        run_in_child(lambda: Zint("forked", BARCODE_QRCODE).render_bmp())
+        assert cache.stats()["insertions"] == 1
+
+        Zint("forked", BARCODE_QRCODE).render_bmp()
+        assert cache.stats()["hits"] == 1
+    finally:
+        set_shared_render_cache(None)
+
+
+def test_shared_cache_reopen(tmp_path):
+    path = str(tmp_path / "renders")
+    SharedCache(path, size=1 << 20)
+
+    again = SharedCache(path, size=4 << 20)
+
+    assert again.stats()["size"] == 1 << 20
+    assert os.path.getsize(path) == 1 << 20
+
+
+def test_shared_cache_overwrites_oldest(tmp_path):
+    cache = SharedCache(str(tmp_path / "renders"), size=64 * 1024)
+    set_shared_render_cache(cache)
+    try:
+        for i in range(200):
+            Zint("ring %d" % i, BARCODE_QRCODE).render_bmp()
+        stats = cache.stats()
+
+        assert stats["insertions"] == 200
+        assert 0 < stats["entries"] < 200
+
+        last = Zint("ring 199", BARCODE_QRCODE).render_bmp()
+        assert cache.stats()["hits"] == 1
+        assert last == Zint("ring 199", BARCODE_QRCODE).render_bmp()
+    finally:
+        set_shared_render_cache(None)
+
+
+def test_shared_cache_too_big(tmp_path):
+    cache = SharedCache(str(tmp_path / "renders"), size=64 * 1024)
+    set_shared_render_cache(cache)
+    try:
+        Zint("Barcode QRCode", BARCODE_QRCODE, scale=10).render_bmp()
+    finally:
+        set_shared_render_cache(None)
+
+    assert cache.stats()["insertions"] == 0
+
+
+def test_shared_cache_errors_not_cached(shared):
+    for _ in range(2):
+        with pytest.raises(RuntimeError):
+            Zint("x" * 1001, BARCODE_CODE128).render_bmp()
+
+    assert shared.stats()["entries"] == 0
+
+
+def test_shared_cache_clear(shared):
+    Zint("clear", BARCODE_QRCODE).render_bmp()
+    shared.clear()
+
+    assert shared.stats()["entries"] == 0
+    Zint("clear", BARCODE_QRCODE).render_bmp()
+    assert shared.stats()["hits"] == 0
+    assert shared.stats()["entries"] == 1
+
+
+def test_shared_cache_render_many(shared):
+    first = render_many(BARCODE_QRCODE, ["a", "b", "x" * 8000], threads=2)
+    stats = shared.stats()
+
+    assert stats["insertions"] == 2
+    assert isinstance(first[2], RuntimeError)
+
+    second = render_many(BARCODE_QRCODE, ["b", "a"])
+
+    assert second == [first[1], first[0]]
+    assert shared.stats()["hits"] == 2
+    assert Zint("a", BARCODE_QRCODE).render_bmp() == first[0]
+
+
+def test_shared_cache_behind_render_cache(shared):
+    set_render_cache_limit(1 << 20)
+    try:
+        first = Zint("layers", BARCODE_QRCODE).render_bmp()
+        second = Zint("layers", BARCODE_QRCODE).render_bmp()
+    finally:
+        set_render_cache_limit(0)
+
+    assert second is first
+    assert shared.stats()["hits"] == 0
+    assert shared.stats()["insertions"] == 1
+
+
+def test_shared_cache_errors(tmp_path):
+    with pytest.raises(ValueError):
+        SharedCache(size=1024)
+
+    garbage = tmp_path / "garbage"
+    garbage.write_bytes(b"\xff" * (64 * 1024))
+    with pytest.raises(ValueError):
+        SharedCache(str(garbage))
+
+    with pytest.raises(OSError):
+        SharedCache(str(tmp_path / "missing" / "renders"))
+
+    with pytest.raises(TypeError):
+        set_shared_render_cache("renders")
+
+
+def test_shared_cache_concurrent_processes(tmp_path):
+    path = str(tmp_path / "renders")
+    payloads = ["race %d" % (i % 40) for i in range(400)]
+    expected = {p: Zint(p, BARCODE_QRCODE).render_bmp() for p in payloads}
+    SharedCache(path, size=64 * 1024)
+
+    def child():
+        set_shared_render_cache(SharedCache(path))
+        for payload in payloads:
+            assert Zint(payload, BARCODE_QRCODE).render_bmp() == expected[payload]
+
+    for pid in [fork(child) for _ in range(4)]:
+        join(pid)
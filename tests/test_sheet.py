@@ -0,0 +1,176 @@
+import struct
+import zlib
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, Zint, render_many, render_sheet,
+)
+
+
+def bmp_pixels(data):
+    """Set of dark (x, y) pixels of a 1bit bmp, top row first"""
+    offset, = struct.unpack_from("<I", data, 10)
+    width, height = struct.unpack_from("<ii", data, 18)
+    stride = (width + 31) // 32 * 4
+
+    pixels = set()
+    for y in range(height):
+        row = offset + (height - 1 - y) * stride
+        for x in range(width):
+            if not data[row + x // 8] & (0x80 >> (x % 8)):
+                pixels.add((x, y))
+    return width, height, pixels
+
+
+def tile_pixels(z, x0, y0, width, height):
+    raster = bmp_pixels(bytes(z.render_bmp_buffer()))[2]
+    return {
+        (x0 + x, y0 + y) for x, y in raster if x < width and y < height
+    }
+
+
+PAYLOADS = ["sheet-%d" % i for i in range(7)]
+
+
+def test_render_sheet_grid():
+    page = render_sheet(
+        PAYLOADS, 400, columns=3, cell_width=120, cell_height=110,
+        margin=10, gap=5, kind=BARCODE_QRCODE, threads=3,
+    )
+    width, height, pixels = bmp_pixels(page)
+
+    assert width == 400
+    assert height == 10 * 2 + 3 * 110 + 2 * 5
+
+    expected = set()
+    for i, payload in enumerate(PAYLOADS):
+        x, y = 10 + (i % 3) * 125, 10 + (i // 3) * 115
+        expected |= tile_pixels(Zint(payload, BARCODE_QRCODE), x, y, 120, 110)
+
+    assert pixels == expected
+
+
+def test_render_sheet_matches_render_many():
+    tiles = render_many(BARCODE_CODE128, PAYLOADS[:2])
+    page = render_sheet(
+        PAYLOADS[:2], 1000, cell_width=500, cell_height=200,
+        kind=BARCODE_CODE128,
+    )
+    pixels = bmp_pixels(page)[2]
+
+    for i, tile in enumerate(tiles):
+        expected = {(x + i * 500, y) for x, y in bmp_pixels(tile)[2]}
+        assert expected <= pixels
+
+
+def test_render_sheet_clips_tiles():
+    z = Zint("clipped", BARCODE_QRCODE, scale=4)
+    page = render_sheet([z, z], 150, cell_width=60, cell_height=40, gap=3)
+    width, height, pixels = bmp_pixels(page)
+
+    assert (width, height) == (150, 40)
+    assert pixels == (
+        tile_pixels(z, 0, 0, 60, 40) | tile_pixels(z, 63, 0, 60, 40)
+    )
+
+
+def test_render_sheet_positions():
+    a = Zint("first", BARCODE_QRCODE)
+    b = Zint("second", BARCODE_CODE128)
+    page = render_sheet(
+        [a, b, "third"], 300, 300,
+        positions=[(5, 7), (100, 250), (200, 0)], kind=BARCODE_QRCODE,
+    )
+    pixels = bmp_pixels(page)[2]
+
+    assert pixels == (
+        tile_pixels(a, 5, 7, 295, 293) |
+        tile_pixels(b, 100, 250, 200, 50) |
+        tile_pixels(Zint("third", BARCODE_QRCODE), 200, 0, 100, 300)
+    )
+
+
+def test_render_sheet_threads_independent():
+    pages = {
+        render_sheet(
+            PAYLOADS * 5, 500, cell_width=90, cell_height=90,
+            kind=BARCODE_QRCODE, threads=threads,
+        )
+        for threads in (1, 2, 8)
+    }
+    assert len(pages) == 1
+
+
+def test_render_sheet_formats():
+    options = dict(cell_width=100, cell_height=100, kind=BARCODE_QRCODE)
+
+    png = render_sheet(PAYLOADS[:3], 320, format="png", **options)
+    assert png.startswith(b"\x89PNG\r\n\x1a\n")
+    assert struct.unpack(">II", png[16:24]) == (320, 100)
+    assert zlib.crc32(png[12:29]) == struct.unpack(">I", png[29:33])[0]
+
+    zpl = render_sheet(PAYLOADS[:3], 320, format="zpl", **options)
+    assert zpl.startswith(b"^GFA,4000,4000,40,:Z64:")
+
+    escpos = render_sheet(PAYLOADS[:3], 320, format="escpos", **options)
+    assert escpos.startswith(b"\x1dv0\x00" + struct.pack("<HH", 40, 100))
+
+
+def test_render_sheet_colors():
+    colors = dict(fgcolor="#ff0000", bgcolor="#00ff00")
+    page = render_sheet(
+        ["colors"], 100, cell_width=100, cell_height=100,
+        kind=BARCODE_QRCODE, **colors
+    )
+    tile = Zint("colors", BARCODE_QRCODE).render_bmp(**colors)
+    assert page[54:62] == tile[54:62]
+
+
+def test_render_sheet_empty():
+    width, height, pixels = bmp_pixels(
+        render_sheet([], 64, cell_width=10, cell_height=10, margin=2)
+    )
+    assert (width, height, pixels) == (64, 14, set())
+
+
+def test_render_sheet_errors():
+    with pytest.raises(ValueError):
+        render_sheet(
+            ["x"], 100, cell_width=10, cell_height=10, kind=BARCODE_QRCODE,
+            format="svg",
+        )
+
+    with pytest.raises(ValueError):
+        render_sheet(["x"], 0, cell_width=10, cell_height=10, kind=BARCODE_QRCODE)
+
+    with pytest.raises(ValueError):
+        render_sheet(["x"], 100, kind=BARCODE_QRCODE)
+
+    with pytest.raises(TypeError):
+        render_sheet(["x"], 100, cell_width=10, cell_height=10)
+
+    with pytest.raises(ValueError):
+        render_sheet([1], 100, cell_width=10, cell_height=10, kind=BARCODE_QRCODE)
+
+    with pytest.raises(ValueError):
+        render_sheet(
+            ["x", "y"], 100, 100, positions=[(0, 0)], kind=BARCODE_QRCODE,
+        )
+
+    with pytest.raises(ValueError):
+        render_sheet(
+            ["x"], 100, 100, positions=[(100, 0)], kind=BARCODE_QRCODE,
+        )
+
+    with pytest.raises(ValueError):
+        render_sheet(
+            ["x", "y"], 100, 10, cell_width=100, cell_height=10,
+            kind=BARCODE_QRCODE,
+        )
+
+    with pytest.raises(RuntimeError, match="item 1"):
+        render_sheet(
+            [Zint("1", BARCODE_CODE128), Zint("x" * 1001, BARCODE_CODE128)],
+            200, cell_width=100, cell_height=100,
+        )
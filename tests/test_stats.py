@@ -0,0 +1,107 @@
+import os
+import subprocess
+import sys
+import threading
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, Zint, render_many, reset_stats,
+    set_stats_enabled, stats,
+)
+
+
+@pytest.fixture
+def enabled():
+    was = stats()["enabled"]
+    set_stats_enabled(True)
+    reset_stats()
+    yield
+    set_stats_enabled(was)
+    reset_stats()
+
+
+def test_stats_disabled():
+    set_stats_enabled(False)
+    reset_stats()
+
+    Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+
+    result = stats()
+    assert result["enabled"] is False
+    assert result["phases"] == {}
+    assert result["symbologies"] == {}
+
+
+def test_stats_phases(enabled):
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    bmp = z.render_bmp()
+    svg = z.render_svg()
+    png = z.render_png()
+
+    result = stats()
+    assert result["enabled"] is True
+
+    phases = result["symbologies"][BARCODE_QRCODE]
+    assert set(phases) == {
+        "encode", "raster", "vector", "bmp", "svg", "png", "copy",
+    }
+
+    # encoded symbol is kept on the object
+    assert phases["encode"]["count"] == 1
+    assert phases["encode"]["bytes"] == len("Barcode QRCode")
+    assert phases["raster"]["count"] == 2
+    assert phases["bmp"]["count"] == 2
+    assert phases["svg"]["bytes"] == len(svg)
+    assert phases["png"]["bytes"] == len(png)
+    assert phases["copy"]["count"] == 3
+    assert phases["copy"]["bytes"] == len(bmp) + len(svg) + len(png)
+
+    for counter in phases.values():
+        assert len(counter["histogram"]) == 32
+        assert sum(counter["histogram"]) == counter["count"]
+
+    assert result["phases"] == phases
+
+
+def test_stats_reset(enabled):
+    Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    assert stats()["phases"]["encode"]["count"] == 1
+
+    reset_stats()
+    assert stats()["phases"] == {}
+
+    Zint("Barcode QRCode", BARCODE_QRCODE).render_bmp()
+    assert stats()["phases"]["encode"]["count"] == 1
+
+
+def test_stats_threads(enabled):
+    def render():
+        for _ in range(10):
+            Zint("1234567", BARCODE_CODE128).render_svg()
+
+    threads = [threading.Thread(target=render) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    render_many(BARCODE_QRCODE, ["a", "b", "c"], threads=2)
+
+    result = stats()["symbologies"]
+    assert result[BARCODE_CODE128]["encode"]["count"] == 40
+    assert result[BARCODE_CODE128]["svg"]["count"] == 40
+    assert result[BARCODE_QRCODE]["encode"]["count"] == 3
+    assert result[BARCODE_QRCODE]["copy"]["count"] == 3
+
+
+def test_stats_environment():
+    code = "import pyzint.zint as z; print(z.stats()['enabled'])"
+    env = dict(os.environ, PYZINT_STATS="1")
+
+    output = subprocess.check_output([sys.executable, "-c", code], env=env)
+    assert output.strip() == b"True"
+
+    env["PYZINT_STATS"] = "0"
+    output = subprocess.check_output([sys.executable, "-c", code], env=env)
+    assert output.strip() == b"False"
@@ -0,0 +1,139 @@
+import io
+import os
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_PDF417, BARCODE_QRCODE, Zint,
+)
+
+
+CHUNK = 65536
+
+
+class Recorder:
+    def __init__(self, limit=None):
+        self.chunks = []
+        self.limit = limit
+
+    def write(self, data):
+        assert isinstance(data, bytes)
+        data = data[:self.limit] if self.limit else data
+        self.chunks.append(data)
+        return len(data)
+
+    def getvalue(self):
+        return b"".join(self.chunks)
+
+
+@pytest.mark.parametrize("options", [
+    {}, {"angle": 90}, {"direct": True},
+    {"fgcolor": "#102030", "bgcolor": "#F0E0D0", "direct": True},
+])
+@pytest.mark.parametrize("kind", [BARCODE_QRCODE, BARCODE_CODE128])
+def test_render_bmp_to(kind, options):
+    z = Zint("streamed", kind)
+    fp = io.BytesIO()
+
+    assert z.render_bmp_to(fp, **options) == len(fp.getvalue())
+    assert fp.getvalue() == z.render_bmp(**options)
+
+
+@pytest.mark.parametrize("options", [{}, {"compact": True}, {"angle": 180}])
+def test_render_svg_to(options):
+    z = Zint("streamed", BARCODE_QRCODE)
+    fp = io.BytesIO()
+
+    assert z.render_svg_to(fp, **options) == len(fp.getvalue())
+    assert fp.getvalue() == z.render_svg(**options)
+
+
+@pytest.mark.parametrize("direct", [False, True])
+def test_render_bmp_to_chunks(direct):
+    z = Zint("x" * 900, BARCODE_PDF417, scale=10)
+    fp = Recorder()
+
+    z.render_bmp_to(fp, direct=direct)
+
+    assert fp.getvalue() == z.render_bmp(direct=direct)
+    assert len(fp.chunks) > 1
+    assert max(len(x) for x in fp.chunks) < 2 * CHUNK
+
+
+def test_render_svg_to_chunks():
+    z = Zint("x" * 900, BARCODE_PDF417)
+    fp = Recorder()
+
+    z.render_svg_to(fp)
+
+    assert fp.getvalue() == z.render_svg()
+    assert len(fp.chunks) > 1
+    assert max(len(x) for x in fp.chunks) < 2 * CHUNK
+
+
+def test_render_to_short_writes():
+    z = Zint("short", BARCODE_QRCODE, scale=4)
+    fp = Recorder(limit=1000)
+
+    assert z.render_bmp_to(fp) == len(z.render_bmp())
+    assert fp.getvalue() == z.render_bmp()
+
+
+@pytest.mark.parametrize("method", ["render_bmp_to", "render_svg_to"])
+def test_render_to_fd(tmp_path, method):
+    z = Zint("x" * 500, BARCODE_PDF417, scale=4)
+    path = tmp_path / "out"
+
+    fd = os.open(str(path), os.O_WRONLY | os.O_CREAT)
+    try:
+        os.write(fd, b"head")
+        size = getattr(z, method)(fd)
+    finally:
+        os.close(fd)
+
+    expected = getattr(z, method.replace("_to", ""))()
+    assert size == len(expected)
+    assert path.read_bytes() == b"head" + expected
+
+
+def test_render_to_pipe():
+    z = Zint("piped", BARCODE_QRCODE)
+    read, write = os.pipe()
+    try:
+        size = z.render_bmp_to(write, direct=True)
+        assert os.read(read, size + 1) == z.render_bmp(direct=True)
+    finally:
+        os.close(read)
+        os.close(write)
+
+
+def test_render_to_errors(tmp_path):
+    z = Zint("errors", BARCODE_QRCODE)
+
+    class Failing:
+        def write(self, data):
+            raise ValueError("full")
+
+    with pytest.raises(ValueError, match="full"):
+        z.render_bmp_to(Failing())
+
+    with pytest.raises(TypeError):
+        z.render_svg_to(object())
+
+    with pytest.raises(ValueError):
+        z.render_bmp_to(-1)
+
+    fd = os.open(str(tmp_path / "closed"), os.O_WRONLY | os.O_CREAT)
+    os.close(fd)
+    with pytest.raises(OSError):
+        z.render_bmp_to(fd)
+
+    fd = os.open(str(tmp_path / "readonly"), os.O_RDONLY | os.O_CREAT)
+    try:
+        with pytest.raises(OSError):
+            z.render_svg_to(fd)
+    finally:
+        os.close(fd)
+
+    with pytest.raises(RuntimeError):
+        Zint("x" * 1001, BARCODE_CODE128).render_bmp_to(io.BytesIO())
@@ -0,0 +1,67 @@
+import threading
+
+import pytest
+
+from pyzint.zint import (
+    BARCODE_QRCODE, Zint, render_many, set_symbol_pool_limit,
+    symbol_pool_stats,
+)
+
+
+@pytest.fixture
+def pool_limit():
+    limit = symbol_pool_stats()["limit"]
+    yield set_symbol_pool_limit
+    set_symbol_pool_limit(limit)
+
+
+def test_symbol_pool_reuse(pool_limit):
+    pool_limit(4)
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    z.render_bmp()
+
+    before = symbol_pool_stats()
+    for _ in range(10):
+        z.render_bmp()
+        z.render_svg()
+    after = symbol_pool_stats()
+
+    assert after["reused"] - before["reused"] >= 20
+    assert after["created"] == before["created"]
+    assert after["limit"] == 4
+
+
+def test_symbol_pool_disabled(pool_limit):
+    pool_limit(0)
+    z = Zint("Barcode QRCode", BARCODE_QRCODE)
+    expected = z.render_bmp()
+
+    before = symbol_pool_stats()
+    assert z.render_bmp() == expected
+    after = symbol_pool_stats()
+
+    assert after["discarded"] - before["discarded"] == 1
+    assert after["pooled"] == before["pooled"]
+
+
+def test_symbol_pool_limit_clamped(pool_limit):
+    pool_limit(-1)
+    assert symbol_pool_stats()["limit"] == 0
+
+    pool_limit(10 ** 6)
+    assert symbol_pool_stats()["limit"] == 64
+
+
+def test_symbol_pool_threads(pool_limit):
+    pool_limit(4)
+    payloads = ["payload %d" % i for i in range(64)]
+    expected = [Zint(p, BARCODE_QRCODE).render_bmp() for p in payloads]
+
+    def worker():
+        assert render_many(BARCODE_QRCODE, payloads, threads=4) == expected
+
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
@@ -1,10 +1,13 @@
+import re
 import xml.etree.ElementTree as ET
 from io import BytesIO
 
 import pytest
 from PIL import Image
 
-from pyzint.zint import BARCODE_RSS_EXP, Zint, SCALE_MAX
+from pyzint.zint import (
+    BARCODE_CODE128, BARCODE_QRCODE, BARCODE_RSS_EXP, Zint, SCALE_MAX,
+)
 
 
 def test_params_bytes():
@@ -82,3 +85,100 @@ def test_scale():
 
     with pytest.raises(ValueError):
         Zint("[255]11111111111222", BARCODE_RSS_EXP, scale=-1)
+
+
+def test_render_formats():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+    bmp, svg = z.render(["bmp", "svg"])
+
+    assert svg == z.render_svg()
+    assert svg == Zint("[255]11111111111222", BARCODE_RSS_EXP).render_svg()
+
+    with BytesIO(bmp) as fp:
+        img = Image.open(fp)
+
+        assert img.verify() is None
+        assert img.height == 84
+        assert img.width == 366
+
+    assert z.render([]) == ()
+
+    with pytest.raises(ValueError):
+        z.render(["gif"])
+
+
+def test_render_many_times():
+    z = Zint("[255]11111111111222", BARCODE_RSS_EXP)
+
+    for angle in (0, 90, 180, 270):
+        with BytesIO(z.render_bmp(angle=angle)) as fp:
+            img = Image.open(fp)
+            assert sorted(img.size) == [84, 366]
+
+
+def test_render_svg_large():
+    small = Zint("1", BARCODE_QRCODE).render_svg()
+    large = Zint("1" * 7000, BARCODE_QRCODE, scale=SCALE_MAX).render_svg()
+
+    assert len(large) > len(small)
+    assert large.endswith(b"</svg>")
+
+    root = ET.fromstring(large)
+    assert root.tag.endswith("svg")
+
+
+def svg_runs(svg):
+    """ Bars of plain svg as merged horizontal runs in hundredths """
+    root = ET.fromstring(svg)
+    runs = []
+    for rect in root.iter("{http://www.w3.org/2000/svg}rect"):
+        if rect.get("fill"):
+            continue
+        x, y, w, h = (
+            round(float(rect.get(name)) * 100)
+            for name in ("x", "y", "width", "height")
+        )
+        if runs:
+            px, py, pw, ph = runs[-1]
+            if (py, ph) == (y, h) and px + pw == x:
+                x, w = px, runs.pop()[2] + w
+        runs.append((x, y, w, h))
+    return sorted(runs)
+
+
+def path_runs(svg):
+    root = ET.fromstring(svg)
+    paths = list(root.iter("{http://www.w3.org/2000/svg}path"))
+    assert len(paths) == 1
+
+    runs = []
+    x = y = 0
+    for cmd, args in re.findall(r"([mMhvz])([^mMhvz]*)", paths[0].get("d")):
+        nums = [round(float(n) * 100) for n in re.findall(r"-?[\d.]+", args)]
+        if cmd == "M":
+            x, y = nums
+            runs.append([x, y])
+        elif cmd == "m":
+            x, y = x + nums[0], y + nums[1]
+            runs.append([x, y])
+        elif cmd == "h" and len(runs[-1]) == 2:
+            runs[-1].append(nums[0])
+        elif cmd == "v":
+            runs[-1].append(nums[0])
+    return sorted(tuple(run) for run in runs)
+
+
+@pytest.mark.parametrize("kind,data", [
+    (BARCODE_QRCODE, "Compact QRCode " * 10),
+    (BARCODE_CODE128, "Compact Code128"),
+    (BARCODE_RSS_EXP, "[255]11111111111222"),
+])
+@pytest.mark.parametrize("scale", [1, 1.5, 3.3])
+def test_render_svg_compact(kind, data, scale):
+    z = Zint(data, kind, scale=scale)
+    plain = z.render_svg()
+    compact = z.render_svg(compact=True)
+
+    assert len(compact) < len(plain)
+    assert compact.count(b"<rect") == 1
+    assert path_runs(compact) == svg_runs(plain)